@@ -62,6 +62,21 @@ LOCAL_SRC_FILES := $(SRC_DIR)/src/lua/H264TextureBinding.cpp \
     $(SRC_DIR)/src/managers/H264Movie.cpp \
     $(SRC_DIR)/src/utils/ErrorHandler.cpp \
     $(SRC_DIR)/src/utils/MiniMP4Implementation.cpp \
+    $(SRC_DIR)/src/utils/ColorConverter.cpp \
+    $(SRC_DIR)/src/utils/WorkerPool.cpp \
+    $(SRC_DIR)/src/managers/FrameQueue.cpp \
+    $(SRC_DIR)/src/utils/PCMRingBuffer.cpp \
+    $(SRC_DIR)/src/managers/AudioStreamer.cpp \
+    $(SRC_DIR)/src/utils/ByteSource.cpp \
+    $(SRC_DIR)/src/utils/NALConverter.cpp \
+    $(SRC_DIR)/src/managers/MediaClock.cpp \
+    $(SRC_DIR)/src/decoders/Demuxer.cpp \
+    $(SRC_DIR)/src/utils/SPSParser.cpp \
+    $(SRC_DIR)/src/decoders/AnnexBDemuxer.cpp \
+    $(SRC_DIR)/src/decoders/DemuxerFactory.cpp \
+    $(SRC_DIR)/src/utils/PCMBuffer.cpp \
+    $(SRC_DIR)/src/utils/FrameBuffer.cpp \
+    $(SRC_DIR)/src/utils/PerfStats.cpp \
     $(SRC_DIR)/generated/plugin_h264.c
 
 
@@ -3,6 +3,7 @@
 
 #include "../utils/Common.h"
 #include "../utils/ErrorHandler.h"
+#include "../utils/PCMBuffer.h"
 #include "aacdecoder_lib.h"  // FDK-AAC头文件
 #include <vector>
 
@@ -23,7 +24,10 @@ public:
     // 配置解码器（使用AudioSpecificConfig数据）
     bool configureWithASC(const uint8_t* asc_data, size_t asc_size);
 
-    // 解码AAC数据到PCM
+    // 单帧最多输出的样本数（2048采样帧，立体声）
+    static const size_t kMaxOutputSamples = 2048 * 2;
+
+    // 解码AAC数据到PCM，frame.samples 来自解码器的缓冲区池
     bool decode(const uint8_t* aac_data, size_t aac_size, AudioFrame& frame);
 
     // 获取解码器信息
@@ -38,7 +42,7 @@ public:
     // 获取库信息
     std::vector<LIB_INFO> getLibraryInfo() const;
 
-    // 获取内存使用量（估计值）
+    // 获取输出缓冲区和PCM缓冲池的内存使用量
     size_t getMemoryUsage() const;
 
 private:
@@ -48,7 +52,8 @@ private:
     int channels_;
     int bits_per_sample_;
 
-    // 输出缓冲区
+    // 解码输出的PCM缓冲区池；INT_PCM不是16位时先解码到output_buffer_再转换
+    PCMBufferPool pcm_pool_;
     std::vector<INT_PCM> output_buffer_;
 
     // 内部辅助方法
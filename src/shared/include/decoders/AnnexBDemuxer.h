@@ -0,0 +1,95 @@
+#ifndef PLUGIN_H264_ANNEXB_DEMUXER_H
+#define PLUGIN_H264_ANNEXB_DEMUXER_H
+
+#include "Demuxer.h"
+#include "../utils/ByteSource.h"
+#include "../utils/SPSParser.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 裸H.264码流（.h264，Annex-B起始码格式）：只有一个视频轨道（track_id为0）
+// open时扫描整个码流，按访问单元建立样本索引；IDR访问单元为同步样本
+// 码流中没有时间戳，按帧率以解码顺序合成，含B帧的码流显示时间会偏差
+class AnnexBDemuxer : public Demuxer {
+public:
+    // 合成时间戳的时间刻度
+    static const uint32_t kTimescale = 90000;
+    // 没有指定帧率且SPS中没有timing_info时使用
+    static constexpr double kDefaultFrameRate = 25.0;
+
+    AnnexBDemuxer();
+    ~AnnexBDemuxer() override;
+
+    // 禁用拷贝构造和赋值
+    AnnexBDemuxer(const AnnexBDemuxer&) = delete;
+    AnnexBDemuxer& operator=(const AnnexBDemuxer&) = delete;
+
+    // 帧率（在open之前设置），0表示使用SPS VUI中的timing_info
+    void setFrameRate(double fps) { configured_frame_rate_ = fps > 0.0 ? fps : 0.0; }
+    // 实际用于合成时间戳的帧率
+    double getFrameRate() const { return frame_rate_; }
+
+    // 打开文件（优先mmap，失败时回退到ifstream）
+    bool open(const std::string& file_path);
+    bool open(std::unique_ptr<ByteSource> source);
+
+    void close() override;
+
+    std::vector<TrackInfo> getTrackInfo() const override;
+
+    // 码流中第一个SPS/PPS；样本即Annex-B访问单元，nal_length_size为0
+    bool getCodecConfig(int track_id, CodecConfig& config) const override;
+
+    bool readNextSample(int track_id, MP4SampleView& view) override;
+    bool readNextSampleInto(int track_id, std::vector<uint8_t>& buffer, MP4SampleView& view) override;
+
+    const SampleIndex* getSampleIndex(int track_id) const override;
+    size_t getNextSampleNumber(int track_id) const override;
+    bool seekToSample(int track_id, size_t sample) override;
+
+    double getDuration() const override { return duration_; }
+
+private:
+    // 扫描中的访问单元
+    struct AccessUnitBuilder {
+        int64_t start;       // 第一个NAL的起始码位置，-1表示还没有NAL
+        bool has_slice;
+        bool is_idr;
+
+        AccessUnitBuilder() : start(-1), has_slice(false), is_idr(false) {}
+    };
+
+    bool buildIndex();
+    void handleNAL(int64_t start, int64_t payload, uint8_t header, int next_byte, AccessUnitBuilder& unit);
+    void finishAccessUnit(int64_t end, AccessUnitBuilder& unit);
+    void captureParameterSet(int64_t payload, int64_t end);
+    void assignTimestamps();
+    bool isValidTrack(int track_id) const;
+    bool nextSample(int track_id, size_t& sample);
+
+    std::unique_ptr<ByteSource> source_;
+    bool is_open_;
+    double configured_frame_rate_;
+    double frame_rate_;
+    double duration_;
+
+    SampleIndex index_;
+    size_t next_sample_;
+    std::vector<uint8_t> buffer_;
+
+    // 上一个NAL（扫描到下一个起始码时才知道它的结尾）
+    int64_t pending_payload_;
+    int pending_type_;
+
+    std::vector<uint8_t> sps_;
+    std::vector<uint8_t> pps_;
+    SPSInfo sps_info_;
+    bool has_sps_info_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_ANNEXB_DEMUXER_H
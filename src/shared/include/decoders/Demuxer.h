@@ -0,0 +1,138 @@
+#ifndef PLUGIN_H264_DEMUXER_H
+#define PLUGIN_H264_DEMUXER_H
+
+#include "../utils/Common.h"
+#include "../utils/ErrorHandler.h"
+#include "../utils/MemoryTracker.h"
+#include <string>
+#include <vector>
+
+namespace plugin_h264 {
+
+struct MP4Sample {
+    std::vector<uint8_t> data;
+    uint64_t timestamp;
+    uint32_t duration;
+    bool is_keyframe;
+
+    MP4Sample() : timestamp(0), duration(0), is_keyframe(false) {}
+};
+
+// 样本的只读视图（零拷贝）：指向映射文件或该轨道的内部缓冲区，
+// 在同一轨道的下一次读取、seek或关闭之前有效
+struct MP4SampleView {
+    const uint8_t* data;
+    size_t size;
+    uint64_t timestamp;
+    uint32_t duration;
+    bool is_keyframe;
+
+    MP4SampleView() : data(nullptr), size(0), timestamp(0), duration(0), is_keyframe(false) {}
+};
+
+// 轨道样本索引（结构数组布局），open时一次建好，读样本和seek不再解析容器
+// 时间戳为解码时间戳（轨道timescale）；分配的内存记到counter上（为空时不计数）
+struct SampleIndex {
+    TrackedVector<uint64_t> offsets;
+    TrackedVector<uint32_t> sizes;
+    TrackedVector<uint64_t> timestamps;   // 单调不减，可二分查找；分片的tfdt可能超过32位
+    TrackedVector<uint32_t> durations;
+    TrackedVector<uint32_t> sync_samples; // 同步样本序号（从0开始，升序），为空表示全部是同步样本
+
+    explicit SampleIndex(MemoryCounter* counter = nullptr);
+
+    size_t count() const { return timestamps.size(); }
+
+    // 第一个时间戳不早于timestamp的样本，全部更早时返回count()
+    size_t findSample(uint64_t timestamp) const;
+
+    bool isSyncSample(size_t sample) const;
+    // 不晚于sample的最近同步样本
+    size_t findSyncSample(size_t sample) const;
+
+    // 清空并释放内存
+    void clear();
+    size_t getMemoryUsage() const;
+};
+
+// 轨道的解码器配置
+struct CodecConfig {
+    CodecType codec;
+    std::vector<uint8_t> dsi;                          // 容器中的原始配置：avcC 或 AAC AudioSpecificConfig，裸码流为空
+    std::vector<std::vector<uint8_t>> parameter_sets;  // H.264 SPS/PPS（不含起始码），按送入解码器的顺序
+    int nal_length_size;                               // H.264样本中NAL长度前缀字节数（1/2/4），0表示样本已是Annex-B
+
+    CodecConfig() : codec(CodecType::UNKNOWN), nal_length_size(4) {}
+};
+
+// 加载时解析一次的活动轨道，逐帧路径只读取它，不再复制和遍历轨道列表
+struct TrackDescriptor {
+    TrackInfo info;
+    CodecConfig config;
+    double timescale;      // 时间戳换算为秒的刻度，容器中没有时为默认值
+
+    TrackDescriptor() : timescale(0.0) {}
+
+    bool isValid() const { return info.track_id >= 0; }
+    double toSeconds(uint64_t timestamp) const { return static_cast<double>(timestamp) / timescale; }
+};
+
+// 解复用器接口：播放逻辑只通过它枚举轨道、读取样本和定位，track_id 为轨道下标
+// 具体实现由 DemuxerFactory 按文件内容选择
+class Demuxer : public ErrorHandler {
+public:
+    Demuxer() : current_time_(0.0) {}
+    virtual ~Demuxer() {}
+
+    virtual void close() = 0;
+
+    // 获取轨道信息
+    virtual std::vector<TrackInfo> getTrackInfo() const = 0;
+
+    // 轨道的解码器配置，track_id无效时返回false
+    virtual bool getCodecConfig(int track_id, CodecConfig& config) const = 0;
+
+    // 第一个类型和编码都匹配的轨道，连同解码器配置一起返回，没有时返回false
+    bool findTrack(MP4TrackType type, CodecType codec, TrackDescriptor& track) const;
+
+    // 读取下一个样本的视图，字节源支持时不复制数据
+    virtual bool readNextSample(int track_id, MP4SampleView& view) = 0;
+
+    // 读取下一个样本到调用方的可写缓冲区（只增不减），view指向buffer，可原地修改
+    virtual bool readNextSampleInto(int track_id, std::vector<uint8_t>& buffer, MP4SampleView& view) = 0;
+
+    // 轨道样本索引，track_id无效时返回nullptr
+    virtual const SampleIndex* getSampleIndex(int track_id) const = 0;
+
+    // 轨道下一个要读取的样本序号（样本索引下标），track_id无效时返回0
+    virtual size_t getNextSampleNumber(int track_id) const = 0;
+
+    // 按样本序号定位轨道，sample等于样本数时定位到轨道末尾
+    virtual bool seekToSample(int track_id, size_t sample) = 0;
+
+    // 跳转到指定时间：每个轨道定位到不晚于目标时间的最近同步样本，
+    // 调用方需要从该样本解码并丢弃目标时间之前的帧
+    bool seekToTime(double timestamp);
+
+    // 增长中的字节源：解析新到达的数据，有新样本时返回true
+    virtual bool refresh() { return false; }
+
+    // 字节源尚未完整：此时读取失败表示数据还没有到达，而不是轨道结束
+    virtual bool isWaitingForData() const { return false; }
+
+    virtual double getDuration() const = 0;
+
+    // 最近读取的样本（或seek目标）的时间
+    double getCurrentTime() const { return current_time_; }
+
+    // 样本索引实际分配的内存，可以在任意线程读取
+    size_t getIndexMemoryUsage() const { return index_memory_.getBytes(); }
+
+protected:
+    double current_time_;
+    MemoryCounter index_memory_;   // 子类的SampleIndex记账到这里
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_DEMUXER_H
@@ -0,0 +1,45 @@
+#ifndef PLUGIN_H264_DEMUXER_FACTORY_H
+#define PLUGIN_H264_DEMUXER_FACTORY_H
+
+#include "Demuxer.h"
+#include "../utils/ByteSource.h"
+#include <memory>
+#include <string>
+
+namespace plugin_h264 {
+
+enum class ContainerFormat {
+    UNKNOWN,
+    MP4,        // ISO BMFF（.mp4/.m4v/.mov，包括分片MP4）
+    ANNEXB      // 裸H.264码流
+};
+
+// 创建解复用器时的选项
+struct DemuxerOptions {
+    bool allow_mmap;        // 打开文件时优先mmap
+    double frame_rate;      // 裸码流合成时间戳的帧率，0表示使用SPS中的timing_info
+
+    DemuxerOptions() : allow_mmap(true), frame_rate(0.0) {}
+};
+
+// 按文件头内容（而不是扩展名）选择解复用器实现
+class DemuxerFactory {
+public:
+    // 识别格式需要的文件头字节数
+    static const size_t kSniffSize = 16;
+
+    static ContainerFormat sniff(const uint8_t* data, size_t size);
+    static ContainerFormat sniff(ByteSource& source);
+
+    static const char* getFormatName(ContainerFormat format);
+
+    // 打开失败时返回nullptr，原因写入error
+    static std::unique_ptr<Demuxer> open(const std::string& file_path, const DemuxerOptions& options,
+                                         std::string& error);
+    static std::unique_ptr<Demuxer> open(std::unique_ptr<ByteSource> source, const DemuxerOptions& options,
+                                         std::string& error);
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_DEMUXER_FACTORY_H
@@ -6,46 +6,39 @@
 #include "codec_def.h"  // OpenH264头文件
 #include "codec_api.h"
 #include "codec_app_def.h"  // For DECODER_OPTION_NUM_OF_THREADS
+#include <atomic>
 #include <vector>
-#include <queue>
-#include <mutex>
 
 namespace plugin_h264 {
 
-// 帧缓冲池，用于重用内存
-class FrameBufferPool {
-public:
-    FrameBufferPool(size_t pool_size = 3) : pool_size_(pool_size) {}
-    
-    std::unique_ptr<uint8_t[]> acquire(size_t size) {
-        std::lock_guard<std::mutex> lock(pool_mutex_);
-        if (!pool_.empty() && pool_.front().second >= size) {
-            auto buffer = std::move(pool_.front().first);
-            pool_.pop();
-            return buffer;
-        }
-        return std::make_unique<uint8_t[]>(size);
-    }
-    
-    void release(std::unique_ptr<uint8_t[]> buffer, size_t size) {
-        if (!buffer) return;
-        std::lock_guard<std::mutex> lock(pool_mutex_);
-        if (pool_.size() < pool_size_) {
-            pool_.push({std::move(buffer), size});
-        }
-    }
-    
-    void clear() {
-        std::lock_guard<std::mutex> lock(pool_mutex_);
-        while (!pool_.empty()) {
-            pool_.pop();
-        }
-    }
-    
-private:
-    size_t pool_size_;
-    std::queue<std::pair<std::unique_ptr<uint8_t[]>, size_t>> pool_;
-    mutable std::mutex pool_mutex_;
+// 解码落后时的跳帧策略
+enum class DecodeSkipPolicy {
+    NONE,           // 从不跳过
+    NON_REFERENCE,  // 跳过非参考片（nal_ref_idc == 0），不影响后续帧
+    UNTIL_IDR       // 跳过所有片直到下一个IDR，画面冻结但追赶最快
+};
+
+// 跳过的帧数
+struct DecodeSkipStats {
+    uint64_t non_reference;   // 落后时跳过的非参考帧
+    uint64_t until_idr;       // 等待IDR期间跳过的帧
+
+    DecodeSkipStats() : non_reference(0), until_idr(0) {}
+    uint64_t total() const { return non_reference + until_idr; }
+};
+
+// 解码器配置
+struct H264DecoderConfig {
+    int thread_count;                       // OpenH264内部解码线程数，0/1为单线程
+    ERROR_CON_IDC error_concealment;        // 错误隐藏模式
+    VIDEO_BITSTREAM_TYPE bitstream_type;    // 码流类型
+    DecodeSkipPolicy skip_policy;           // 落后时的跳帧策略
+
+    H264DecoderConfig()
+        : thread_count(1)
+        , error_concealment(ERROR_CON_SLICE_COPY)
+        , bitstream_type(VIDEO_BITSTREAM_AVC)
+        , skip_policy(DecodeSkipPolicy::NON_REFERENCE) {}
 };
 
 class H264Decoder : public ErrorHandler {
@@ -58,16 +51,40 @@ public:
     H264Decoder& operator=(const H264Decoder&) = delete;
     
     // 初始化解码器
-    bool initialize();
+    bool initialize(const H264DecoderConfig& config = H264DecoderConfig());
+    const H264DecoderConfig& getConfig() const { return config_; }
     
     // 解码H264数据到YUV420 - 支持零拷贝模式
-    bool decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& frame);
+    // 多线程解码或存在B帧时输出会滞后于输入，timestamp（秒）随码流传入，
+    // 输出帧的timestamp是该帧对应输入的时间戳，而不一定是本次输入的
+    bool decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& frame, double timestamp = 0.0);
+    
+    // 码流结束后取出解码器中剩余的帧，没有更多帧时返回false
+    bool flush(VideoFrame& frame);
     
     // 获取解码器信息
     bool getDecoderInfo(int& width, int& height) const;
     
-    // 设置是否需要紧凑格式（控制零拷贝模式）
+    // 设置是否需要紧凑格式（控制零拷贝模式），默认开启
+    // 开启时输出帧复制到池化缓冲区，帧持有缓冲区的引用，下一次解码后仍然有效；
+    // 关闭时输出零拷贝帧，只能在下一次解码之前、在解码线程上使用
     void setCompactFormatRequired(bool required) { require_compact_format_ = required; }
+    bool isCompactFormatRequired() const { return require_compact_format_; }
+
+    // 跳帧策略，可以在播放中切换
+    void setSkipPolicy(DecodeSkipPolicy policy);
+    DecodeSkipPolicy getSkipPolicy() const { return skip_policy_; }
+
+    // 落后信号：置位时 decode 按策略丢弃片，不送入OpenH264，此时返回false且不设置错误
+    // 由调度线程设置，解码线程读取
+    void setLate(bool late) { late_ = late; }
+    bool isLate() const { return late_; }
+
+    DecodeSkipStats getSkipStats() const;
+    void resetSkipStats();
+
+    static bool parseSkipPolicy(const char* name, DecodeSkipPolicy& policy);
+    static const char* getSkipPolicyName(DecodeSkipPolicy policy);
     
     // 重置解码器
     void reset();
@@ -75,17 +92,27 @@ public:
     // 释放资源
     void destroy();
     
-    // 获取内存使用量（估计值）
+    // SPS中的max_num_ref_frames，用于计算DPB占用的内存
+    void setReferenceFrames(int count) { reference_frames_ = count; }
+    int getReferenceFrames() const { return reference_frames_; }
+
+    // OpenH264的解码图像缓冲区（参考帧 + 当前帧 + 输出帧，多线程时每个线程再多一帧）
+    // OpenH264不支持自定义分配器，按实际分辨率和参考帧数计算，每帧含32像素的边缘扩展
+    size_t getDPBMemoryUsage() const;
+
+    // 获取内存使用量（对象本身 + DPB）
     size_t getMemoryUsage() const;
     
 private:
     ISVCDecoder* decoder_;
+    H264DecoderConfig config_;
     bool initialized_;
     int frame_width_;
     int frame_height_;
+    int reference_frames_;
     
     // 零拷贝模式控制
-    bool require_compact_format_;  // 是否需要紧凑格式（禁用零拷贝）
+    bool require_compact_format_;  // 是否需要紧凑格式（默认开启，禁用零拷贝）
     
     // 内部辅助方法
     bool setupDecoderOptions();
@@ -95,15 +122,18 @@ private:
     bool applyAggressiveCompatibilityOptions();
     bool applyStandardCompatibilityOptions();
     bool applyMinimalOptions();
-    bool allocateFrameBuffer(int width, int height);
-    void freeFrameBuffer();
+    bool outputFrame(uint8_t* pData[3], const SBufferInfo& info, VideoFrame& frame);
+    bool shouldSkip(const uint8_t* nal_data, size_t nal_size);
     
-    // 帧缓冲区（重用以减少内存分配）
-    std::unique_ptr<uint8_t[]> frame_buffer_;
-    size_t frame_buffer_size_;
-    
-    // 帧缓冲池
-    FrameBufferPool buffer_pool_;
+    // 紧凑格式输出帧的缓冲池（所有影片共用），帧释放后缓冲区自动回到池中
+    FrameBufferPool& buffer_pool_;
+
+    // 跳帧状态
+    std::atomic<DecodeSkipPolicy> skip_policy_;
+    std::atomic<bool> late_;
+    bool waiting_for_idr_;                 // 已丢弃参考帧，下一个IDR之前的帧都无法正确解码
+    std::atomic<uint64_t> skipped_non_reference_;
+    std::atomic<uint64_t> skipped_until_idr_;
 };
 
 } // namespace plugin_h264
@@ -1,76 +1,147 @@
 #ifndef PLUGIN_H264_MP4_DEMUXER_H
 #define PLUGIN_H264_MP4_DEMUXER_H
 
-#include "../utils/Common.h"
-#include "../utils/ErrorHandler.h"
+#include "Demuxer.h"
+#include "../utils/ByteSource.h"
 
 // MiniMP4单头文件库（仅在一个源文件中定义实现）
 #include "minimp4.h"
 
+#include <atomic>
 #include <string>
 #include <vector>
-#include <fstream>
 #include <memory>
 
 namespace plugin_h264 {
 
-struct MP4Sample {
-    std::vector<uint8_t> data;
-    uint64_t timestamp;
-    uint32_t duration;
-    bool is_keyframe;
-
-    MP4Sample() : timestamp(0), duration(0), is_keyframe(false) {}
-};
-
-class MP4Demuxer : public ErrorHandler {
+class MP4Demuxer : public Demuxer {
 public:
     MP4Demuxer();
-    ~MP4Demuxer();
+    ~MP4Demuxer() override;
 
     // 禁用拷贝构造和赋值
     MP4Demuxer(const MP4Demuxer&) = delete;
     MP4Demuxer& operator=(const MP4Demuxer&) = delete;
 
-    // 打开MP4文件
+    // 打开MP4文件（优先mmap，失败时回退到ifstream）
     bool open(const std::string& file_path);
 
+    // 从任意字节源打开
+    // 字节源尚未完整（边下载边播放）时只要求moov已经到达，之后的样本随 refresh 陆续加入
+    bool open(std::unique_ptr<ByteSource> source);
+
+    // 是否允许使用mmap（在open之前设置）
+    void setMemoryMapEnabled(bool enabled) { mmap_enabled_ = enabled; }
+    bool isZeroCopy() const;
+
     // 关闭文件
-    void close();
+    void close() override;
 
     // 获取轨道信息
-    std::vector<TrackInfo> getTrackInfo() const;
+    std::vector<TrackInfo> getTrackInfo() const override;
+
+    // avcC/esds中的解码器配置
+    bool getCodecConfig(int track_id, CodecConfig& config) const override;
 
     // 提取SPS/PPS数据（H.264）
     bool extractSPS(int track_id, std::vector<uint8_t>& sps_data) const;
     bool extractPPS(int track_id, std::vector<uint8_t>& pps_data) const;
 
-    // 读取下一个样本
+    // H.264样本中NAL长度前缀的字节数（avcC的lengthSizeMinusOne + 1），无法解析时返回4
+    int getNALLengthSize(int track_id) const;
+
+    // 读取下一个样本（复制到sample.data）
     bool readNextSample(int track_id, MP4Sample& sample);
 
-    // 跳转到指定时间
-    bool seekToTime(double timestamp);
+    // 读取下一个样本的视图，字节源支持时不复制数据
+    bool readNextSample(int track_id, MP4SampleView& view) override;
 
-    // 获取文件持续时间
-    double getDuration() const;
+    // 读取下一个样本到调用方的可写缓冲区（只增不减），view指向buffer，可原地修改
+    bool readNextSampleInto(int track_id, std::vector<uint8_t>& buffer, MP4SampleView& view) override;
 
-    // 获取当前播放时间
-    double getCurrentTime() const;
+    // 按样本序号定位轨道
+    bool seekToSample(int track_id, size_t sample) override;
+
+    // 轨道样本索引，track_id无效时返回nullptr
+    const SampleIndex* getSampleIndex(int track_id) const override;
+
+    // 轨道下一个要读取的样本序号（样本索引下标），track_id无效时返回0
+    size_t getNextSampleNumber(int track_id) const override;
+
+    // 分片MP4（moov中含mvex，样本在moof/mdat中）
+    bool isFragmented() const { return fragmented_; }
+
+    // 重新获取字节源的可读长度并解析新到达的分片，有新样本时返回true
+    // 读到已知样本的末尾时会自动调用
+    bool refresh() override;
+
+    // 字节源尚未完整：此时读取失败表示数据还没有到达，而不是轨道结束
+    bool isWaitingForData() const override;
+
+    // 获取文件持续时间（分片MP4随分片到达而增长）
+    double getDuration() const override;
 
 private:
     MP4D_demux_t demuxer_;
-    std::ifstream file_;
+    std::unique_ptr<ByteSource> source_;
+    bool mmap_enabled_;
     std::vector<TrackInfo> tracks_;
     bool is_open_;
-    double duration_;
-    double current_time_;
+    std::atomic<double> duration_;
 
     // 为每个轨道维护独立的sample索引
     std::vector<unsigned int> track_sample_indices_;
 
+    // 每个轨道的样本表
+    std::vector<SampleIndex> sample_indices_;
+
+    // 字节源不支持视图时，按轨道复用的样本缓冲区
+    std::vector<std::vector<uint8_t>> track_buffers_;
+
+    // 分片轨道状态，按轨道下标
+    struct FragmentTrack {
+        uint32_t track_id;           // 文件中的track_ID（tkhd）
+        uint32_t default_duration;   // trex中的默认值
+        uint32_t default_size;
+        uint32_t default_flags;
+        uint64_t next_decode_time;   // 没有tfdt时分片从上一个分片的末尾继续
+        bool sync_listed;            // sync_samples已逐个列出（出现过非同步样本）
+
+        FragmentTrack() : track_id(0), default_duration(0), default_size(0), default_flags(0),
+                          next_decode_time(0), sync_listed(false) {}
+    };
+
+    // 解析中的分片样本，整个moof引用的数据都到达后才加入样本表
+    struct FragmentSample {
+        size_t track;
+        int64_t offset;
+        uint32_t size;
+        uint64_t timestamp;
+        uint32_t duration;
+        bool is_sync;
+    };
+
+    bool fragmented_;
+    int64_t fragment_offset_;                  // 下一个待解析的顶层盒子
+    std::vector<FragmentTrack> fragment_tracks_;
+
     // 内部辅助方法
+    bool nextSampleLocation(int track_id, MP4D_file_offset_t& offset, unsigned int& frame_bytes,
+                            uint64_t& timestamp, unsigned int& duration);
+    void finishSample(int track_id, const uint8_t* data, unsigned int frame_bytes,
+                      uint64_t timestamp, unsigned int duration, MP4SampleView& view);
     bool parseMP4Structure();
     bool extractTrackInfo();
+    void buildSampleIndex();
+    void parseSyncSampleTables();
+    bool parseTrackSyncSamples(int64_t trak_begin, int64_t trak_end, SampleIndex& index);
+    void parseFragmentTracks(int64_t moov_begin, int64_t moov_end);
+    void parseFragments();
+    bool parseMovieFragment(int64_t moof_begin, int64_t moof_payload, int64_t moof_end);
+    bool parseTrackFragment(const uint8_t* begin, const uint8_t* end, int64_t moof_begin,
+                            std::vector<uint64_t>& decode_times, std::vector<FragmentSample>& samples) const;
+    void appendFragmentSamples(const std::vector<FragmentSample>& samples);
+    bool isSampleAvailable(const SampleIndex& index, size_t sample) const;
     static int readCallback(int64_t offset, void* buffer, size_t size, void* token);
     TrackInfo createTrackInfo(const MP4D_track_t& track);
 };
@@ -45,5 +45,20 @@ static int invalidate(lua_State *L);
 static int isActive(lua_State *L, void *context);
 static int isPlaying(lua_State *L, void *context);
 static int currentTime(lua_State *L, void *context);
+static int frameGeneration(lua_State *L, void *context);
+static int conversionStats(lua_State *L, void *context);
+static int presentationStats(lua_State *L, void *context);
+static int clockTime(lua_State *L, void *context);
+static int syncMode(lua_State *L, void *context);
+static int setClock(lua_State *L);
+static int setSyncMode(lua_State *L);
+static int decodeSkip(lua_State *L, void *context);
+static int skipStats(lua_State *L, void *context);
+static int setDecodeSkip(lua_State *L);
+static int setDecodeLate(lua_State *L);
+static int setBytesAvailable(lua_State *L);
+static int waitingForData(lua_State *L, void *context);
+static int memoryUsage(lua_State *L, void *context);
+static int getStats(lua_State *L);
 static int seek(lua_State *L);
 static int replay(lua_State *L);
@@ -0,0 +1,118 @@
+#ifndef PLUGIN_H264_AUDIO_STREAMER_H
+#define PLUGIN_H264_AUDIO_STREAMER_H
+
+#include "../utils/Common.h"
+#include "../utils/ErrorHandler.h"
+#include "../utils/PCMRingBuffer.h"
+#include "../utils/MemoryTracker.h"
+#include "../managers/MediaClock.h"
+#include "../AL/al.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plugin_h264 {
+
+class H264Movie;
+
+// OpenAL 流式源的可听位置
+// AL_SAMPLE_OFFSET 相对于仍在队列中的第一个缓冲区，加上已出队缓冲区的采样帧数即为播放位置
+// 调用方保证入队/出队记录与 OpenAL 队列一致，并与 getTime 串行
+class AudioPlaybackPosition {
+public:
+    AudioPlaybackPosition();
+
+    void reset(double start_time, int sample_rate);
+    // 按入队顺序记录每个缓冲区的采样帧数
+    void queued(size_t frames);
+    // OpenAL 按入队顺序处理缓冲区，出队的总是最早的一个
+    void unqueued();
+
+    // 源正在播放或暂停时返回可听到的媒体时间
+    bool getTime(ALuint source, double& seconds) const;
+
+private:
+    double start_time_;
+    int sample_rate_;
+    unsigned long long unqueued_frames_;
+    std::deque<size_t> queued_frames_;
+};
+
+// 独立于Lua帧率的音频流
+// 解码线程把AAC解码结果写入PCM环形缓冲区，填充线程轮询OpenAL已播放完的缓冲区并重新填充
+class AudioStreamer : public ErrorHandler, public AudioClockSource {
+public:
+    static const int kNumBuffers = 8;
+    static const int kChunkFrames = 1024;      // 每个OpenAL缓冲区的采样帧数（一个AAC帧）
+    static const int kPollIntervalMs = 5;
+
+    AudioStreamer(H264Movie* movie, ALuint source);
+    ~AudioStreamer();
+
+    // 禁用拷贝构造和赋值
+    AudioStreamer(const AudioStreamer&) = delete;
+    AudioStreamer& operator=(const AudioStreamer&) = delete;
+
+    // first_frame 为已解码的第一帧音频，作为流的起点，移交给音频线程
+    // 运行期间只有音频线程调用 H264Movie 的音频解码接口
+    bool start(AudioFrame&& first_frame);
+    void stop();
+
+    void pause();
+    void resume();
+
+    bool isRunning() const;
+    // 解码完成、缓冲区已取空且OpenAL队列播放完毕
+    bool isFinished() const;
+    // 已送入OpenAL的最后一个样本对应的媒体时间（秒）
+    double getQueuedTime() const;
+    // 此刻播放出来的媒体时间（秒），可以在任意线程调用
+    bool getAudibleTime(double& seconds) const override;
+    // 环形缓冲区、填充缓冲区和送入OpenAL的缓冲区占用的内存，可以在任意线程调用
+    size_t getMemoryUsage() const;
+
+private:
+    void decodeLoop(AudioFrame frame);
+    void feedLoop();
+    // 返回填入的采样帧数，没有足够数据时返回0
+    size_t fillBuffer(ALuint buffer);
+    void playIfNeeded();
+
+    H264Movie* movie_;
+    ALuint source_;
+    ALuint buffers_[kNumBuffers];
+    bool buffers_created_;
+
+    ALenum format_;
+    int sample_rate_;
+    int channels_;
+    double start_timestamp_;
+    unsigned long long queued_samples_;  // 只由填充线程访问
+
+    MemoryCounter memory_;               // 必须在ring_和chunk_之前声明，最后析构
+    std::atomic<size_t> al_buffer_bytes_;
+    std::unique_ptr<PCMRingBuffer> ring_;
+    TrackedVector<int16_t> chunk_;
+    std::vector<ALuint> idle_buffers_;   // 暂时没有数据可填的缓冲区
+
+    // 出入队与读取播放位置之间需要互斥，否则出队瞬间会少算一个缓冲区
+    mutable std::mutex position_mutex_;
+    AudioPlaybackPosition position_;
+    std::atomic<bool> position_valid_;
+
+    std::thread decode_thread_;
+    std::thread feed_thread_;
+    std::mutex control_mutex_;           // 串行化暂停/恢复与欠载后的重新播放
+    std::atomic<bool> stop_requested_;
+    std::atomic<bool> paused_;
+    std::atomic<bool> decoder_finished_;
+    std::atomic<bool> finished_;
+    std::atomic<double> queued_time_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_AUDIO_STREAMER_H
@@ -5,7 +5,9 @@
 #include "../utils/ErrorHandler.h"
 #include "../decoders/H264Decoder.h"
 #include "../decoders/AACDecoder.h"
-#include "../decoders/MP4Demuxer.h"
+#include "../decoders/DemuxerFactory.h"
+#include "../utils/ByteSource.h"
+#include "../utils/MemoryTracker.h"
 #include <memory>
 
 namespace plugin_h264 {
@@ -22,8 +24,20 @@ public:
     // 初始化管理器
     bool initialize();
     
-    // 打开媒体文件
+    // 设置H264解码器配置，已初始化时会用新配置重建解码器
+    bool setH264DecoderConfig(const H264DecoderConfig& config);
+    // 跳帧策略不需要重建解码器，播放中也可以切换
+    void setH264SkipPolicy(DecodeSkipPolicy policy);
+    const H264DecoderConfig& getH264DecoderConfig() const { return h264_config_; }
+    
+    // 裸H.264码流合成时间戳用的帧率（打开文件之前设置），0表示使用SPS中的timing_info
+    void setStreamFrameRate(double fps) { demuxer_options_.frame_rate = fps; }
+
+    // 打开媒体文件，按文件头识别MP4或裸Annex-B码流
     bool openFile(const std::string& file_path);
+
+    // 从字节源打开（如边下载边写入的文件），格式识别同openFile
+    bool openSource(std::unique_ptr<ByteSource> source);
     
     // 关闭文件
     void closeFile();
@@ -34,7 +48,11 @@ public:
     // 获取解码器
     H264Decoder* getH264Decoder() { return h264_decoder_.get(); }
     AACDecoder* getAACDecoder() { return aac_decoder_.get(); }
-    MP4Demuxer* getMP4Demuxer() { return mp4_demuxer_.get(); }
+    Demuxer* getDemuxer() { return demuxer_.get(); }
+
+    // 解码器DPB、解复用索引和音频解码缓冲区的内存，其余分类由调用方补充
+    // 调用方需与解码串行
+    MemoryUsage getMemoryUsage() const;
     
     // 释放资源
     void destroy();
@@ -42,7 +60,9 @@ public:
 private:
     std::unique_ptr<H264Decoder> h264_decoder_;
     std::unique_ptr<AACDecoder> aac_decoder_;
-    std::unique_ptr<MP4Demuxer> mp4_demuxer_;
+    std::unique_ptr<Demuxer> demuxer_;
+    H264DecoderConfig h264_config_;
+    DemuxerOptions demuxer_options_;
     bool initialized_;
     bool file_open_;
 };
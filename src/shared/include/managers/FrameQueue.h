@@ -0,0 +1,92 @@
+#ifndef PLUGIN_H264_FRAME_QUEUE_H
+#define PLUGIN_H264_FRAME_QUEUE_H
+
+#include "../utils/Common.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 拥有像素数据的视频帧（池化缓冲区中的紧凑YUV420）
+// OpenH264零拷贝输出在下一次DecodeFrame2后失效，跨线程传递前必须复制到这里
+struct OwnedVideoFrame {
+    VideoFrame frame;
+
+    // 池化帧只增加引用计数，零拷贝帧复制到pool的缓冲区
+    void copyFrom(const VideoFrame& source, FrameBufferPool& pool);
+};
+
+// 异步解码队列配置
+struct FrameQueueConfig {
+    int depth;              // 队列最多容纳的已解码帧数
+    int high_watermark;     // 达到该帧数时解码线程暂停
+    int low_watermark;      // 降到该帧数时解码线程恢复
+    bool blocking_pop;      // 队列为空时是否等待解码线程
+    int pop_timeout_ms;     // 阻塞弹出的最长等待时间
+
+    FrameQueueConfig() : depth(4), high_watermark(4), low_watermark(2),
+                         blocking_pop(false), pop_timeout_ms(20) {}
+};
+
+// 解码线程（生产者）与 update（消费者）之间的有界帧队列
+class FrameQueue {
+public:
+    explicit FrameQueue(const FrameQueueConfig& config);
+
+    // 禁用拷贝构造和赋值
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // 生产者：按水位等待空位后取得一个写入槽，队列关闭时返回nullptr
+    OwnedVideoFrame* beginPush();
+    // 生产者：提交（commit=false时放弃）写入槽
+    void endPush(OwnedVideoFrame* slot, bool commit);
+    // 生产者：标记没有更多帧
+    void setEndOfStream();
+
+    // 消费者：弹出时间戳不晚于due_time的最新一帧，更早的过期帧被丢弃
+    // 返回的帧在下一次弹出或flush之前有效
+    const VideoFrame* popDue(double due_time);
+    // 消费者：弹出队首帧（不检查时间戳），timeout_ms为-1时按配置决定是否等待
+    const VideoFrame* popNext(int timeout_ms = -1);
+
+    // 清空队列（seek/replay时使用），同时清除结束标志
+    void flush();
+    // 关闭队列，唤醒所有等待的线程
+    void close();
+    void reopen();
+
+    size_t size() const;
+    bool isEndOfStream() const;   // 生产者已结束且队列为空
+    const FrameQueueConfig& getConfig() const { return config_; }
+    unsigned int getDroppedFrames() const;
+
+    // 生产者复制零拷贝帧时使用的缓冲池（所有影片共用），弹出的帧被所有副本释放后缓冲区回到池中
+    FrameBufferPool& getBufferPool() { return buffer_pool_; }
+
+private:
+    const VideoFrame* popLocked(std::unique_lock<std::mutex>& lock, double due_time, bool check_due, int timeout_ms);
+    void recycleLocked(std::unique_ptr<OwnedVideoFrame> slot);
+
+    FrameQueueConfig config_;
+    FrameBufferPool& buffer_pool_;
+    std::deque<std::unique_ptr<OwnedVideoFrame>> ready_;
+    std::vector<std::unique_ptr<OwnedVideoFrame>> free_;
+    std::unique_ptr<OwnedVideoFrame> writing_;    // 单生产者，同时最多一个写入槽
+    std::unique_ptr<OwnedVideoFrame> presented_;  // 消费者当前持有的帧
+
+    mutable std::mutex mutex_;
+    std::condition_variable space_cv_;
+    std::condition_variable frame_cv_;
+    bool closed_;
+    bool end_of_stream_;
+    bool producer_paused_;
+    unsigned int dropped_frames_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_FRAME_QUEUE_H
@@ -4,11 +4,26 @@
 #include "../utils/Common.h"
 #include "../utils/ErrorHandler.h"
 #include "../managers/DecoderManager.h"
+#include "../managers/FrameQueue.h"
+#include "../utils/PerfStats.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace plugin_h264 {
 
+// 呈现调度统计
+struct PresentationStats {
+    uint64_t presented;    // 显示的新帧
+    uint64_t dropped;      // 解码后被更晚的到期帧取代、没有显示的帧
+    uint64_t skipped;      // 落后时按跳帧策略没有送入解码器的帧
+    uint64_t duplicated;   // 没有到期的新帧，继续显示上一帧的次数
+
+    PresentationStats() : presented(0), dropped(0), skipped(0), duplicated(0) {}
+};
+
 class H264Movie : public ErrorHandler {
 public:
     H264Movie();
@@ -18,9 +33,26 @@ public:
     H264Movie(const H264Movie&) = delete;
     H264Movie& operator=(const H264Movie&) = delete;
 
-    // 加载电影文件
+    // 设置H264解码器配置（线程数、错误隐藏等），需在加载之前调用
+    bool setDecoderConfig(const H264DecoderConfig& config);
+
+    // 裸H.264码流（.h264）合成时间戳的帧率，需在加载之前调用，0表示使用SPS中的timing_info
+    void setStreamFrameRate(double fps);
+
+    // 加载电影文件（MP4或裸Annex-B码流，按文件内容识别）
     bool loadFromFile(const std::string& file_path);
 
+    // 从内存加载（如资源包中的视频），容器格式识别同loadFromFile
+    // BORROW 时数据不复制，调用方需保证数据在影片关闭或重新加载之前有效
+    bool loadFromMemory(const uint8_t* data, size_t size, MemoryOwnership ownership);
+
+    // 边下载边播放：文件仍在写入，bytes_available 报告已写入的字节数和是否下载完成
+    // 需要moov已经写入（分片MP4或moov在前的MP4），之后的样本到达后即可播放
+    bool loadFromStream(const std::string& file_path, GrowingFileSource::BytesAvailableCallback bytes_available);
+
+    // 数据还没有下载到，视频/音频暂时读不到样本但轨道并未结束
+    bool isWaitingForData() const;
+
     // 播放控制
     bool play();
     bool pause();
@@ -40,7 +72,8 @@ public:
 
     // 获取当前帧
     VideoFrame getCurrentVideoFrame();
-    AudioFrame getCurrentAudioFrame();
+    // 音频帧移交给调用方（不复制样本），之后内部不再持有
+    AudioFrame takeCurrentAudioFrame();
 
     // 解码下一帧
     bool decodeNextFrame();
@@ -52,12 +85,65 @@ public:
     // 定位
     bool seekTo(double timestamp);
 
+    // 异步解码：独立线程提前解码视频到有界帧队列，需在加载后调用
+    bool enableAsyncDecode(const FrameQueueConfig& config);
+    void disableAsyncDecode();
+    bool isAsyncDecodeEnabled() const;
+    size_t getQueuedVideoFrames() const;
+
+    // 取出时间戳不晚于due_time的视频帧（异步模式），同步模式下等价于decodeNextVideoFrame
+    bool popDueVideoFrame(double due_time);
+
+    // 呈现调度：按主时钟clock_time（秒）解码到此刻应显示的帧，中间帧丢弃
+    // 追赶期间置位解码器的落后信号，由跳帧策略决定哪些帧不送入解码器
+    // 有新帧时返回true，通过getCurrentVideoFrame取出；返回false时继续显示上一帧
+    bool presentVideoFrame(double clock_time);
+    const PresentationStats& getPresentationStats() const { return presentation_stats_; }
+
+    // 外部落后信号（如游戏帧超出预算），置位期间解码器始终按跳帧策略丢帧
+    void setDecodeLate(bool late);
+    bool isDecodeLate() const { return decode_late_; }
+    bool setDecodeSkipPolicy(DecodeSkipPolicy policy);
+    DecodeSkipPolicy getDecodeSkipPolicy() const;
+    DecodeSkipStats getDecodeSkipStats() const;
+
+    // 解码器、解复用器和音频解码的内存，加上共用帧缓冲池的全部内存（空闲和使用中，所有影片共享）
+    // 纹理缓冲区和音频流由持有它们的调用方补充
+    MemoryUsage getMemoryUsage() const;
+
+    // 分阶段耗时统计（解复用、AVCC转换、视频/音频解码，以及调用方记录的颜色转换和音频填充）
+    PerfStats& getPerfStats() { return perf_stats_; }
+    const PerfStats& getPerfStats() const { return perf_stats_; }
+
 private:
+    // 打开文件后读取轨道信息并预配置解码器
+    bool finishLoad();
+    // 把视频轨道的SPS/PPS送入H264解码器，并记录样本的NAL长度前缀字节数
+    bool sendParameterSets();
+
+    // 解码下一个可显示的视频帧，调用方需持有decode_mutex_
+    // seek后目标时间之前的帧在这里解码并丢弃
+    bool decodeVideoSample(VideoFrame& frame);
+    // 从解复用器读取并解码一个视频样本
+    bool decodeVideoAccessUnit(VideoFrame& frame);
+    // 调度器判断的落后状态与外部信号合并后传给解码器
+    void updateDecoderLate(bool behind);
+
+    // 视频轨道第ahead个待读样本的时间（秒），没有更多样本时返回false，调用方需持有decode_mutex_
+    bool peekVideoSampleTime(size_t ahead, double& seconds) const;
+
+    void startDecodeThread();
+    bool stopDecodeThread();
+    void decodeThreadLoop();
+
     std::unique_ptr<DecoderManager> decoder_manager_;
     bool is_loaded_;
     bool is_playing_;
     double duration_;
     std::vector<TrackInfo> tracks_;
+    // 第一个H264视频轨道和AAC音频轨道，加载时解析，没有时无效
+    TrackDescriptor video_track_;
+    TrackDescriptor audio_track_;
 
     // 内部状态
     VideoFrame current_video_frame_;
@@ -65,13 +151,31 @@ private:
     bool has_new_video_frame_;
     bool has_new_audio_frame_;
 
-    // 轨道完成状态
-    bool video_track_finished_;
-    bool audio_track_finished_;
+    // 轨道完成状态（可能由视频/音频解码线程写入）
+    std::atomic<bool> video_track_finished_;
+    std::atomic<bool> audio_track_finished_;
+
+    // seek目标时间（秒），小于0表示没有需要丢弃的帧
+    double seek_target_;
+
+    PresentationStats presentation_stats_;
+    std::atomic<bool> decode_late_;
+    PerfStats perf_stats_;
 
     // 解码器配置状态
     bool sps_pps_sent_;
     bool aac_configured_;
+
+    // 样本缓冲区（原地改写为Annex-B）和1/2字节长度前缀时的转换缓冲区，只增不减
+    int nal_length_size_;
+    std::vector<uint8_t> sample_buffer_;
+    std::vector<uint8_t> annexb_buffer_;
+
+    // 异步解码状态：decode_mutex_ 保护解复用器和解码器，音频解码与解码线程共用
+    mutable std::mutex decode_mutex_;
+    std::unique_ptr<FrameQueue> frame_queue_;
+    std::thread decode_thread_;
+    std::atomic<bool> decode_thread_stop_;
 };
 
 } // namespace plugin_h264
@@ -0,0 +1,74 @@
+#ifndef PLUGIN_H264_MEDIA_CLOCK_H
+#define PLUGIN_H264_MEDIA_CLOCK_H
+
+#include "../utils/Common.h"
+#include <mutex>
+
+namespace plugin_h264 {
+
+// 主时钟来源
+enum class ClockMode {
+    AUDIO_MASTER,      // 以可听到的音频位置为准，没有音频在播放时按系统时间推进
+    VIDEO_MASTER,      // 按系统时间推进，视频按自己的时间戳显示，音频自由播放
+    EXTERNAL_MASTER    // 由调用方设置（例如游戏自己的时间轴）
+};
+
+// 音频时钟源：报告此刻真正播放出来的媒体时间
+class AudioClockSource {
+public:
+    virtual ~AudioClockSource() {}
+
+    // 可听到的媒体时间（秒），音频没有在播放（未启动、欠载、已结束）时返回false
+    virtual bool getAudibleTime(double& seconds) const = 0;
+};
+
+// 音视频主时钟，update 和解码线程都可以读取
+class MediaClock {
+public:
+    MediaClock();
+
+    // 禁用拷贝构造和赋值
+    MediaClock(const MediaClock&) = delete;
+    MediaClock& operator=(const MediaClock&) = delete;
+
+    void setMode(ClockMode mode);
+    ClockMode getMode() const;
+
+    // 音频主时钟的来源，调用方负责在来源销毁之前把它清除
+    void setAudioSource(const AudioClockSource* source);
+
+    // 从media_time重新开始计时（seek、replay），保持暂停状态不变
+    void reset(double media_time);
+    void pause();
+    void resume();
+    bool isPaused() const;
+
+    // 外部主时钟模式下由调用方推进
+    void setExternalTime(double media_time);
+
+    // 主时钟时间（秒），线程安全
+    double getTime() const;
+
+    // "audio" / "video" / "external"
+    static bool parseMode(const char* name, ClockMode& mode);
+    static const char* getModeName(ClockMode mode);
+
+private:
+    double getSystemTimeLocked() const;
+    static double now();
+
+    mutable std::mutex mutex_;
+    ClockMode mode_;
+    const AudioClockSource* audio_source_;
+
+    // 系统时间推进的锚点，音频可用时随音频位置重新锚定，音频中断后从这里平滑继续
+    mutable double anchor_media_time_;
+    mutable double anchor_system_time_;
+    bool paused_;
+
+    double external_time_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_MEDIA_CLOCK_H
@@ -0,0 +1,135 @@
+#ifndef PLUGIN_H264_BYTE_SOURCE_H
+#define PLUGIN_H264_BYTE_SOURCE_H
+
+#include "Common.h"
+#include "ErrorHandler.h"
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 字节源接口：解复用器通过它随机读取媒体数据
+class ByteSource : public ErrorHandler {
+public:
+    virtual ~ByteSource() {}
+
+    // 数据总长度
+    virtual int64_t size() const = 0;
+
+    // 复制 [offset, offset + length) 到buffer，越界或读取失败返回false
+    virtual bool read(int64_t offset, void* buffer, size_t length) = 0;
+
+    // 返回 [offset, offset + length) 的只读指针（零拷贝），后端不支持或越界时返回nullptr
+    // 指针在字节源关闭之前有效
+    virtual const uint8_t* view(int64_t /*offset*/, size_t /*length*/) const { return nullptr; }
+
+    // 增长中的字节源（边下载边播放）：重新获取可读长度，size()增长或数据变为完整时返回true
+    virtual bool refresh() { return false; }
+
+    // 数据已全部可读，size()不会再增长
+    virtual bool isComplete() const { return true; }
+};
+
+// 内存映射文件（POSIX mmap），读取是一次memcpy，view为零拷贝
+class MappedFileSource : public ByteSource {
+public:
+    MappedFileSource();
+    ~MappedFileSource();
+
+    // 禁用拷贝构造和赋值
+    MappedFileSource(const MappedFileSource&) = delete;
+    MappedFileSource& operator=(const MappedFileSource&) = delete;
+
+    bool open(const std::string& file_path);
+    void close();
+
+    int64_t size() const override { return size_; }
+    bool read(int64_t offset, void* buffer, size_t length) override;
+    const uint8_t* view(int64_t offset, size_t length) const override;
+
+private:
+    const uint8_t* data_;
+    int64_t size_;
+};
+
+// std::ifstream 后端，不支持mmap时的回退
+class StreamFileSource : public ByteSource {
+public:
+    StreamFileSource();
+
+    bool open(const std::string& file_path);
+    void close();
+
+    int64_t size() const override { return size_; }
+    bool read(int64_t offset, void* buffer, size_t length) override;
+
+private:
+    std::ifstream file_;
+    int64_t size_;
+};
+
+// 正在下载写入的文件，size()只包含已经写入的部分
+// bytes_available 回调返回已写入的字节数（负数表示以磁盘上的文件大小为准），下载完成时把complete置为true；
+// 回调在读取数据的线程中调用。没有回调时按普通文件处理，打开时即完整
+// refresh在解码线程中更新可读长度，size()和isComplete()可以在其他线程（如Lua线程查询是否在等待数据）读取
+class GrowingFileSource : public ByteSource {
+public:
+    typedef std::function<int64_t(bool& complete)> BytesAvailableCallback;
+
+    GrowingFileSource();
+
+    bool open(const std::string& file_path, BytesAvailableCallback bytes_available);
+    void close();
+
+    int64_t size() const override { return available_; }
+    bool read(int64_t offset, void* buffer, size_t length) override;
+    bool refresh() override;
+    bool isComplete() const override { return complete_; }
+
+private:
+    int64_t fileSize();
+
+    std::ifstream file_;
+    BytesAvailableCallback bytes_available_;
+    std::atomic<int64_t> available_;
+    std::atomic<bool> complete_;
+};
+
+// 内存数据的所有权
+enum class MemoryOwnership {
+    BORROW,     // 不复制，调用方保证数据在字节源关闭之前有效且不被修改
+    COPY        // 打开时复制一份，之后调用方可以立即释放数据
+};
+
+// 内存中的媒体数据（如资源包中的视频），view为零拷贝
+class MemorySource : public ByteSource {
+public:
+    MemorySource();
+
+    // 禁用拷贝构造和赋值
+    MemorySource(const MemorySource&) = delete;
+    MemorySource& operator=(const MemorySource&) = delete;
+
+    bool open(const uint8_t* data, size_t size, MemoryOwnership ownership);
+    void close();
+
+    int64_t size() const override { return size_; }
+    bool read(int64_t offset, void* buffer, size_t length) override;
+    const uint8_t* view(int64_t offset, size_t length) const override;
+
+private:
+    std::vector<uint8_t> copy_;     // COPY模式下持有的数据
+    const uint8_t* data_;
+    int64_t size_;
+};
+
+// 打开文件：优先使用mmap，失败（或禁用）时回退到ifstream，都失败返回nullptr
+std::unique_ptr<ByteSource> openFileSource(const std::string& file_path, bool allow_mmap = true);
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_BYTE_SOURCE_H
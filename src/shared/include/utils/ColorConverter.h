@@ -0,0 +1,50 @@
+#ifndef PLUGIN_H264_COLOR_CONVERTER_H
+#define PLUGIN_H264_COLOR_CONVERTER_H
+
+#include "Common.h"
+
+namespace plugin_h264 {
+
+class WorkerPool;
+
+// YUV420 -> RGBA 颜色转换
+// 定点运算（BT.601全范围，与原浮点实现系数一致），按行对处理以共享色度行，
+// 运行时根据CPU能力选择 SSE2 / AVX2 / NEON 实现，标量实现作为回退和尾部处理
+class ColorConverter {
+public:
+    enum class Backend {
+        SCALAR = 0,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    // 检测当前CPU支持的最快实现
+    static Backend detectBackend();
+
+    // 当前使用的实现
+    static Backend activeBackend();
+
+    // 强制使用指定实现（用于测试和基准测试），不支持时返回false
+    static bool setBackend(Backend backend);
+
+    static bool isBackendSupported(Backend backend);
+    static const char* backendName(Backend backend);
+
+    // 转换整帧，rgba_stride为输出每行字节数（通常为 width * 4）
+    static void convertYUV420ToRGBA(const VideoFrame& frame, uint8_t* rgba, int rgba_stride);
+
+    // 按色度行对齐的水平条带并行转换；小帧或pool为空时退化为单线程
+    static void convertYUV420ToRGBA(const VideoFrame& frame, uint8_t* rgba, int rgba_stride,
+                                    WorkerPool* pool);
+
+    // 低于该像素数时分发开销大于收益，不做并行
+    static const int kParallelMinPixels = 640 * 480;
+
+    // 原逐像素浮点实现，仅作为正确性参照
+    static void convertYUV420ToRGBAReference(const VideoFrame& frame, uint8_t* rgba, int rgba_stride);
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_COLOR_CONVERTER_H
@@ -1,10 +1,13 @@
 #ifndef PLUGIN_H264_COMMON_H
 #define PLUGIN_H264_COMMON_H
 
+#include "FrameBuffer.h"
+#include "PCMBuffer.h"
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
+#include <utility>
 
 namespace plugin_h264 {
 
@@ -27,6 +30,8 @@ enum class H264Error {
 };
 
 // 视频帧结构 - 优化版本支持零拷贝模式
+// 零拷贝帧指向解码器内部缓冲区，下一次解码后失效；
+// 池化帧（buffer非空）持有缓冲区的引用，可以跨解码保留或交给其他线程，最后一个副本释放时回到池中
 struct VideoFrame {
     uint8_t* y_plane;    // Y平面数据指针（支持零拷贝）
     uint8_t* u_plane;    // U平面数据指针
@@ -37,6 +42,7 @@ struct VideoFrame {
     int uv_stride;       // UV平面stride（可能 != width/2）
     double timestamp;    // 时间戳
     bool zero_copy_mode; // 是否为零拷贝模式（数据来自解码器内部缓冲区）
+    FrameBuffer buffer;  // 池化帧的像素数据，零拷贝帧为空
 
     VideoFrame() : y_plane(nullptr), u_plane(nullptr), v_plane(nullptr),
                    width(0), height(0), y_stride(0), uv_stride(0), 
@@ -47,21 +53,40 @@ struct VideoFrame {
                width > 0 && height > 0;
     }
 
+    // 像素数据归帧所有（不依赖解码器内部缓冲区）
+    bool isOwned() const { return !buffer.empty(); }
+
+    // 改为引用池化缓冲区中的紧凑平面，其余字段不变
+    void setBuffer(FrameBuffer frame_buffer) {
+        buffer = std::move(frame_buffer);
+        y_plane = buffer.plane(0);
+        u_plane = buffer.plane(1);
+        v_plane = buffer.plane(2);
+        y_stride = buffer.stride(0);
+        uv_stride = buffer.stride(1);
+        zero_copy_mode = false;
+    }
+
     // 检查是否为紧凑格式（stride == width）
     bool isCompactFormat() const {
         return y_stride == width && uv_stride == (width / 2);
     }
 };
 
-// 音频帧结构
+// 音频帧结构：样本在解码器的PCM缓冲区池中，只能移动，从解码器一路交给OpenAL填充方
 struct AudioFrame {
-    std::vector<int16_t> samples;
+    PCMBuffer samples;   // 交错的int16样本
     int sample_rate;
     int channels;
     double timestamp;
 
     AudioFrame() : sample_rate(0), channels(0), timestamp(0.0) {}
 
+    AudioFrame(AudioFrame&&) = default;
+    AudioFrame& operator=(AudioFrame&&) = default;
+    AudioFrame(const AudioFrame&) = delete;
+    AudioFrame& operator=(const AudioFrame&) = delete;
+
     bool isValid() const {
         return !samples.empty() && sample_rate > 0 && channels > 0;
     }
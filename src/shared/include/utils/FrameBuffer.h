@@ -0,0 +1,116 @@
+#ifndef PLUGIN_H264_FRAME_BUFFER_H
+#define PLUGIN_H264_FRAME_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace plugin_h264 {
+
+class FrameBufferPool;
+
+// 引用计数的YUV420帧缓冲区句柄，最后一个引用释放时数据块回到所属的池
+// Y/U/V三个平面的起始地址按kAlignment字节对齐，行紧凑排列（stride == 平面宽度）
+// 复制只增加引用计数，可以在线程之间传递；只在获取后、交出之前写入
+class FrameBuffer {
+public:
+    static const size_t kAlignment = 64;
+
+    FrameBuffer() : block_(nullptr) {}
+    ~FrameBuffer() { release(); }
+
+    FrameBuffer(const FrameBuffer& other);
+    FrameBuffer(FrameBuffer&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    FrameBuffer& operator=(const FrameBuffer& other);
+    FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+
+    // 平面序号：0为Y，1为U，2为V
+    uint8_t* plane(int index) const;
+    int stride(int index) const;
+    int width() const;
+    int height() const;
+    // 数据块容量（字节，按大小级别向上取整）
+    size_t capacity() const;
+    bool empty() const { return block_ == nullptr; }
+
+    // 共享同一数据块的句柄数
+    int useCount() const;
+
+    // 从带stride的源平面复制像素
+    void copyFrom(const uint8_t* y, const uint8_t* u, const uint8_t* v, int y_stride, int uv_stride);
+
+    // 释放引用，句柄变为空
+    void reset() { release(); }
+
+private:
+    friend class FrameBufferPool;
+    struct Block;
+    struct PoolState;
+    struct ThreadCache;
+
+    explicit FrameBuffer(Block* block) : block_(block) {}
+    void release();
+    static ThreadCache& threadCache();
+
+    Block* block_;
+};
+
+// 帧缓冲池统计，用于在低端设备上调整内存上限
+struct FrameBufferPoolStats {
+    uint64_t hits;            // 复用空闲块的获取次数（含线程缓存）
+    uint64_t misses;          // 新分配数据块的获取次数
+    size_t bytes_held;        // 空闲块（共享空闲表和线程缓存）占用的字节
+    size_t bytes_in_use;      // 帧正在使用的数据块字节
+    size_t high_water;        // 已分配字节（空闲 + 使用中）的最大值
+    size_t max_free_bytes;    // 空闲块的字节上限
+
+    FrameBufferPoolStats() : hits(0), misses(0), bytes_held(0), bytes_in_use(0),
+                             high_water(0), max_free_bytes(0) {}
+};
+
+// 帧缓冲池：按大小级别（每次翻倍之间分4级，浪费不超过25%）分开保存空闲块，
+// 不同分辨率的帧不会互相挤掉空闲块
+// 释放的块先放进释放线程的小缓存，同一线程再次获取时不与其他线程争用；
+// 其余放进每个级别的共享空闲表（固定数量的原子槽位，只做原子交换，不加锁）
+// 空闲块的总字节数不超过上限，超出时直接回收
+// 池销毁后仍在使用的缓冲区在最后一个引用释放时回收
+class FrameBufferPool {
+public:
+    static const size_t kDefaultMaxFreeBytes = 32 * 1024 * 1024;
+
+    explicit FrameBufferPool(size_t max_free_bytes = kDefaultMaxFreeBytes);
+    ~FrameBufferPool();
+
+    // 禁用拷贝构造和赋值
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    // 所有影片共用的视频帧池，解码器和帧队列从这里获取缓冲区
+    static FrameBufferPool& shared();
+
+    // 获取width x height的YUV420缓冲区，尺寸无效时返回空句柄，内存不足时抛出std::bad_alloc
+    FrameBuffer acquire(int width, int height);
+
+    // 空闲块的字节上限，降低时立即释放当前线程缓存和共享空闲表中超出的块
+    void setMaxFreeBytes(size_t bytes);
+    size_t getMaxFreeBytes() const;
+
+    // 释放共享空闲表和当前线程缓存中的空闲块；其他线程缓存中的块在该线程下次使用池或退出时回收
+    void clear();
+
+    size_t getFreeCount() const;
+    // 池中空闲数据块占用的内存
+    size_t getMemoryUsage() const;
+
+    FrameBufferPoolStats getStats() const;
+    // 清零命中计数，高水位从当前已分配字节重新开始
+    void resetStats();
+
+private:
+    std::shared_ptr<FrameBuffer::PoolState> state_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_FRAME_BUFFER_H
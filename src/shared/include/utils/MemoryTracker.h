@@ -0,0 +1,100 @@
+#ifndef PLUGIN_H264_MEMORY_TRACKER_H
+#define PLUGIN_H264_MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 一类内存的当前字节数和峰值，可以在任意线程读取
+class MemoryCounter {
+public:
+    MemoryCounter() : bytes_(0), peak_(0) {}
+
+    // 禁用拷贝构造和赋值
+    MemoryCounter(const MemoryCounter&) = delete;
+    MemoryCounter& operator=(const MemoryCounter&) = delete;
+
+    void add(size_t bytes) {
+        size_t total = bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_.load(std::memory_order_relaxed);
+        while (total > peak && !peak_.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+        }
+    }
+
+    void sub(size_t bytes) { bytes_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+    size_t getBytes() const { return bytes_.load(std::memory_order_relaxed); }
+    size_t getPeak() const { return peak_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> bytes_;
+    std::atomic<size_t> peak_;
+};
+
+// 把实际分配的字节数记到MemoryCounter上的分配器，counter为空时不计数
+// 计数器必须比使用它的容器活得久
+template <typename T>
+class TrackingAllocator {
+public:
+    typedef T value_type;
+
+    TrackingAllocator() noexcept : counter_(nullptr) {}
+    explicit TrackingAllocator(MemoryCounter* counter) noexcept : counter_(counter) {}
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U>& other) noexcept : counter_(other.getCounter()) {}
+
+    T* allocate(size_t count) {
+        T* data = static_cast<T*>(::operator new(count * sizeof(T)));
+        if (counter_) {
+            counter_->add(count * sizeof(T));
+        }
+        return data;
+    }
+
+    void deallocate(T* data, size_t count) noexcept {
+        if (counter_) {
+            counter_->sub(count * sizeof(T));
+        }
+        ::operator delete(data);
+    }
+
+    MemoryCounter* getCounter() const noexcept { return counter_; }
+
+private:
+    MemoryCounter* counter_;
+};
+
+template <typename T, typename U>
+bool operator==(const TrackingAllocator<T>& a, const TrackingAllocator<U>& b) noexcept {
+    return a.getCounter() == b.getCounter();
+}
+
+template <typename T, typename U>
+bool operator!=(const TrackingAllocator<T>& a, const TrackingAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
+template <typename T>
+using TrackedVector = std::vector<T, TrackingAllocator<T>>;
+
+// 一个影片的内存占用（字节），按来源分类
+struct MemoryUsage {
+    size_t decoder_dpb;       // OpenH264的参考帧缓冲区，按SPS参考帧数和实际分辨率计算
+    size_t frame_pool;        // 所有影片共用的视频帧缓冲池（空闲和使用中）
+    size_t texture_buffers;   // RGBA输出或YUV平面纹理的缓冲区
+    size_t demuxer_index;     // 解复用器的样本索引
+    size_t audio_queues;      // PCM缓冲池、环形缓冲区和送入OpenAL的缓冲区
+
+    MemoryUsage() : decoder_dpb(0), frame_pool(0), texture_buffers(0), demuxer_index(0), audio_queues(0) {}
+
+    size_t total() const {
+        return decoder_dpb + frame_pool + texture_buffers + demuxer_index + audio_queues;
+    }
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_MEMORY_TRACKER_H
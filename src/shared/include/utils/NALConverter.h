@@ -0,0 +1,57 @@
+#ifndef PLUGIN_H264_NAL_CONVERTER_H
+#define PLUGIN_H264_NAL_CONVERTER_H
+
+#include "Common.h"
+
+namespace plugin_h264 {
+
+// Annex-B 访问单元中片的属性
+struct SliceInfo {
+    bool has_slice;      // 含有片（NAL类型1~5）
+    bool is_reference;   // 任一片的nal_ref_idc不为0
+    bool is_idr;         // 含有IDR片（NAL类型5）
+
+    SliceInfo() : has_slice(false), is_reference(false), is_idr(false) {}
+};
+
+// H.264 NAL 封装转换：MP4 中的 AVCC（长度前缀）-> 解码器需要的 Annex-B（起始码）
+// 长度前缀为大端序，字节数由 avcC 盒的 lengthSizeMinusOne 决定（1/2/4字节）
+class NALConverter {
+public:
+    // Annex-B 起始码长度
+    static const int kStartCodeSize = 4;
+
+    // 从 avcC 盒内容（AVCDecoderConfigurationRecord）读取长度前缀字节数
+    // 返回 1/2/4，数据无效或为保留值3字节时返回0
+    static int parseLengthSize(const uint8_t* avcc, size_t size);
+
+    // 4字节长度前缀与起始码等长，直接在样本缓冲区内改写
+    // 格式错误（长度越界、尾部残缺）时返回false，此时缓冲区可能已部分改写
+    static bool rewriteInPlace(uint8_t* data, size_t size);
+
+    // 转换后的 Annex-B 字节数，格式错误返回0
+    static size_t annexBSize(const uint8_t* data, size_t size, int length_size);
+
+    // 任意长度前缀转换到dst（不能与data重叠），返回写入的字节数
+    // 格式错误或dst空间不足时返回0
+    static size_t convert(const uint8_t* data, size_t size, int length_size,
+                          uint8_t* dst, size_t capacity);
+
+    // AVCC样本是否会被其他帧参考：任一片（NAL类型1~5）的nal_ref_idc不为0时返回true
+    // 找不到片或格式错误时也返回true，调用方不应跳过这样的样本
+    static bool isReferenceSample(const uint8_t* data, size_t size, int length_size);
+
+    // 扫描 Annex-B 数据（3或4字节起始码）中所有NAL头
+    static SliceInfo inspectAnnexB(const uint8_t* data, size_t size);
+
+    // 查找第一个 00 00 01 起始码，返回其第一个字节的位置，找不到时返回size
+    // 用memchr查找0x01（libc中为SIMD实现），再检查前两个字节；4字节起始码返回第二个0的位置
+    static size_t findStartCode(const uint8_t* data, size_t size);
+
+private:
+    static bool readLength(const uint8_t* data, int length_size, uint32_t& length);
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_NAL_CONVERTER_H
@@ -0,0 +1,77 @@
+#ifndef PLUGIN_H264_PCM_BUFFER_H
+#define PLUGIN_H264_PCM_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace plugin_h264 {
+
+class PCMBufferPool;
+
+// 引用计数的int16 PCM缓冲区句柄，最后一个引用释放时数据块回到所属的池
+// 复制只增加引用计数，数据块由多个句柄共享；只在获取后、交出之前写入
+class PCMBuffer {
+public:
+    PCMBuffer() : block_(nullptr) {}
+    ~PCMBuffer() { release(); }
+
+    PCMBuffer(const PCMBuffer& other);
+    PCMBuffer(PCMBuffer&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    PCMBuffer& operator=(const PCMBuffer& other);
+    PCMBuffer& operator=(PCMBuffer&& other) noexcept;
+
+    int16_t* data();
+    const int16_t* data() const;
+    size_t size() const;
+    size_t capacity() const;
+    bool empty() const { return size() == 0; }
+
+    // 调整有效样本数，不超过容量，不会重新分配
+    void setSize(size_t size);
+
+    // 释放引用，句柄变为空
+    void reset() { release(); }
+
+private:
+    friend class PCMBufferPool;
+    struct Block;
+    struct PoolState;
+
+    explicit PCMBuffer(Block* block) : block_(block) {}
+    void release();
+
+    Block* block_;
+};
+
+// PCM缓冲区池：空闲数据块（保留容量）在获取时复用，稳定播放时不再分配内存
+// 可在任意线程获取和释放；池销毁后仍在使用的缓冲区释放时直接回收内存
+class PCMBufferPool {
+public:
+    explicit PCMBufferPool(size_t max_free = 8);
+    ~PCMBufferPool();
+
+    // 禁用拷贝构造和赋值
+    PCMBufferPool(const PCMBufferPool&) = delete;
+    PCMBufferPool& operator=(const PCMBufferPool&) = delete;
+
+    // 获取容量不少于capacity个样本的缓冲区，有效样本数为capacity
+    PCMBuffer acquire(size_t capacity);
+
+    // 释放所有空闲数据块
+    void clear();
+
+    size_t getFreeCount() const;
+    // 池中空闲数据块占用的内存
+    size_t getMemoryUsage() const;
+
+private:
+    std::shared_ptr<PCMBuffer::PoolState> state_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_PCM_BUFFER_H
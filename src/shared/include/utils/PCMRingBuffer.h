@@ -0,0 +1,45 @@
+#ifndef PLUGIN_H264_PCM_RING_BUFFER_H
+#define PLUGIN_H264_PCM_RING_BUFFER_H
+
+#include "Common.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 单生产者单消费者无锁PCM环形缓冲区
+// 生产者（音频解码线程）只调用write，消费者（OpenAL填充线程）只调用read
+class PCMRingBuffer {
+public:
+    // 容量向上取整到2的幂（单位：int16样本），缓冲区内存记到counter上（为空时不计数）
+    explicit PCMRingBuffer(size_t min_capacity, MemoryCounter* counter = nullptr);
+
+    // 禁用拷贝构造和赋值
+    PCMRingBuffer(const PCMRingBuffer&) = delete;
+    PCMRingBuffer& operator=(const PCMRingBuffer&) = delete;
+
+    // 返回实际写入/读出的样本数，不会阻塞
+    size_t write(const int16_t* samples, size_t count);
+    size_t read(int16_t* samples, size_t count);
+
+    size_t available() const;   // 可读样本数
+    size_t space() const;       // 可写样本数
+    size_t capacity() const { return buffer_.size(); }
+
+    // 清空，只能在生产者和消费者都停止时调用
+    void reset();
+
+private:
+    TrackedVector<int16_t> buffer_;
+    size_t mask_;
+
+    // 读写位置单调递增，用填充隔开避免伪共享（C++14不保证过对齐的new，不用alignas）
+    std::atomic<size_t> write_pos_;
+    char padding_[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> read_pos_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_PCM_RING_BUFFER_H
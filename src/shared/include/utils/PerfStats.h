@@ -0,0 +1,117 @@
+#ifndef PLUGIN_H264_PERF_STATS_H
+#define PLUGIN_H264_PERF_STATS_H
+
+// 分阶段计时开关：定义为0时（CMake选项ENABLE_PERF_STATS=OFF）计时代码和计数器全部编译掉
+#ifndef PLUGIN_H264_ENABLE_PERF_STATS
+#define PLUGIN_H264_ENABLE_PERF_STATS 1
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace plugin_h264 {
+
+// 计时的处理阶段
+enum class PerfStage {
+    DEMUX,          // 从解复用器读取一个样本（视频和音频）
+    AVCC_CONVERT,   // AVCC长度前缀转换为Annex-B起始码
+    H264_DECODE,    // OpenH264解码一个访问单元
+    AAC_DECODE,     // FDK-AAC解码一帧
+    YUV_TO_RGBA,    // 颜色转换，YUV输出模式下为平面打包
+    AUDIO_REFILL,   // 填充一个OpenAL缓冲区
+    COUNT
+};
+
+// 单个阶段的统计快照，耗时单位为纳秒
+// 直方图按微秒的2的幂分桶：第0个桶为不足1微秒，第i个桶为[2^(i-1), 2^i)微秒，最后一个桶不设上限
+struct PerfStageStats {
+    static const int kBucketCount = 18;
+
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t buckets[kBucketCount];
+
+    PerfStageStats();
+
+    double getMeanMs() const;
+    // 按直方图估计的百分位耗时（取所在桶的上界，不超过最大值），quantile取0~1
+    double getPercentileMs(double quantile) const;
+};
+
+// 一个影片各阶段的耗时计数：记录只做原子加法，不加锁，可以在任意线程记录和读取
+// 快照中各字段分别读取，与正在进行的记录之间不保证一致
+class PerfStats {
+public:
+    PerfStats();
+
+    // 禁用拷贝构造和赋值
+    PerfStats(const PerfStats&) = delete;
+    PerfStats& operator=(const PerfStats&) = delete;
+
+    void record(PerfStage stage, uint64_t nanoseconds);
+    PerfStageStats getStageStats(PerfStage stage) const;
+    void reset();
+
+    static bool isEnabled() { return PLUGIN_H264_ENABLE_PERF_STATS != 0; }
+    static const char* getStageName(PerfStage stage);
+    static int getBucketIndex(uint64_t nanoseconds);
+
+private:
+#if PLUGIN_H264_ENABLE_PERF_STATS
+    struct StageCounters {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total_ns;
+        std::atomic<uint64_t> max_ns;
+        std::atomic<uint64_t> buckets[PerfStageStats::kBucketCount];
+    };
+
+    StageCounters stages_[static_cast<int>(PerfStage::COUNT)];
+#endif
+};
+
+#if PLUGIN_H264_ENABLE_PERF_STATS
+
+// 作用域计时：构造时读取steady_clock，析构时把耗时记到stats上，stats为空时不计时
+class PerfScope {
+public:
+    PerfScope(PerfStats* stats, PerfStage stage) : stats_(stats), stage_(stage) {
+        if (stats_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PerfScope() {
+        if (stats_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            stats_->record(stage_, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    // 禁用拷贝构造和赋值
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfStats* stats_;
+    PerfStage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define PLUGIN_H264_PERF_CONCAT_IMPL( a, b ) a##b
+#define PLUGIN_H264_PERF_CONCAT( a, b ) PLUGIN_H264_PERF_CONCAT_IMPL( a, b )
+// 计时到所在作用域结束
+#define PLUGIN_H264_PERF_SCOPE( stats, stage ) \
+    ::plugin_h264::PerfScope PLUGIN_H264_PERF_CONCAT( perf_scope_, __LINE__ )( (stats), (stage) )
+
+#else
+
+#define PLUGIN_H264_PERF_SCOPE( stats, stage )
+
+#endif // PLUGIN_H264_ENABLE_PERF_STATS
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_PERF_STATS_H
@@ -0,0 +1,36 @@
+#ifndef PLUGIN_H264_SPS_PARSER_H
+#define PLUGIN_H264_SPS_PARSER_H
+
+#include "Common.h"
+
+namespace plugin_h264 {
+
+// H.264 序列参数集中播放需要的字段
+struct SPSInfo {
+    int profile_idc;
+    int level_idc;
+    int width;                    // 裁剪后的显示尺寸
+    int height;
+    int max_num_ref_frames;       // 解码器需要保留的参考帧数
+    bool timing_info_present;     // VUI timing_info
+    uint32_t num_units_in_tick;
+    uint32_t time_scale;
+    bool fixed_frame_rate;
+
+    SPSInfo() : profile_idc(0), level_idc(0), width(0), height(0), max_num_ref_frames(0),
+                timing_info_present(false),
+                num_units_in_tick(0), time_scale(0), fixed_frame_rate(false) {}
+
+    // VUI中的帧率（一帧两场，time_scale / (2 * num_units_in_tick)），没有timing_info时返回0
+    double getFrameRate() const;
+};
+
+// 解析 SPS NAL 单元（从NAL头开始，不含起始码，可以含防竞争字节）
+class SPSParser {
+public:
+    static bool parse(const uint8_t* nal, size_t size, SPSInfo& info);
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_SPS_PARSER_H
@@ -0,0 +1,53 @@
+#ifndef PLUGIN_H264_WORKER_POOL_H
+#define PLUGIN_H264_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace plugin_h264 {
+
+// 常驻工作线程池，用于把一帧的工作切分成若干块并行执行
+// 调用线程也参与执行，run() 在所有任务完成后才返回
+class WorkerPool {
+public:
+    // thread_count 为参与计算的总线程数（包含调用线程）
+    explicit WorkerPool(int thread_count);
+    ~WorkerPool();
+
+    // 禁用拷贝构造和赋值
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 参与计算的总线程数
+    int getThreadCount() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // 并行执行 task(0) ... task(task_count - 1)
+    void run(int task_count, const std::function<void(int)>& task);
+
+    // 推荐的默认线程数（0表示自动）
+    static int resolveThreadCount(int requested);
+
+private:
+    void workerLoop();
+    void drainTasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    const std::function<void(int)>* task_;
+    int task_count_;
+    std::atomic<int> next_task_;
+    int busy_workers_;
+    unsigned long generation_;
+    bool stopping_;
+};
+
+} // namespace plugin_h264
+
+#endif // PLUGIN_H264_WORKER_POOL_H
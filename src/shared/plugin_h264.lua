@@ -20,18 +20,101 @@ local lib = Library:new(
     }
 )
 
+-- YUV输出模式的颜色转换着色器：paint1为Y平面，paint2为上下拼接的U/V平面
+-- 系数与 ColorConverter 一致（BT.601 全范围）
+local yuvEffectDefined = false
+
+local function defineYUVEffect()
+    if yuvEffectDefined then return end
+    --
+    graphics.defineEffect(
+        {
+            category = 'composite',
+            name = 'h264yuv',
+            vertexData = {
+                { name = 'lumaScale', default = 1, min = 0, max = 1, index = 0 },
+                { name = 'chromaScale', default = 1, min = 0, max = 1, index = 1 },
+                -- 色度纹理每半高度中有效行的比例，U/V之间的保护行不参与采样
+                { name = 'chromaRowScale', default = 1, min = 0, max = 1, index = 2 }
+            },
+            fragment = [[
+                P_COLOR vec4 FragmentKernel( P_UV vec2 texCoord )
+                {
+                    P_UV vec2 lumaCoord = vec2( texCoord.x * CoronaVertexUserData.x, texCoord.y );
+                    P_UV vec2 chromaCoord = vec2( texCoord.x * CoronaVertexUserData.y, texCoord.y * 0.5 * CoronaVertexUserData.z );
+
+                    P_COLOR float y = texture2D( CoronaSampler0, lumaCoord ).r;
+                    P_COLOR float u = texture2D( CoronaSampler1, chromaCoord ).r - 0.5;
+                    P_COLOR float v = texture2D( CoronaSampler1, chromaCoord + vec2( 0.0, 1.0 - 0.5 * CoronaVertexUserData.z ) ).r - 0.5;
+
+                    P_COLOR vec3 rgb = vec3( y + 1.402 * v,
+                                             y - 0.344136 * u - 0.714136 * v,
+                                             y + 1.772 * u );
+
+                    return CoronaColorScale( vec4( clamp( rgb, 0.0, 1.0 ), 1.0 ) );
+                }
+            ]]
+        }
+    )
+    yuvEffectDefined = true
+end
+
 -- DIY
+-- yuvOutput 为 true 时返回 texture, chroma 两张单通道纹理，需配合 composite.custom.h264yuv 效果显示
 function lib.newMovieTexture(opts)
-    local path = system.pathForFile(opts.filename, opts.baseDir or system.ResourceDirectory)
+    -- data：内存中的影片数据（字符串），代替 filename，用于资源包中不落盘的视频
+    local path = opts.data == nil and system.pathForFile(opts.filename, opts.baseDir or system.ResourceDirectory) or nil
     local source = audio.getSourceFromChannel(opts.channel or audio.findFreeChannel())
-    return lib._newMovieTexture(path, source, display.fps)
+    local options = {
+        -- YUV->RGBA 并行转换线程数，nil/0 自动，1 禁用
+        conversionThreads = opts.conversionThreads,
+        -- OpenH264内部解码线程数，默认1
+        decodeThreads = opts.decodeThreads,
+        -- 后台线程异步解码，队列深度/高低水位/队列空时是否阻塞等待
+        asyncDecode = opts.asyncDecode,
+        decodeQueueDepth = opts.decodeQueueDepth,
+        decodeHighWatermark = opts.decodeHighWatermark,
+        decodeLowWatermark = opts.decodeLowWatermark,
+        decodeBlockingPop = opts.decodeBlockingPop,
+        decodePopTimeout = opts.decodePopTimeout,
+        -- 独立音频线程填充OpenAL缓冲区，默认开启，false 时在 update 中填充
+        audioThread = opts.audioThread,
+        -- 输出Y/UV单通道纹理，由着色器完成颜色转换
+        yuvOutput = opts.yuvOutput,
+        -- 主时钟：'audio'（默认，按实际播放出来的音频）、'video'（按系统时间）、'external'（texture:setClock）
+        syncMode = opts.syncMode,
+        -- 落后时的跳帧策略：'nonref'（默认，跳过非参考帧）、'idr'（跳到下一个IDR）、'none'
+        decodeSkip = opts.decodeSkip,
+        -- 边下载边播放：文件仍在写入，用 texture:setBytesAvailable(bytes, complete) 报告下载进度
+        streaming = opts.streaming,
+        bytesAvailable = opts.bytesAvailable,
+        -- 裸H.264码流（.h264/.264）的帧率，默认读取SPS中的timing_info，没有时为25
+        frameRate = opts.frameRate,
+        data = opts.data
+    }
+    return lib._newMovieTexture(path, source, display.fps, options)
 end
 
 -- Plug-n-play
 function lib.newMovieRect(opts)
-    local texture = lib.newMovieTexture(opts)
-    local rect = display.newImageRect(texture.filename, texture.baseDir, opts.width, opts.height)
-    rect.texture, rect.channel = texture, opts.channel
+    local texture, chroma = lib.newMovieTexture(opts)
+    local rect
+    if chroma then
+        defineYUVEffect()
+        rect = display.newRect(0, 0, opts.width, opts.height)
+        rect.fill = {
+            type = 'composite',
+            paint1 = { type = 'image', filename = texture.filename, baseDir = texture.baseDir },
+            paint2 = { type = 'image', filename = chroma.filename, baseDir = chroma.baseDir }
+        }
+        rect.fill.effect = 'composite.custom.h264yuv'
+        rect.fill.effect.lumaScale = texture.lumaScale
+        rect.fill.effect.chromaScale = texture.chromaScale
+        rect.fill.effect.chromaRowScale = texture.chromaRowScale
+    else
+        rect = display.newImageRect(texture.filename, texture.baseDir, opts.width, opts.height)
+    end
+    rect.texture, rect.chroma, rect.channel = texture, chroma, opts.channel
     --
     rect.x, rect.y = opts.x, opts.y
     rect._preserve = opts.preserve
@@ -50,7 +133,15 @@ function lib.newMovieRect(opts)
             end
             --
             rect.texture:update(rect._delta)
-            rect.texture:invalidate()
+            -- 只有产生了新帧才重新上传纹理
+            local generation = rect.texture.frameGeneration
+            if generation ~= rect._generation then
+                rect._generation = generation
+                rect.texture:invalidate()
+                if rect.chroma then
+                    rect.chroma:invalidate()
+                end
+            end
             --
             if not rect.texture.isActive then
                 rect._complete = true
@@ -113,6 +204,10 @@ function lib.newMovieRect(opts)
                     rect.texture:releaseSelf()
                     rect.texture = nil
                 end
+                if rect.chroma then
+                    rect.chroma:releaseSelf()
+                    rect.chroma = nil
+                end
                 --
                 rect:removeSelf()
             end
@@ -178,7 +273,8 @@ function lib.newMovieLoop(opts)
         listener = group.callback,
         preserve = true, channel = opts.channel1,
         width = opts.width, height = opts.height,
-        filename = opts.filename, baseDir = opts.baseDir
+        filename = opts.filename, baseDir = opts.baseDir,
+        yuvOutput = opts.yuvOutput
     }
     --
     group.options2 = copy(group.options1)
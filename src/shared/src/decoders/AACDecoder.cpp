@@ -34,8 +34,10 @@ bool AACDecoder::initialize() {
         return false;
     }
 
-    // 预分配输出缓冲区（立体声，16位，2048样本）
-    output_buffer_.resize(2048 * 2);
+    // INT_PCM为16位时直接解码到PCM缓冲区池，否则需要中间缓冲区再转换
+    if (sizeof(INT_PCM) != sizeof(int16_t)) {
+        output_buffer_.resize(kMaxOutputSamples);
+    }
 
     initialized_ = true;
     clearError();
@@ -125,9 +127,11 @@ bool AACDecoder::decode(const uint8_t* aac_data, size_t aac_size, AudioFrame& fr
         return false;
     }
 
-    // 解码帧
-    INT_PCM* output_ptr = output_buffer_.data();
-    err = aacDecoder_DecodeFrame(decoder_, output_ptr, output_buffer_.size(), 0);
+    // 解码帧：直接写入池中的缓冲区，稳定播放时既不分配也不逐样本复制
+    PCMBuffer pcm = pcm_pool_.acquire(kMaxOutputSamples);
+    INT_PCM* output_ptr = sizeof(INT_PCM) == sizeof(int16_t) ? reinterpret_cast<INT_PCM*>(pcm.data())
+                                                             : output_buffer_.data();
+    err = aacDecoder_DecodeFrame(decoder_, output_ptr, static_cast<INT>(kMaxOutputSamples), 0);
 
     if (err != AAC_DEC_OK) {
         if (err == AAC_DEC_NOT_ENOUGH_BITS) {
@@ -149,21 +153,22 @@ bool AACDecoder::decode(const uint8_t* aac_data, size_t aac_size, AudioFrame& fr
         return false;
     }
 
+    size_t total_samples = static_cast<size_t>(std::max(0, stream_info->frameSize)) *
+                           static_cast<size_t>(std::max(0, stream_info->numChannels));
+    pcm.setSize(total_samples);
+
+    // INT_PCM不是16位的构建（SAMPLE_BITS=32）才需要转换
+    if (output_ptr != reinterpret_cast<INT_PCM*>(pcm.data())) {
+        int16_t* samples = pcm.data();
+        for (size_t i = 0; i < pcm.size(); ++i) {
+            samples[i] = static_cast<int16_t>(output_ptr[i]);
+        }
+    }
+
     // 填充输出帧
     frame.sample_rate = stream_info->sampleRate;
     frame.channels = stream_info->numChannels;
-
-    // 复制PCM数据
-    int frame_size = stream_info->frameSize;
-    int total_samples = frame_size * stream_info->numChannels;
-
-    frame.samples.clear();
-    frame.samples.reserve(total_samples);
-
-    // FDK-AAC输出INT_PCM（通常是int16_t），转换为我们的格式
-    for (int i = 0; i < total_samples; ++i) {
-        frame.samples.push_back(static_cast<int16_t>(output_ptr[i]));
-    }
+    frame.samples = std::move(pcm);
 
     // 更新内部状态
     sample_rate_ = frame.sample_rate;
@@ -211,6 +216,7 @@ void AACDecoder::destroy() {
     }
 
     output_buffer_.clear();
+    pcm_pool_.clear();
     initialized_ = false;
     sample_rate_ = 0;
     channels_ = 0;
@@ -232,12 +238,8 @@ std::vector<LIB_INFO> AACDecoder::getLibraryInfo() const {
 }
 
 size_t AACDecoder::getMemoryUsage() const {
-    // 估计内存使用量
-    size_t base_usage = sizeof(*this);  // 对象本身
-    size_t buffer_usage = output_buffer_.capacity() * sizeof(INT_PCM);  // 输出缓冲区
-    size_t decoder_usage = initialized_ ? 512 * 1024 : 0;  // 解码器内部状态（估计512KB）
-
-    return base_usage + buffer_usage + decoder_usage;
+    // FDK-AAC不支持自定义分配器，内部状态不计入；只统计输出缓冲区和PCM缓冲池
+    return output_buffer_.capacity() * sizeof(INT_PCM) + pcm_pool_.getMemoryUsage();
 }
 
 } // namespace plugin_h264
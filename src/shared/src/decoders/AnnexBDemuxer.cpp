@@ -0,0 +1,378 @@
+#include "../include/decoders/AnnexBDemuxer.h"
+#include "../include/utils/NALConverter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace plugin_h264 {
+
+namespace {
+
+// 没有mmap时按块读取扫描
+const size_t kScanChunk = 1 << 20;
+// 起始码之后还要读NAL头和片头的第一个字节，块之间重叠这么多字节
+const size_t kScanLookahead = 5;
+// 参数集的长度上限，超过时视为损坏
+const int64_t kMaxParameterSetSize = 4096;
+
+const int kNALTypeIDR = 5;
+const int kNALTypeSPS = 7;
+const int kNALTypePPS = 8;
+
+// 出现在访问单元第一个片之前的NAL类型（7.4.1.2.3）：SEI、SPS、PPS、AUD、14~18
+bool precedesFirstSlice(int nal_type) {
+    return (nal_type >= 6 && nal_type <= 9) || (nal_type >= 14 && nal_type <= 18);
+}
+
+} // namespace
+
+const uint32_t AnnexBDemuxer::kTimescale;
+constexpr double AnnexBDemuxer::kDefaultFrameRate;
+
+AnnexBDemuxer::AnnexBDemuxer()
+    : is_open_(false)
+    , configured_frame_rate_(0.0)
+    , frame_rate_(0.0)
+    , duration_(0.0)
+    , index_(&index_memory_)
+    , next_sample_(0)
+    , pending_payload_(-1)
+    , pending_type_(0)
+    , has_sps_info_(false) {
+}
+
+AnnexBDemuxer::~AnnexBDemuxer() {
+    close();
+}
+
+bool AnnexBDemuxer::open(const std::string& file_path) {
+    std::unique_ptr<ByteSource> source = openFileSource(file_path);
+    if (!source) {
+        close();
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+        return false;
+    }
+
+    return open(std::move(source));
+}
+
+bool AnnexBDemuxer::open(std::unique_ptr<ByteSource> source) {
+    close();
+
+    if (!source) {
+        setError(H264Error::INVALID_PARAM, "Invalid byte source");
+        return false;
+    }
+
+    if (source->size() <= 0) {
+        setError(H264Error::UNSUPPORTED_FORMAT, "Invalid file size: " + std::to_string(source->size()));
+        return false;
+    }
+    source_ = std::move(source);
+
+    if (!buildIndex()) {
+        close();
+        return false;
+    }
+
+    if (index_.count() == 0) {
+        close();
+        setError(H264Error::UNSUPPORTED_FORMAT, "No H.264 access units found");
+        return false;
+    }
+
+    assignTimestamps();
+
+    PLUGIN_H264_LOG( ("Annex-B stream: %zu access units, %zu IDR, %.3f fps, %dx%d\n",
+           index_.count(), index_.sync_samples.size(), frame_rate_, sps_info_.width, sps_info_.height) );
+
+    is_open_ = true;
+    clearError();
+    return true;
+}
+
+void AnnexBDemuxer::close() {
+    source_.reset();
+    is_open_ = false;
+    frame_rate_ = 0.0;
+    duration_ = 0.0;
+    current_time_ = 0.0;
+    index_.clear();
+    next_sample_ = 0;
+    buffer_.clear();
+    pending_payload_ = -1;
+    pending_type_ = 0;
+    sps_.clear();
+    pps_.clear();
+    sps_info_ = SPSInfo();
+    has_sps_info_ = false;
+    clearError();
+}
+
+bool AnnexBDemuxer::buildIndex() {
+    int64_t total = source_->size();
+    AccessUnitBuilder unit;
+    std::vector<uint8_t> chunk;
+    uint8_t previous_byte = 0xFF;  // 上一块的最后一个字节，用于识别跨块的4字节起始码
+
+    for (int64_t base = 0; base < total; base += kScanChunk) {
+        size_t length = static_cast<size_t>(std::min<int64_t>(kScanChunk + kScanLookahead, total - base));
+        const uint8_t* data = source_->view(base, length);
+        if (!data) {
+            chunk.resize(length);
+            if (!source_->read(base, chunk.data(), length)) {
+                setError(H264Error::FILE_OPEN_FAILED, "Failed to read stream data");
+                return false;
+            }
+            data = chunk.data();
+        }
+
+        // 只处理在本块内开始的起始码，之后的字节可以落在重叠部分
+        size_t limit = std::min(length, kScanChunk + 2);
+        size_t pos = NALConverter::findStartCode(data, limit);
+        while (pos < limit) {
+            size_t header = pos + 3;
+            if (header >= length) {
+                break;  // 文件末尾残缺的起始码
+            }
+
+            bool zero_byte = pos > 0 ? data[pos - 1] == 0 : previous_byte == 0;
+            int64_t start = base + static_cast<int64_t>(pos) - (zero_byte ? 1 : 0);
+            int next_byte = header + 1 < length ? data[header + 1] : -1;
+            handleNAL(start, base + static_cast<int64_t>(header), data[header], next_byte, unit);
+
+            size_t from = header + 1;
+            pos = from < limit ? from + NALConverter::findStartCode(data + from, limit - from) : limit;
+        }
+
+        previous_byte = data[std::min(length, kScanChunk) - 1];
+    }
+
+    captureParameterSet(pending_payload_, total);
+    finishAccessUnit(total, unit);
+
+    // 没有IDR时只能从头解码
+    if (index_.sync_samples.empty() && index_.count() > 0) {
+        index_.sync_samples.push_back(0);
+    }
+    return true;
+}
+
+void AnnexBDemuxer::handleNAL(int64_t start, int64_t payload, uint8_t header, int next_byte,
+                              AccessUnitBuilder& unit) {
+    // 上一个NAL到这个起始码为止
+    captureParameterSet(pending_payload_, start);
+
+    int nal_type = header & 0x1F;
+    bool is_slice = nal_type >= 1 && nal_type <= 5;
+
+    // 已经有片时，参数集/SEI/AUD或first_mb_in_slice为0（ue(v)的第一位为1）的片开始新的访问单元
+    if (unit.has_slice) {
+        bool first_slice = (nal_type == 1 || nal_type == 2 || nal_type == kNALTypeIDR) &&
+                           next_byte >= 0 && (next_byte & 0x80) != 0;
+        if (precedesFirstSlice(nal_type) || first_slice) {
+            finishAccessUnit(start, unit);
+        }
+    }
+
+    if (unit.start < 0) {
+        unit.start = start;
+    }
+    if (is_slice) {
+        unit.has_slice = true;
+        unit.is_idr = unit.is_idr || nal_type == kNALTypeIDR;
+    }
+
+    pending_payload_ = payload;
+    pending_type_ = nal_type;
+}
+
+void AnnexBDemuxer::finishAccessUnit(int64_t end, AccessUnitBuilder& unit) {
+    // 码流末尾没有片的NAL（如结尾的SEI）丢弃
+    if (unit.has_slice && end > unit.start) {
+        if (unit.is_idr) {
+            index_.sync_samples.push_back(static_cast<uint32_t>(index_.count()));
+        }
+        index_.offsets.push_back(static_cast<uint64_t>(unit.start));
+        index_.sizes.push_back(static_cast<uint32_t>(end - unit.start));
+        // 时间戳在扫描完成后按帧率填写
+        index_.timestamps.push_back(0);
+    }
+    unit = AccessUnitBuilder();
+}
+
+void AnnexBDemuxer::captureParameterSet(int64_t payload, int64_t end) {
+    // 只保留第一个SPS/PPS，用于预配置解码器；码流中的参数集仍随访问单元送入解码器
+    bool is_sps = pending_type_ == kNALTypeSPS && sps_.empty();
+    bool is_pps = pending_type_ == kNALTypePPS && pps_.empty();
+    pending_type_ = 0;
+    if ((!is_sps && !is_pps) || payload < 0 || end <= payload || end - payload > kMaxParameterSetSize) {
+        return;
+    }
+
+    std::vector<uint8_t> nal(static_cast<size_t>(end - payload));
+    if (!source_->read(payload, nal.data(), nal.size())) {
+        return;
+    }
+    // 去掉下一个起始码之前的trailing_zero_8bits
+    while (!nal.empty() && nal.back() == 0) {
+        nal.pop_back();
+    }
+
+    if (is_sps) {
+        has_sps_info_ = SPSParser::parse(nal.data(), nal.size(), sps_info_);
+        sps_.swap(nal);
+    } else {
+        pps_.swap(nal);
+    }
+}
+
+void AnnexBDemuxer::assignTimestamps() {
+    // 指定的帧率优先，其次是SPS中的timing_info
+    frame_rate_ = configured_frame_rate_;
+    if (frame_rate_ <= 0.0 && has_sps_info_) {
+        double vui_rate = sps_info_.getFrameRate();
+        if (vui_rate > 0.0 && vui_rate <= 1000.0) {
+            frame_rate_ = vui_rate;
+        }
+    }
+    if (frame_rate_ <= 0.0) {
+        frame_rate_ = kDefaultFrameRate;
+    }
+
+    // 按帧序号取整而不是累加时长，29.97等非整数帧率不会累积误差
+    size_t count = index_.count();
+    double ticks_per_frame = kTimescale / frame_rate_;
+    index_.durations.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        index_.timestamps[i] = static_cast<uint64_t>(std::llround(i * ticks_per_frame));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t next = static_cast<uint64_t>(std::llround((i + 1) * ticks_per_frame));
+        index_.durations[i] = static_cast<uint32_t>(next - index_.timestamps[i]);
+    }
+
+    duration_ = count / frame_rate_;
+}
+
+bool AnnexBDemuxer::isValidTrack(int track_id) const {
+    return is_open_ && track_id == 0;
+}
+
+std::vector<TrackInfo> AnnexBDemuxer::getTrackInfo() const {
+    std::vector<TrackInfo> tracks;
+    if (!is_open_) {
+        return tracks;
+    }
+
+    TrackInfo info;
+    info.type = MP4TrackType::VIDEO;
+    info.codec = CodecType::H264;
+    info.track_id = 0;
+    info.duration = duration_;
+    info.width = static_cast<uint32_t>(sps_info_.width);
+    info.height = static_cast<uint32_t>(sps_info_.height);
+    info.timescale = kTimescale;
+    tracks.push_back(info);
+    return tracks;
+}
+
+bool AnnexBDemuxer::getCodecConfig(int track_id, CodecConfig& config) const {
+    if (!isValidTrack(track_id)) {
+        return false;
+    }
+
+    config = CodecConfig();
+    config.codec = CodecType::H264;
+    config.nal_length_size = 0;
+    if (!sps_.empty() && !pps_.empty()) {
+        config.parameter_sets.push_back(sps_);
+        config.parameter_sets.push_back(pps_);
+    }
+    return true;
+}
+
+bool AnnexBDemuxer::nextSample(int track_id, size_t& sample) {
+    if (!isValidTrack(track_id)) {
+        setError(H264Error::INVALID_PARAM, "Invalid track ID");
+        return false;
+    }
+    if (next_sample_ >= index_.count()) {
+        return false;
+    }
+    sample = next_sample_;
+    return true;
+}
+
+bool AnnexBDemuxer::readNextSample(int track_id, MP4SampleView& view) {
+    size_t sample;
+    if (!nextSample(track_id, sample)) {
+        return false;
+    }
+
+    uint32_t size = index_.sizes[sample];
+    const uint8_t* data = source_->view(index_.offsets[sample], size);
+    if (!data) {
+        if (buffer_.size() < size) {
+            buffer_.resize(size);
+        }
+        if (!source_->read(index_.offsets[sample], buffer_.data(), size)) {
+            setError(H264Error::FILE_OPEN_FAILED, "Failed to read sample data");
+            return false;
+        }
+        data = buffer_.data();
+    }
+
+    view.data = data;
+    view.size = size;
+    view.timestamp = index_.timestamps[sample];
+    view.duration = index_.durations[sample];
+    view.is_keyframe = index_.isSyncSample(sample);
+    current_time_ = static_cast<double>(view.timestamp) / kTimescale;
+    next_sample_++;
+    return true;
+}
+
+bool AnnexBDemuxer::readNextSampleInto(int track_id, std::vector<uint8_t>& buffer, MP4SampleView& view) {
+    size_t sample;
+    if (!nextSample(track_id, sample)) {
+        return false;
+    }
+
+    uint32_t size = index_.sizes[sample];
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    if (!source_->read(index_.offsets[sample], buffer.data(), size)) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to read sample data");
+        return false;
+    }
+
+    view.data = buffer.data();
+    view.size = size;
+    view.timestamp = index_.timestamps[sample];
+    view.duration = index_.durations[sample];
+    view.is_keyframe = index_.isSyncSample(sample);
+    current_time_ = static_cast<double>(view.timestamp) / kTimescale;
+    next_sample_++;
+    return true;
+}
+
+const SampleIndex* AnnexBDemuxer::getSampleIndex(int track_id) const {
+    return isValidTrack(track_id) ? &index_ : nullptr;
+}
+
+size_t AnnexBDemuxer::getNextSampleNumber(int track_id) const {
+    return isValidTrack(track_id) ? next_sample_ : 0;
+}
+
+bool AnnexBDemuxer::seekToSample(int track_id, size_t sample) {
+    if (!isValidTrack(track_id)) {
+        setError(H264Error::INVALID_PARAM, "Invalid track ID");
+        return false;
+    }
+
+    next_sample_ = std::min(sample, index_.count());
+    return true;
+}
+
+} // namespace plugin_h264
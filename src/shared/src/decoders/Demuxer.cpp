@@ -0,0 +1,101 @@
+#include "../include/decoders/Demuxer.h"
+#include <algorithm>
+
+namespace plugin_h264 {
+
+SampleIndex::SampleIndex(MemoryCounter* counter)
+    : offsets(TrackingAllocator<uint64_t>(counter))
+    , sizes(TrackingAllocator<uint32_t>(counter))
+    , timestamps(TrackingAllocator<uint64_t>(counter))
+    , durations(TrackingAllocator<uint32_t>(counter))
+    , sync_samples(TrackingAllocator<uint32_t>(counter)) {
+}
+
+size_t SampleIndex::findSample(uint64_t timestamp) const {
+    return std::lower_bound(timestamps.begin(), timestamps.end(), timestamp) - timestamps.begin();
+}
+
+bool SampleIndex::isSyncSample(size_t sample) const {
+    return sync_samples.empty() ||
+           std::binary_search(sync_samples.begin(), sync_samples.end(), static_cast<uint32_t>(sample));
+}
+
+size_t SampleIndex::findSyncSample(size_t sample) const {
+    if (sync_samples.empty()) {
+        return sample;
+    }
+
+    auto it = std::upper_bound(sync_samples.begin(), sync_samples.end(), static_cast<uint32_t>(sample));
+    return it == sync_samples.begin() ? 0 : *(it - 1);
+}
+
+void SampleIndex::clear() {
+    TrackedVector<uint64_t>(offsets.get_allocator()).swap(offsets);
+    TrackedVector<uint32_t>(sizes.get_allocator()).swap(sizes);
+    TrackedVector<uint64_t>(timestamps.get_allocator()).swap(timestamps);
+    TrackedVector<uint32_t>(durations.get_allocator()).swap(durations);
+    TrackedVector<uint32_t>(sync_samples.get_allocator()).swap(sync_samples);
+}
+
+size_t SampleIndex::getMemoryUsage() const {
+    return (offsets.capacity() + timestamps.capacity()) * sizeof(uint64_t) +
+           (sizes.capacity() + durations.capacity() + sync_samples.capacity()) * sizeof(uint32_t);
+}
+
+bool Demuxer::findTrack(MP4TrackType type, CodecType codec, TrackDescriptor& track) const {
+    std::vector<TrackInfo> tracks = getTrackInfo();
+    for (const auto& info : tracks) {
+        if (info.type != type || info.codec != codec) {
+            continue;
+        }
+
+        TrackDescriptor descriptor;
+        descriptor.info = info;
+        if (!getCodecConfig(info.track_id, descriptor.config)) {
+            return false;
+        }
+
+        // 没有timescale时视频按90kHz（H.264常用），音频按采样率
+        if (info.timescale > 0) {
+            descriptor.timescale = info.timescale;
+        } else if (type == MP4TrackType::AUDIO) {
+            descriptor.timescale = info.sample_rate > 0 ? info.sample_rate : 44100;
+        } else {
+            descriptor.timescale = 90000;
+        }
+
+        track = std::move(descriptor);
+        return true;
+    }
+    return false;
+}
+
+bool Demuxer::seekToTime(double timestamp) {
+    std::vector<TrackInfo> tracks = getTrackInfo();
+    if (tracks.empty()) {
+        setError(H264Error::DECODER_INIT_FAILED, "Demuxer not open");
+        return false;
+    }
+
+    timestamp = std::max(0.0, std::min(timestamp, getDuration()));
+
+    // 二分查找第一个不早于目标时间的样本，再退回到它之前最近的同步样本
+    for (size_t track_id = 0; track_id < tracks.size(); ++track_id) {
+        const SampleIndex* index = getSampleIndex(static_cast<int>(track_id));
+        size_t sample = 0;
+        if (index && tracks[track_id].timescale > 0) {
+            uint64_t target_timestamp = static_cast<uint64_t>(timestamp * tracks[track_id].timescale);
+            sample = index->findSyncSample(index->findSample(target_timestamp));
+        }
+        if (!seekToSample(static_cast<int>(track_id), sample)) {
+            return false;
+        }
+
+        PLUGIN_H264_LOG( ("Track %zu: Seeked to sync sample %zu (%.3fs)\n", track_id, sample, timestamp) );
+    }
+
+    current_time_ = timestamp;
+    return true;
+}
+
+} // namespace plugin_h264
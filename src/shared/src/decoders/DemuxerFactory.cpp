@@ -0,0 +1,131 @@
+#include "../include/decoders/DemuxerFactory.h"
+#include "../include/decoders/MP4Demuxer.h"
+#include "../include/decoders/AnnexBDemuxer.h"
+#include <algorithm>
+
+namespace plugin_h264 {
+
+namespace {
+
+// 可以出现在ISO BMFF文件开头的顶层box
+const char* const kLeadingBoxTypes[] = {
+    "ftyp", "styp", "moov", "moof", "mdat", "free", "skip", "wide", "pnot", "uuid"
+};
+
+bool isMP4(const uint8_t* data, size_t size) {
+    if (size < 8) {
+        return false;
+    }
+
+    // box大小：0表示到文件末尾，1表示64位大小，其余不能小于box头
+    uint32_t box_size = (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+                        (static_cast<uint32_t>(data[2]) << 8) | data[3];
+    if (box_size != 0 && box_size != 1 && box_size < 8) {
+        return false;
+    }
+
+    for (const char* type : kLeadingBoxTypes) {
+        if (std::equal(type, type + 4, reinterpret_cast<const char*>(data + 4))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isAnnexB(const uint8_t* data, size_t size) {
+    // 起始码 00 00 01 或 00 00 00 01（允许更多前导0），后面是合法的NAL头
+    size_t zeros = 0;
+    while (zeros < size && data[zeros] == 0x00) {
+        ++zeros;
+    }
+    if (zeros < 2 || zeros + 1 >= size || data[zeros] != 0x01) {
+        return false;
+    }
+
+    uint8_t header = data[zeros + 1];
+    return (header & 0x80) == 0 && (header & 0x1F) != 0;
+}
+
+} // namespace
+
+ContainerFormat DemuxerFactory::sniff(const uint8_t* data, size_t size) {
+    if (data == nullptr) {
+        return ContainerFormat::UNKNOWN;
+    }
+    // box类型判断更严格，先于起始码判断（box大小也可能以 00 00 01 开头）
+    if (isMP4(data, size)) {
+        return ContainerFormat::MP4;
+    }
+    if (isAnnexB(data, size)) {
+        return ContainerFormat::ANNEXB;
+    }
+    return ContainerFormat::UNKNOWN;
+}
+
+ContainerFormat DemuxerFactory::sniff(ByteSource& source) {
+    uint8_t header[kSniffSize];
+    size_t length = static_cast<size_t>(std::min<int64_t>(source.size(), kSniffSize));
+    if (length == 0 || !source.read(0, header, length)) {
+        return ContainerFormat::UNKNOWN;
+    }
+    return sniff(header, length);
+}
+
+const char* DemuxerFactory::getFormatName(ContainerFormat format) {
+    switch (format) {
+        case ContainerFormat::MP4: return "MP4";
+        case ContainerFormat::ANNEXB: return "H.264 stream";
+        default: return "unknown";
+    }
+}
+
+std::unique_ptr<Demuxer> DemuxerFactory::open(const std::string& file_path, const DemuxerOptions& options,
+                                              std::string& error) {
+    std::unique_ptr<ByteSource> source = openFileSource(file_path, options.allow_mmap);
+    if (!source) {
+        error = "Failed to open file: " + file_path;
+        return nullptr;
+    }
+    return open(std::move(source), options, error);
+}
+
+std::unique_ptr<Demuxer> DemuxerFactory::open(std::unique_ptr<ByteSource> source, const DemuxerOptions& options,
+                                              std::string& error) {
+    if (!source) {
+        error = "Invalid byte source";
+        return nullptr;
+    }
+
+    ContainerFormat format = sniff(*source);
+    switch (format) {
+        case ContainerFormat::MP4: {
+            auto demuxer = std::make_unique<MP4Demuxer>();
+            if (!demuxer->open(std::move(source))) {
+                error = "Failed to open MP4 file: " + demuxer->getLastMessage();
+                return nullptr;
+            }
+            return demuxer;
+        }
+        case ContainerFormat::ANNEXB: {
+            // 裸码流open时扫描整个文件建立索引，不支持边下载边播放
+            if (!source->isComplete()) {
+                error = "H.264 streams can only be played once fully loaded";
+                return nullptr;
+            }
+            auto demuxer = std::make_unique<AnnexBDemuxer>();
+            demuxer->setFrameRate(options.frame_rate);
+            if (!demuxer->open(std::move(source))) {
+                error = "Failed to open H.264 stream: " + demuxer->getLastMessage();
+                return nullptr;
+            }
+            return demuxer;
+        }
+        default:
+            error = source->size() < static_cast<int64_t>(kSniffSize)
+                  ? "Not enough data to detect the container format"
+                  : "Unrecognized container format";
+            return nullptr;
+    }
+}
+
+} // namespace plugin_h264
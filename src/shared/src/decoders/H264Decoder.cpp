@@ -1,6 +1,9 @@
 #include "../include/decoders/H264Decoder.h"
+#include "../include/utils/NALConverter.h"
 #include <cstring>
+#include <cmath>
 #include <algorithm>
+#include <new>
 
 namespace plugin_h264 {
 
@@ -9,20 +12,30 @@ H264Decoder::H264Decoder()
     , initialized_(false)
     , frame_width_(0)
     , frame_height_(0)
-    , frame_buffer_size_(0)
-    , require_compact_format_(false)  // 默认使用零拷贝模式
-    , buffer_pool_(3) {  // 使用3个缓冲区的池
+    , reference_frames_(0)
+    , require_compact_format_(true)  // 默认输出池化帧，离开解码器后仍然有效
+    , buffer_pool_(FrameBufferPool::shared())
+    , skip_policy_(DecodeSkipPolicy::NON_REFERENCE)
+    , late_(false)
+    , waiting_for_idr_(false)
+    , skipped_non_reference_(0)
+    , skipped_until_idr_(0) {
 }
 
 H264Decoder::~H264Decoder() {
     destroy();
 }
 
-bool H264Decoder::initialize() {
+bool H264Decoder::initialize(const H264DecoderConfig& config) {
     if (initialized_) {
         return true;
     }
 
+    config_ = config;
+    config_.thread_count = std::max(0, config_.thread_count);
+    skip_policy_ = config_.skip_policy;
+    waiting_for_idr_ = false;
+
     // 基于验证结果：使用WelsCreateDecoder创建解码器
     long result = WelsCreateDecoder(&decoder_);
     if (result != 0 || decoder_ == nullptr) {
@@ -43,16 +56,27 @@ bool H264Decoder::initialize() {
 }
 
 bool H264Decoder::setupDecoderOptions() {
+    // 线程数必须在Initialize之前设置才会生效
+    int ret;
+    if (config_.thread_count > 1) {
+        int thread_count = config_.thread_count;
+        ret = decoder_->SetOption(DECODER_OPTION_NUM_OF_THREADS, &thread_count);
+        if (ret != 0) {
+            PLUGIN_H264_LOG( ("Failed to enable %d decode threads, using single thread\n", thread_count) );
+            config_.thread_count = 1;
+        }
+    }
+
     // 基于验证结果：使用DECODER_OPTION_ERROR_CON_IDC而不是DECODER_OPTION_DATAFORMAT
     SDecodingParam sDecParam;
     memset(&sDecParam, 0, sizeof(SDecodingParam));
 
-    sDecParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_AVC;
+    sDecParam.sVideoProperty.eVideoBsType = config_.bitstream_type;
     sDecParam.uiTargetDqLayer = UCHAR_MAX;  // 解码所有层
-    sDecParam.eEcActiveIdc = ERROR_CON_SLICE_COPY;  // 错误隐藏
+    sDecParam.eEcActiveIdc = config_.error_concealment;  // 错误隐藏
     sDecParam.sVideoProperty.size = sizeof(sDecParam.sVideoProperty);
 
-    int ret = decoder_->Initialize(&sDecParam);
+    ret = decoder_->Initialize(&sDecParam);
     if (ret != 0) {
         setError(H264Error::DECODER_INIT_FAILED,
                 "Failed to initialize decoder parameters, error: " + std::to_string(ret));
@@ -60,7 +84,7 @@ bool H264Decoder::setupDecoderOptions() {
     }
 
     // 设置错误隐藏选项（基于验证通过的API）
-    unsigned int uiEcIdc = ERROR_CON_SLICE_COPY;
+    unsigned int uiEcIdc = config_.error_concealment;
     ret = decoder_->SetOption(DECODER_OPTION_ERROR_CON_IDC, &uiEcIdc);
     if (ret != 0) {
         // 这不是致命错误，只是记录警告
@@ -70,7 +94,7 @@ bool H264Decoder::setupDecoderOptions() {
     return true;
 }
 
-bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& frame) {
+bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& frame, double timestamp) {
     if (!initialized_ || decoder_ == nullptr) {
         setError(H264Error::DECODER_INIT_FAILED, "Decoder not initialized");
         return false;
@@ -81,10 +105,19 @@ bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& f
         return false;
     }
 
+    // 落后时按策略丢弃，省下整个片的解码
+    if (shouldSkip(nal_data, nal_size)) {
+        clearError();
+        return false;
+    }
+
     uint8_t* pData[3] = {0};
     SBufferInfo sDstBufInfo;
     memset(&sDstBufInfo, 0, sizeof(SBufferInfo));
 
+    // 时间戳以微秒随码流传入，重排序后从输出帧带回
+    sDstBufInfo.uiInBsTimeStamp = timestamp > 0.0 ? static_cast<unsigned long long>(llround(timestamp * 1000000.0)) : 0;
+
     // 调用 OpenH264 解码
     DECODING_STATE ret = decoder_->DecodeFrame2(
         nal_data,
@@ -110,6 +143,116 @@ bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& f
         return false;
     }
 
+    return outputFrame(pData, sDstBufInfo, frame);
+}
+
+bool H264Decoder::shouldSkip(const uint8_t* nal_data, size_t nal_size) {
+    DecodeSkipPolicy policy = skip_policy_;
+    if (policy == DecodeSkipPolicy::NONE && !waiting_for_idr_) {
+        return false;
+    }
+
+    // SPS/PPS/SEI 总是送入解码器
+    SliceInfo info = NALConverter::inspectAnnexB(nal_data, nal_size);
+    if (!info.has_slice) {
+        return false;
+    }
+
+    // IDR 之后的参考链完整，恢复正常解码
+    if (info.is_idr) {
+        waiting_for_idr_ = false;
+        return false;
+    }
+
+    // 参考帧已丢弃，即使不再落后也要等到IDR
+    if (waiting_for_idr_) {
+        ++skipped_until_idr_;
+        return true;
+    }
+
+    if (!late_) {
+        return false;
+    }
+
+    if (policy == DecodeSkipPolicy::UNTIL_IDR) {
+        waiting_for_idr_ = true;
+        ++skipped_until_idr_;
+        return true;
+    }
+
+    if (policy == DecodeSkipPolicy::NON_REFERENCE && !info.is_reference) {
+        ++skipped_non_reference_;
+        return true;
+    }
+
+    return false;
+}
+
+void H264Decoder::setSkipPolicy(DecodeSkipPolicy policy) {
+    skip_policy_ = policy;
+    config_.skip_policy = policy;
+}
+
+DecodeSkipStats H264Decoder::getSkipStats() const {
+    DecodeSkipStats stats;
+    stats.non_reference = skipped_non_reference_;
+    stats.until_idr = skipped_until_idr_;
+    return stats;
+}
+
+void H264Decoder::resetSkipStats() {
+    skipped_non_reference_ = 0;
+    skipped_until_idr_ = 0;
+}
+
+bool H264Decoder::parseSkipPolicy(const char* name, DecodeSkipPolicy& policy) {
+    if (name == nullptr) {
+        return false;
+    }
+
+    if (strcmp(name, "none") == 0) {
+        policy = DecodeSkipPolicy::NONE;
+    } else if (strcmp(name, "nonref") == 0) {
+        policy = DecodeSkipPolicy::NON_REFERENCE;
+    } else if (strcmp(name, "idr") == 0) {
+        policy = DecodeSkipPolicy::UNTIL_IDR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* H264Decoder::getSkipPolicyName(DecodeSkipPolicy policy) {
+    switch (policy) {
+        case DecodeSkipPolicy::NONE:
+            return "none";
+        case DecodeSkipPolicy::NON_REFERENCE:
+            return "nonref";
+        case DecodeSkipPolicy::UNTIL_IDR:
+            return "idr";
+    }
+    return "none";
+}
+
+bool H264Decoder::flush(VideoFrame& frame) {
+    if (!initialized_ || decoder_ == nullptr) {
+        return false;
+    }
+
+    uint8_t* pData[3] = {0};
+    SBufferInfo sDstBufInfo;
+    memset(&sDstBufInfo, 0, sizeof(SBufferInfo));
+
+    // 多线程/重排序模式下解码器内部还缓存着若干帧
+    decoder_->FlushFrame(pData, &sDstBufInfo);
+    if (sDstBufInfo.iBufferStatus != 1) {
+        return false;
+    }
+
+    return outputFrame(pData, sDstBufInfo, frame);
+}
+
+bool H264Decoder::outputFrame(uint8_t* pData[3], const SBufferInfo& sDstBufInfo, VideoFrame& frame) {
     // 读取帧参数
     int width = sDstBufInfo.UsrData.sSystemBuffer.iWidth;
     int height = sDstBufInfo.UsrData.sSystemBuffer.iHeight;
@@ -124,8 +267,7 @@ bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& f
     frame_width_ = width;
     frame_height_ = height;
 
-    // ✅ 直接引用解码器输出（零拷贝模式）
-    // 如果调用方能接受 stride ≠ width，就直接用
+    // 先直接引用解码器输出（零拷贝模式），下一次解码后失效
     frame.width = width;
     frame.height = height;
     frame.y_stride = stride_y;
@@ -134,76 +276,27 @@ bool H264Decoder::decode(const uint8_t* nal_data, size_t nal_size, VideoFrame& f
     frame.u_plane = pData[1];
     frame.v_plane = pData[2];
     frame.zero_copy_mode = true;
+    frame.buffer.reset();
 
-    // 如果调用方 **必须要紧凑格式**，再做一次 memcpy
+    // 默认复制到池化缓冲区，帧可以跨解码保留或交给其他线程
     if (require_compact_format_) {
-        if (!allocateFrameBuffer(width, height)) {
-            return false;
-        }
-
-        // Y plane
-        for (int i = 0; i < height; i++) {
-            memcpy(frame_buffer_.get() + i * width,
-                   pData[0] + i * stride_y,
-                   width);
-        }
-
-        // U/V planes
-        int uv_width = width / 2;
-        int uv_height = height / 2;
-        for (int i = 0; i < uv_height; i++) {
-            memcpy(frame_buffer_.get() + width * height + i * uv_width,
-                   pData[1] + i * stride_uv,
-                   uv_width);
-            memcpy(frame_buffer_.get() + width * height + uv_width * uv_height + i * uv_width,
-                   pData[2] + i * stride_uv,
-                   uv_width);
-        }
-
-        // 更新 frame 指针为紧凑格式
-        frame.y_plane = frame_buffer_.get();
-        frame.u_plane = frame_buffer_.get() + width * height;
-        frame.v_plane = frame.u_plane + uv_width * uv_height;
-        frame.y_stride = width;
-        frame.uv_stride = uv_width;
-        frame.zero_copy_mode = false;
-    }
-
-    clearError();
-    return true;
-}
-
-bool H264Decoder::allocateFrameBuffer(int width, int height) {
-    // 计算YUV420帧大小
-    size_t y_size = width * height;
-    size_t uv_size = (width / 2) * (height / 2);
-    size_t total_size = y_size + uv_size * 2;
-
-    if (frame_buffer_size_ < total_size) {
-        // 释放旧缓冲区到池中
-        if (frame_buffer_) {
-            buffer_pool_.release(std::move(frame_buffer_), frame_buffer_size_);
-        }
-        
+        FrameBuffer buffer;
         try {
-            // 从池中获取新缓冲区
-            frame_buffer_ = buffer_pool_.acquire(total_size);
-            frame_buffer_size_ = total_size;
+            buffer = buffer_pool_.acquire(width, height);
         } catch (const std::bad_alloc&) {
             setError(H264Error::OUT_OF_MEMORY,
-                    "Failed to allocate frame buffer of size: " + std::to_string(total_size));
+                    "Failed to allocate frame buffer for " + std::to_string(width) + "x" + std::to_string(height));
             return false;
         }
+
+        buffer.copyFrom(pData[0], pData[1], pData[2], stride_y, stride_uv);
+        frame.setBuffer(std::move(buffer));
     }
 
-    return true;
-}
+    frame.timestamp = static_cast<double>(sDstBufInfo.uiOutYuvTimeStamp) / 1000000.0;
 
-void H264Decoder::freeFrameBuffer() {
-    if (frame_buffer_) {
-        buffer_pool_.release(std::move(frame_buffer_), frame_buffer_size_);
-    }
-    frame_buffer_size_ = 0;
+    clearError();
+    return true;
 }
 
 bool H264Decoder::getDecoderInfo(int& width, int& height) const {
@@ -220,8 +313,9 @@ void H264Decoder::reset() {
     if (initialized_ && decoder_ != nullptr) {
         // 重置解码器状态（如果API支持）
         // OpenH264可能需要重新初始化
+        H264DecoderConfig config = config_;
         destroy();
-        initialize();
+        initialize(config);
     }
 }
 
@@ -231,21 +325,31 @@ void H264Decoder::destroy() {
         decoder_ = nullptr;
     }
 
-    freeFrameBuffer();
-    buffer_pool_.clear();  // 清空缓冲池
     initialized_ = false;
     frame_width_ = 0;
     frame_height_ = 0;
     clearError();
 }
 
-size_t H264Decoder::getMemoryUsage() const {
-    // 估计内存使用量
-    size_t base_usage = sizeof(*this);  // 对象本身
-    size_t buffer_usage = frame_buffer_size_;  // 帧缓冲区
-    size_t decoder_usage = initialized_ ? 1024 * 1024 : 0;  // 解码器内部状态（估计1MB）
+size_t H264Decoder::getDPBMemoryUsage() const {
+    if (!initialized_ || frame_width_ <= 0 || frame_height_ <= 0) {
+        return 0;
+    }
 
-    return base_usage + buffer_usage + decoder_usage;
+    // 宏块对齐后四周各扩展32（色度16）像素，供运动补偿越界访问
+    const size_t luma_width = static_cast<size_t>((frame_width_ + 15) & ~15) + 64;
+    const size_t luma_height = static_cast<size_t>((frame_height_ + 15) & ~15) + 64;
+    const size_t picture_size = luma_width * luma_height + 2 * (luma_width / 2) * (luma_height / 2);
+
+    size_t pictures = static_cast<size_t>(std::max(reference_frames_, 1)) + 2;
+    if (config_.thread_count > 1) {
+        pictures += static_cast<size_t>(config_.thread_count);
+    }
+    return pictures * picture_size;
+}
+
+size_t H264Decoder::getMemoryUsage() const {
+    return sizeof(*this) + getDPBMemoryUsage();
 }
 
 } // namespace plugin_h264
@@ -1,13 +1,136 @@
 #include "../include/decoders/MP4Demuxer.h"
+#include "../include/utils/NALConverter.h"
 #include <cstring>
 #include <algorithm>
 
 namespace plugin_h264 {
 
+namespace {
+
+const uint32_t kBoxMoov = 0x6D6F6F76;  // 'moov'
+const uint32_t kBoxTrak = 0x7472616B;  // 'trak'
+const uint32_t kBoxMdia = 0x6D646961;  // 'mdia'
+const uint32_t kBoxMinf = 0x6D696E66;  // 'minf'
+const uint32_t kBoxStbl = 0x7374626C;  // 'stbl'
+const uint32_t kBoxStss = 0x73747373;  // 'stss'
+const uint32_t kBoxTkhd = 0x746B6864;  // 'tkhd'
+const uint32_t kBoxMvex = 0x6D766578;  // 'mvex'
+const uint32_t kBoxTrex = 0x74726578;  // 'trex'
+const uint32_t kBoxMoof = 0x6D6F6F66;  // 'moof'
+const uint32_t kBoxTraf = 0x74726166;  // 'traf'
+const uint32_t kBoxTfhd = 0x74666864;  // 'tfhd'
+const uint32_t kBoxTfdt = 0x74666474;  // 'tfdt'
+const uint32_t kBoxTrun = 0x7472756E;  // 'trun'
+
+// tfhd/trun 标志位
+const uint32_t kTfhdBaseDataOffset = 0x000001;
+const uint32_t kTfhdSampleDescriptionIndex = 0x000002;
+const uint32_t kTfhdDefaultDuration = 0x000008;
+const uint32_t kTfhdDefaultSize = 0x000010;
+const uint32_t kTfhdDefaultFlags = 0x000020;
+const uint32_t kTrunDataOffset = 0x000001;
+const uint32_t kTrunFirstSampleFlags = 0x000004;
+const uint32_t kTrunSampleDuration = 0x000100;
+const uint32_t kTrunSampleSize = 0x000200;
+const uint32_t kTrunSampleFlags = 0x000400;
+const uint32_t kTrunCompositionOffset = 0x000800;
+const uint32_t kSampleIsNonSync = 0x00010000;
+
+uint32_t readBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint64_t readBE64(const uint8_t* p) {
+    return (static_cast<uint64_t>(readBE32(p)) << 32) | readBE32(p + 4);
+}
+
+// 内存中 [cursor, end) 的下一个子盒子，cursor前移到盒子末尾
+bool nextChildBox(const uint8_t*& cursor, const uint8_t* end, uint32_t& type,
+                  const uint8_t*& payload, const uint8_t*& box_end) {
+    if (end - cursor < 8) {
+        return false;
+    }
+
+    uint64_t size = readBE32(cursor);
+    type = readBE32(cursor + 4);
+    size_t header_size = 8;
+    if (size == 1) {
+        if (end - cursor < 16) {
+            return false;
+        }
+        size = readBE64(cursor + 8);
+        header_size = 16;
+    } else if (size == 0) {
+        size = static_cast<uint64_t>(end - cursor);
+    }
+
+    if (size < header_size || size > static_cast<uint64_t>(end - cursor)) {
+        return false;
+    }
+
+    payload = cursor + header_size;
+    box_end = cursor + size;
+    cursor = box_end;
+    return true;
+}
+
+// 读取 [offset, end) 处的盒子头，payload为内容起点，next为下一个盒子起点
+bool readBoxHeader(ByteSource& source, int64_t offset, int64_t end,
+                   uint32_t& type, int64_t& payload, int64_t& next) {
+    uint8_t header[16];
+    if (end - offset < 8 || !source.read(offset, header, 8)) {
+        return false;
+    }
+
+    uint64_t size = readBE32(header);
+    type = readBE32(header + 4);
+    int64_t header_size = 8;
+    if (size == 1) {
+        // 64位largesize
+        if (end - offset < 16 || !source.read(offset + 8, header + 8, 8)) {
+            return false;
+        }
+        size = (static_cast<uint64_t>(readBE32(header + 8)) << 32) | readBE32(header + 12);
+        header_size = 16;
+    } else if (size == 0) {
+        // 延伸到父盒子末尾
+        size = static_cast<uint64_t>(end - offset);
+    }
+
+    if (size < static_cast<uint64_t>(header_size) || size > static_cast<uint64_t>(end - offset)) {
+        return false;
+    }
+
+    payload = offset + header_size;
+    next = offset + static_cast<int64_t>(size);
+    return true;
+}
+
+// 在 [begin, end) 中查找第一个指定类型的盒子
+bool findBox(ByteSource& source, int64_t begin, int64_t end, uint32_t box_type,
+             int64_t& payload, int64_t& box_end) {
+    int64_t offset = begin;
+    uint32_t type;
+    int64_t next;
+    while (readBoxHeader(source, offset, end, type, payload, next)) {
+        if (type == box_type) {
+            box_end = next;
+            return true;
+        }
+        offset = next;
+    }
+    return false;
+}
+
+} // namespace
+
 MP4Demuxer::MP4Demuxer()
-    : is_open_(false)
+    : mmap_enabled_(true)
+    , is_open_(false)
     , duration_(0.0)
-    , current_time_(0.0) {
+    , fragmented_(false)
+    , fragment_offset_(0) {
     memset(&demuxer_, 0, sizeof(demuxer_));
 }
 
@@ -16,32 +139,51 @@ MP4Demuxer::~MP4Demuxer() {
 }
 
 bool MP4Demuxer::open(const std::string& file_path) {
+    // 打开文件（mmap优先，ifstream回退）
+    std::unique_ptr<ByteSource> source = openFileSource(file_path, mmap_enabled_);
+    if (!source) {
+        if (is_open_) {
+            close();
+        }
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+        return false;
+    }
+
+    return open(std::move(source));
+}
+
+bool MP4Demuxer::open(std::unique_ptr<ByteSource> source) {
     if (is_open_) {
         close();
     }
 
-    // 打开文件
-    file_.open(file_path, std::ios::binary);
-    if (!file_.is_open()) {
-        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+    if (!source) {
+        setError(H264Error::INVALID_PARAM, "Invalid byte source");
         return false;
     }
 
-    // 获取文件大小 - 先定位到文件末尾
-    file_.seekg(0, std::ios::end);
-    int64_t file_size = file_.tellg();
+    int64_t file_size = source->size();
     if (file_size <= 0) {
         setError(H264Error::UNSUPPORTED_FORMAT, "Invalid file size: " + std::to_string(file_size));
-        file_.close();
+        return false;
+    }
+    source_ = std::move(source);
+
+    // MiniMP4只解析到moov为止，之后的分片自行解析；增长中的字节源必须已经包含完整的moov
+    int64_t moov_begin = 0, moov_end = 0;
+    bool has_moov = findBox(*source_, 0, file_size, kBoxMoov, moov_begin, moov_end);
+    if (!has_moov && !source_->isComplete()) {
+        setError(H264Error::UNSUPPORTED_FORMAT, "moov not available yet, " + std::to_string(file_size) + " bytes loaded");
+        source_.reset();
         return false;
     }
 
     // 初始化MP4解复用器
-    int result = MP4D_open(&demuxer_, readCallback, this, file_size);
+    int result = MP4D_open(&demuxer_, readCallback, this, has_moov ? moov_end : file_size);
     if (result != 1) {
         setError(H264Error::UNSUPPORTED_FORMAT,
                 "Failed to open MP4 demuxer, error: " + std::to_string(result));
-        file_.close();
+        source_.reset();
         return false;
     }
 
@@ -57,8 +199,17 @@ bool MP4Demuxer::open(const std::string& file_path) {
         return false;
     }
 
-    // 初始化每个轨道的sample索引
+    // 建立样本表，初始化每个轨道的sample索引
+    buildSampleIndex();
     track_sample_indices_.resize(demuxer_.track_count, 0);
+    track_buffers_.resize(demuxer_.track_count);
+
+    // 分片MP4：解析已经到达的 moof/mdat
+    if (has_moov) {
+        parseFragmentTracks(moov_begin, moov_end);
+        fragment_offset_ = moov_end;
+        parseFragments();
+    }
 
     is_open_ = true;
     current_time_ = 0.0;
@@ -72,12 +223,15 @@ void MP4Demuxer::close() {
         is_open_ = false;
     }
 
-    if (file_.is_open()) {
-        file_.close();
-    }
+    source_.reset();
 
     tracks_.clear();
     track_sample_indices_.clear();
+    sample_indices_.clear();
+    track_buffers_.clear();
+    fragmented_ = false;
+    fragment_offset_ = 0;
+    fragment_tracks_.clear();
     duration_ = 0.0;
     current_time_ = 0.0;
     clearError();
@@ -145,6 +299,435 @@ bool MP4Demuxer::extractTrackInfo() {
     return true;
 }
 
+void MP4Demuxer::buildSampleIndex() {
+    sample_indices_.clear();
+    sample_indices_.assign(demuxer_.track_count, SampleIndex(&index_memory_));
+
+    for (unsigned int track_id = 0; track_id < demuxer_.track_count; ++track_id) {
+        const MP4D_track_t* track = &demuxer_.track[track_id];
+        SampleIndex& index = sample_indices_[track_id];
+        index.offsets.reserve(track->sample_count);
+        index.sizes.reserve(track->sample_count);
+        index.timestamps.reserve(track->sample_count);
+        index.durations.reserve(track->sample_count);
+
+        for (unsigned int i = 0; i < track->sample_count; ++i) {
+            unsigned int frame_bytes = 0, timestamp = 0, duration = 0;
+            MP4D_file_offset_t offset = MP4D_frame_offset(&demuxer_, track_id, i, &frame_bytes, &timestamp, &duration);
+            if (frame_bytes == 0) {
+                break;
+            }
+
+            index.offsets.push_back(offset);
+            index.sizes.push_back(frame_bytes);
+            index.timestamps.push_back(timestamp);
+            index.durations.push_back(duration);
+        }
+    }
+
+    parseSyncSampleTables();
+
+    for (size_t track_id = 0; track_id < sample_indices_.size(); ++track_id) {
+        PLUGIN_H264_LOG( ("Track %zu: indexed %zu samples, %zu sync samples (%zu bytes)\n",
+               track_id, sample_indices_[track_id].count(), sample_indices_[track_id].sync_samples.size(),
+               sample_indices_[track_id].getMemoryUsage()) );
+    }
+}
+
+void MP4Demuxer::parseSyncSampleTables() {
+    // MiniMP4不解析stss，按 moov/trak 顺序（与MiniMP4的轨道顺序一致）自行读取
+    int64_t moov_begin, moov_end;
+    if (!findBox(*source_, 0, source_->size(), kBoxMoov, moov_begin, moov_end)) {
+        return;
+    }
+
+    size_t track_id = 0;
+    int64_t offset = moov_begin;
+    uint32_t type;
+    int64_t payload, next;
+    while (track_id < sample_indices_.size() &&
+           readBoxHeader(*source_, offset, moov_end, type, payload, next)) {
+        if (type == kBoxTrak) {
+            if (!parseTrackSyncSamples(payload, next, sample_indices_[track_id])) {
+                // 表格损坏时按全部为同步样本处理，seek仍然可用
+                sample_indices_[track_id].sync_samples.clear();
+            }
+            track_id++;
+        }
+        offset = next;
+    }
+}
+
+bool MP4Demuxer::parseTrackSyncSamples(int64_t trak_begin, int64_t trak_end, SampleIndex& index) {
+    int64_t mdia_begin, mdia_end, minf_begin, minf_end, stbl_begin, stbl_end, stss_begin, stss_end;
+    if (!findBox(*source_, trak_begin, trak_end, kBoxMdia, mdia_begin, mdia_end) ||
+        !findBox(*source_, mdia_begin, mdia_end, kBoxMinf, minf_begin, minf_end) ||
+        !findBox(*source_, minf_begin, minf_end, kBoxStbl, stbl_begin, stbl_end) ||
+        !findBox(*source_, stbl_begin, stbl_end, kBoxStss, stss_begin, stss_end)) {
+        // 没有stss表示每个样本都是同步样本
+        return true;
+    }
+
+    // version(1) + flags(3) + entry_count(4) + sample_number(4) * entry_count
+    uint8_t header[8];
+    if (stss_end - stss_begin < 8 || !source_->read(stss_begin, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t entry_count = readBE32(header + 4);
+    if (entry_count == 0 || static_cast<uint64_t>(entry_count) * 4 > static_cast<uint64_t>(stss_end - stss_begin - 8)) {
+        return false;
+    }
+
+    std::vector<uint8_t> entries(static_cast<size_t>(entry_count) * 4);
+    if (!source_->read(stss_begin + 8, entries.data(), entries.size())) {
+        return false;
+    }
+
+    index.sync_samples.reserve(entry_count);
+    for (uint32_t i = 0; i < entry_count; ++i) {
+        uint32_t sample_number = readBE32(&entries[i * 4]);
+        if (sample_number > index.count()) {
+            break;
+        }
+        // sample_number从1开始，必须严格递增
+        if (sample_number == 0 ||
+            (!index.sync_samples.empty() && sample_number - 1 <= index.sync_samples.back())) {
+            return false;
+        }
+        index.sync_samples.push_back(sample_number - 1);
+    }
+
+    return true;
+}
+
+void MP4Demuxer::parseFragmentTracks(int64_t moov_begin, int64_t moov_end) {
+    fragment_tracks_.assign(sample_indices_.size(), FragmentTrack());
+
+    // trak 顺序与MiniMP4的轨道顺序一致，分片用tkhd中的track_ID引用轨道
+    size_t track = 0;
+    int64_t mvex_begin = -1, mvex_end = 0;
+    int64_t offset = moov_begin;
+    uint32_t type;
+    int64_t payload, next;
+    while (readBoxHeader(*source_, offset, moov_end, type, payload, next)) {
+        if (type == kBoxTrak && track < fragment_tracks_.size()) {
+            // version 0 的创建/修改时间各4字节，version 1 各8字节
+            int64_t tkhd_begin, tkhd_end;
+            uint8_t tkhd[24];
+            if (findBox(*source_, payload, next, kBoxTkhd, tkhd_begin, tkhd_end) &&
+                tkhd_end - tkhd_begin >= static_cast<int64_t>(sizeof(tkhd)) &&
+                source_->read(tkhd_begin, tkhd, sizeof(tkhd))) {
+                fragment_tracks_[track].track_id = readBE32(tkhd + (tkhd[0] == 1 ? 20 : 12));
+            }
+            track++;
+        } else if (type == kBoxMvex) {
+            mvex_begin = payload;
+            mvex_end = next;
+        }
+        offset = next;
+    }
+
+    fragmented_ = mvex_begin >= 0;
+
+    // moov中的样本之后继续
+    for (size_t i = 0; i < fragment_tracks_.size(); ++i) {
+        const SampleIndex& index = sample_indices_[i];
+        if (index.count() > 0) {
+            fragment_tracks_[i].next_decode_time = index.timestamps.back() + index.durations.back();
+        }
+        fragment_tracks_[i].sync_listed = !index.sync_samples.empty();
+    }
+
+    // trex: version/flags, track_ID, sample_description_index, duration, size, flags
+    offset = mvex_begin;
+    while (fragmented_ && readBoxHeader(*source_, offset, mvex_end, type, payload, next)) {
+        uint8_t trex[24];
+        if (type == kBoxTrex && next - payload >= static_cast<int64_t>(sizeof(trex)) &&
+            source_->read(payload, trex, sizeof(trex))) {
+            for (auto& fragment_track : fragment_tracks_) {
+                if (fragment_track.track_id == readBE32(trex + 4)) {
+                    fragment_track.default_duration = readBE32(trex + 12);
+                    fragment_track.default_size = readBE32(trex + 16);
+                    fragment_track.default_flags = readBE32(trex + 20);
+                }
+            }
+        }
+        offset = next;
+    }
+}
+
+void MP4Demuxer::parseFragments() {
+    if (!fragmented_) {
+        return;
+    }
+
+    int64_t available = source_->size();
+    uint32_t type;
+    int64_t payload, next;
+    while (readBoxHeader(*source_, fragment_offset_, available, type, payload, next)) {
+        // 样本数据还没有全部到达时停在这个moof，下次刷新再解析
+        if (type == kBoxMoof && !parseMovieFragment(fragment_offset_, payload, next)) {
+            break;
+        }
+        fragment_offset_ = next;
+    }
+}
+
+bool MP4Demuxer::parseMovieFragment(int64_t moof_begin, int64_t moof_payload, int64_t moof_end) {
+    std::vector<uint8_t> moof(static_cast<size_t>(moof_end - moof_payload));
+    if (!source_->read(moof_payload, moof.data(), moof.size())) {
+        return false;
+    }
+
+    std::vector<uint64_t> decode_times(fragment_tracks_.size());
+    for (size_t i = 0; i < fragment_tracks_.size(); ++i) {
+        decode_times[i] = fragment_tracks_[i].next_decode_time;
+    }
+
+    std::vector<FragmentSample> samples;
+    const uint8_t* cursor = moof.data();
+    const uint8_t* end = cursor + moof.size();
+    uint32_t type;
+    const uint8_t* payload;
+    const uint8_t* box_end;
+    while (nextChildBox(cursor, end, type, payload, box_end)) {
+        if (type == kBoxTraf && !parseTrackFragment(payload, box_end, moof_begin, decode_times, samples)) {
+            // 损坏的分片整个跳过
+            PLUGIN_H264_LOG( ("Malformed movie fragment at %lld skipped\n", (long long)moof_begin) );
+            return true;
+        }
+    }
+
+    int64_t available = source_->size();
+    for (const auto& sample : samples) {
+        if (sample.offset < 0 || sample.offset + sample.size > available) {
+            return false;
+        }
+    }
+
+    appendFragmentSamples(samples);
+    for (size_t i = 0; i < fragment_tracks_.size(); ++i) {
+        fragment_tracks_[i].next_decode_time = decode_times[i];
+    }
+    return true;
+}
+
+bool MP4Demuxer::parseTrackFragment(const uint8_t* begin, const uint8_t* end, int64_t moof_begin,
+                                    std::vector<uint64_t>& decode_times,
+                                    std::vector<FragmentSample>& samples) const {
+    size_t track = fragment_tracks_.size();
+    uint32_t default_duration = 0, default_size = 0, default_flags = 0;
+    int64_t base_offset = moof_begin;   // 没有base_data_offset时相对moof起点
+    int64_t data_offset = moof_begin;
+
+    const uint8_t* cursor = begin;
+    uint32_t type;
+    const uint8_t* payload;
+    const uint8_t* box_end;
+    while (nextChildBox(cursor, end, type, payload, box_end)) {
+        if (type == kBoxTfhd) {
+            if (box_end - payload < 8) {
+                return false;
+            }
+            uint32_t flags = readBE32(payload) & 0xFFFFFF;
+            uint32_t track_id = readBE32(payload + 4);
+            for (track = 0; track < fragment_tracks_.size(); ++track) {
+                if (fragment_tracks_[track].track_id == track_id) {
+                    break;
+                }
+            }
+            if (track == fragment_tracks_.size()) {
+                return false;
+            }
+
+            default_duration = fragment_tracks_[track].default_duration;
+            default_size = fragment_tracks_[track].default_size;
+            default_flags = fragment_tracks_[track].default_flags;
+
+            const uint8_t* p = payload + 8;
+            size_t needed = ((flags & kTfhdBaseDataOffset) ? 8 : 0) + ((flags & kTfhdSampleDescriptionIndex) ? 4 : 0) +
+                            ((flags & kTfhdDefaultDuration) ? 4 : 0) + ((flags & kTfhdDefaultSize) ? 4 : 0) +
+                            ((flags & kTfhdDefaultFlags) ? 4 : 0);
+            if (static_cast<size_t>(box_end - p) < needed) {
+                return false;
+            }
+            if (flags & kTfhdBaseDataOffset) {
+                base_offset = static_cast<int64_t>(readBE64(p));
+                p += 8;
+            }
+            data_offset = base_offset;
+            if (flags & kTfhdSampleDescriptionIndex) {
+                p += 4;
+            }
+            if (flags & kTfhdDefaultDuration) {
+                default_duration = readBE32(p);
+                p += 4;
+            }
+            if (flags & kTfhdDefaultSize) {
+                default_size = readBE32(p);
+                p += 4;
+            }
+            if (flags & kTfhdDefaultFlags) {
+                default_flags = readBE32(p);
+            }
+        } else if (type == kBoxTfdt) {
+            // version 1 为64位baseMediaDecodeTime
+            size_t needed = (box_end - payload >= 1 && payload[0] == 1) ? 12 : 8;
+            if (track == fragment_tracks_.size() || static_cast<size_t>(box_end - payload) < needed) {
+                return false;
+            }
+            decode_times[track] = needed == 12 ? readBE64(payload + 4) : readBE32(payload + 4);
+        } else if (type == kBoxTrun) {
+            if (track == fragment_tracks_.size() || box_end - payload < 8) {
+                return false;
+            }
+            uint32_t flags = readBE32(payload) & 0xFFFFFF;
+            uint32_t sample_count = readBE32(payload + 4);
+            const uint8_t* p = payload + 8;
+
+            // data_offset相对base_data_offset，没有时紧接上一个trun的数据
+            if (flags & kTrunDataOffset) {
+                if (box_end - p < 4) {
+                    return false;
+                }
+                data_offset = base_offset + static_cast<int32_t>(readBE32(p));
+                p += 4;
+            }
+
+            bool has_first_flags = (flags & kTrunFirstSampleFlags) != 0;
+            uint32_t first_flags = default_flags;
+            if (has_first_flags) {
+                if (box_end - p < 4) {
+                    return false;
+                }
+                first_flags = readBE32(p);
+                p += 4;
+            }
+
+            size_t entry_size = ((flags & kTrunSampleDuration) ? 4 : 0) + ((flags & kTrunSampleSize) ? 4 : 0) +
+                                ((flags & kTrunSampleFlags) ? 4 : 0) + ((flags & kTrunCompositionOffset) ? 4 : 0);
+            if (static_cast<uint64_t>(sample_count) * entry_size > static_cast<uint64_t>(box_end - p)) {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < sample_count; ++i) {
+                FragmentSample sample;
+                sample.track = track;
+                sample.offset = data_offset;
+                sample.timestamp = decode_times[track];
+                sample.duration = default_duration;
+                sample.size = default_size;
+                uint32_t sample_flags = (i == 0 && has_first_flags) ? first_flags : default_flags;
+
+                if (flags & kTrunSampleDuration) {
+                    sample.duration = readBE32(p);
+                    p += 4;
+                }
+                if (flags & kTrunSampleSize) {
+                    sample.size = readBE32(p);
+                    p += 4;
+                }
+                if (flags & kTrunSampleFlags) {
+                    sample_flags = readBE32(p);
+                    p += 4;
+                }
+                if (flags & kTrunCompositionOffset) {
+                    p += 4;  // MiniMP4同样不处理ctts，只使用解码时间戳
+                }
+
+                sample.is_sync = (sample_flags & kSampleIsNonSync) == 0;
+                samples.push_back(sample);
+
+                data_offset += sample.size;
+                decode_times[track] += sample.duration;
+            }
+        }
+    }
+
+    return true;
+}
+
+void MP4Demuxer::appendFragmentSamples(const std::vector<FragmentSample>& samples) {
+    for (const auto& sample : samples) {
+        SampleIndex& index = sample_indices_[sample.track];
+        FragmentTrack& fragment_track = fragment_tracks_[sample.track];
+
+        // 空的同步样本表表示全部是同步样本，出现第一个非同步样本时补齐之前的样本
+        if (!sample.is_sync && !fragment_track.sync_listed) {
+            for (size_t i = 0; i < index.count(); ++i) {
+                index.sync_samples.push_back(static_cast<uint32_t>(i));
+            }
+            fragment_track.sync_listed = true;
+        } else if (sample.is_sync && fragment_track.sync_listed) {
+            index.sync_samples.push_back(static_cast<uint32_t>(index.count()));
+        }
+
+        index.offsets.push_back(static_cast<MP4D_file_offset_t>(sample.offset));
+        index.sizes.push_back(sample.size);
+        index.timestamps.push_back(sample.timestamp);
+        index.durations.push_back(sample.duration);
+    }
+
+    // 时长随分片增长
+    for (size_t track_id = 0; track_id < sample_indices_.size(); ++track_id) {
+        const SampleIndex& index = sample_indices_[track_id];
+        unsigned int timescale = demuxer_.track[track_id].timescale;
+        if (index.count() == 0 || timescale == 0) {
+            continue;
+        }
+
+        double track_duration = (static_cast<double>(index.timestamps.back()) + index.durations.back()) / timescale;
+        if (track_id < tracks_.size() && track_duration > tracks_[track_id].duration) {
+            tracks_[track_id].duration = track_duration;
+        }
+        if (track_duration > duration_) {
+            duration_ = track_duration;
+        }
+    }
+}
+
+bool MP4Demuxer::refresh() {
+    if (!is_open_ || !source_ || !source_->refresh()) {
+        return false;
+    }
+
+    size_t samples_before = 0;
+    for (const auto& index : sample_indices_) {
+        samples_before += index.count();
+    }
+
+    parseFragments();
+
+    size_t samples_after = 0;
+    for (const auto& index : sample_indices_) {
+        samples_after += index.count();
+    }
+    return samples_after > samples_before;
+}
+
+bool MP4Demuxer::isWaitingForData() const {
+    return is_open_ && source_ && !source_->isComplete();
+}
+
+bool MP4Demuxer::isSampleAvailable(const SampleIndex& index, size_t sample) const {
+    return sample < index.count() &&
+           static_cast<int64_t>(index.offsets[sample] + index.sizes[sample]) <= source_->size();
+}
+
+const SampleIndex* MP4Demuxer::getSampleIndex(int track_id) const {
+    if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(sample_indices_.size())) {
+        return nullptr;
+    }
+    return &sample_indices_[track_id];
+}
+
+size_t MP4Demuxer::getNextSampleNumber(int track_id) const {
+    if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(track_sample_indices_.size())) {
+        return 0;
+    }
+    return track_sample_indices_[track_id];
+}
+
 TrackInfo MP4Demuxer::createTrackInfo(const MP4D_track_t& track) {
     TrackInfo info;
 
@@ -253,41 +836,158 @@ bool MP4Demuxer::extractPPS(int track_id, std::vector<uint8_t>& pps_data) const
     return true;
 }
 
-bool MP4Demuxer::readNextSample(int track_id, MP4Sample& sample) {
+int MP4Demuxer::getNALLengthSize(int track_id) const {
+    if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(demuxer_.track_count)) {
+        return 4;
+    }
+
+    // avcC盒内容保存在dsi中
+    const MP4D_track_t* track = &demuxer_.track[track_id];
+    int length_size = NALConverter::parseLengthSize(track->dsi, track->dsi_bytes);
+    return length_size > 0 ? length_size : 4;
+}
+
+bool MP4Demuxer::getCodecConfig(int track_id, CodecConfig& config) const {
+    if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(demuxer_.track_count)) {
+        return false;
+    }
+
+    const MP4D_track_t* track = &demuxer_.track[track_id];
+    config = CodecConfig();
+    config.codec = tracks_[track_id].codec;
+    if (track->dsi && track->dsi_bytes > 0) {
+        config.dsi.assign(track->dsi, track->dsi + track->dsi_bytes);
+    }
+
+    if (config.codec == CodecType::H264) {
+        std::vector<uint8_t> parameter_set;
+        if (extractSPS(track_id, parameter_set)) {
+            config.parameter_sets.push_back(parameter_set);
+        }
+        if (extractPPS(track_id, parameter_set)) {
+            config.parameter_sets.push_back(parameter_set);
+        }
+        config.nal_length_size = getNALLengthSize(track_id);
+    }
+    return true;
+}
+
+bool MP4Demuxer::isZeroCopy() const {
+    // 探测字节源是否支持视图
+    return source_ && source_->view(0, 0) != nullptr;
+}
+
+bool MP4Demuxer::nextSampleLocation(int track_id, MP4D_file_offset_t& offset, unsigned int& frame_bytes,
+                                    uint64_t& timestamp, unsigned int& duration) {
     if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(demuxer_.track_count)) {
         setError(H264Error::INVALID_PARAM, "Invalid track ID");
         return false;
     }
 
     // 使用该轨道的专用sample索引
-    unsigned int& sample_index = track_sample_indices_[track_id];
-
-    unsigned int frame_bytes = 0;
-    unsigned int timestamp = 0;
-    unsigned int duration = 0;
+    unsigned int sample_index = track_sample_indices_[track_id];
 
-    // 获取样本信息
-    MP4D_file_offset_t offset = MP4D_frame_offset(&demuxer_, track_id, sample_index, &frame_bytes, &timestamp, &duration);
+    // 边下载边播放：已知样本读完或样本数据还没写入时先刷新字节源
+    const SampleIndex& index = sample_indices_[track_id];
+    if (!isSampleAvailable(index, sample_index)) {
+        refresh();
+    }
 
-    if (frame_bytes == 0) {
-        // 该轨道文件结束或错误
+    if (sample_index >= index.count()) {
+        // 该轨道文件结束
         PLUGIN_H264_LOG( ("Track %d: End of track reached at sample %u\n", track_id, sample_index) );
         return false;
     }
 
-    // 读取样本数据（需要从文件中读取）
-    file_.seekg(offset, std::ios::beg);
-    if (!file_.good()) {
-        setError(H264Error::FILE_OPEN_FAILED, "Failed to seek to sample position");
+    if (!isSampleAvailable(index, sample_index)) {
+        PLUGIN_H264_LOG( ("Track %d: waiting for sample %u data\n", track_id, sample_index) );
+        return false;
+    }
+
+    offset = index.offsets[sample_index];
+    frame_bytes = index.sizes[sample_index];
+    timestamp = index.timestamps[sample_index];
+    duration = index.durations[sample_index];
+    return true;
+}
+
+bool MP4Demuxer::readNextSample(int track_id, MP4SampleView& view) {
+    MP4D_file_offset_t offset;
+    unsigned int frame_bytes, duration;
+    uint64_t timestamp;
+    if (!nextSampleLocation(track_id, offset, frame_bytes, timestamp, duration)) {
         return false;
     }
 
-    // 分配和读取数据
+    // 映射文件直接返回指针，否则读入该轨道复用的缓冲区
+    const uint8_t* data = source_->view(offset, frame_bytes);
+    if (!data) {
+        std::vector<uint8_t>& buffer = track_buffers_[track_id];
+        if (buffer.size() < frame_bytes) {
+            buffer.resize(frame_bytes);
+        }
+        if (!source_->read(offset, buffer.data(), frame_bytes)) {
+            setError(H264Error::FILE_OPEN_FAILED, "Failed to read sample data");
+            return false;
+        }
+        data = buffer.data();
+    }
+
+    finishSample(track_id, data, frame_bytes, timestamp, duration, view);
+    return true;
+}
+
+bool MP4Demuxer::readNextSampleInto(int track_id, std::vector<uint8_t>& buffer, MP4SampleView& view) {
+    MP4D_file_offset_t offset;
+    unsigned int frame_bytes, duration;
+    uint64_t timestamp;
+    if (!nextSampleLocation(track_id, offset, frame_bytes, timestamp, duration)) {
+        return false;
+    }
+
+    if (buffer.size() < frame_bytes) {
+        buffer.resize(frame_bytes);
+    }
+    if (!source_->read(offset, buffer.data(), frame_bytes)) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to read sample data");
+        return false;
+    }
+
+    finishSample(track_id, buffer.data(), frame_bytes, timestamp, duration, view);
+    return true;
+}
+
+void MP4Demuxer::finishSample(int track_id, const uint8_t* data, unsigned int frame_bytes,
+                              uint64_t timestamp, unsigned int duration, MP4SampleView& view) {
+    view.data = data;
+    view.size = frame_bytes;
+    view.timestamp = timestamp;
+    view.duration = duration;
+    view.is_keyframe = sample_indices_[track_id].isSyncSample(track_sample_indices_[track_id]);
+
+    const MP4D_track_t* track = &demuxer_.track[track_id];
+    if (track->timescale > 0) {
+        current_time_ = static_cast<double>(timestamp) / track->timescale;
+    }
+
+    track_sample_indices_[track_id]++;  // 移动到该轨道的下一个样本
+}
+
+bool MP4Demuxer::readNextSample(int track_id, MP4Sample& sample) {
+    MP4D_file_offset_t offset;
+    unsigned int frame_bytes, duration;
+    uint64_t timestamp;
+    if (!nextSampleLocation(track_id, offset, frame_bytes, timestamp, duration)) {
+        return false;
+    }
+
+    unsigned int& sample_index = track_sample_indices_[track_id];
+
+    // 分配和读取数据（mmap后端为一次memcpy）
     sample.data.clear();
     sample.data.resize(frame_bytes);
 
-    file_.read(reinterpret_cast<char*>(sample.data.data()), frame_bytes);
-    if (file_.gcount() != static_cast<std::streamsize>(frame_bytes)) {
+    if (!source_->read(offset, sample.data.data(), frame_bytes)) {
         setError(H264Error::FILE_OPEN_FAILED, "Failed to read sample data");
         return false;
     }
@@ -295,7 +995,7 @@ bool MP4Demuxer::readNextSample(int track_id, MP4Sample& sample) {
     // 设置样本信息
     sample.timestamp = timestamp;
     sample.duration = duration;
-    sample.is_keyframe = false;  // MiniMP4可能没有直接的关键帧标志
+    sample.is_keyframe = sample_indices_[track_id].isSyncSample(sample_index);
 
     // 更新当前时间（基于当前轨道）
     const MP4D_track_t* track = &demuxer_.track[track_id];
@@ -311,62 +1011,14 @@ bool MP4Demuxer::readNextSample(int track_id, MP4Sample& sample) {
     return true;
 }
 
-bool MP4Demuxer::seekToTime(double timestamp) {
-    if (!is_open_) {
-        setError(H264Error::DECODER_INIT_FAILED, "Demuxer not open");
+bool MP4Demuxer::seekToSample(int track_id, size_t sample) {
+    if (!is_open_ || track_id < 0 || track_id >= static_cast<int>(track_sample_indices_.size())) {
+        setError(H264Error::INVALID_PARAM, "Invalid track ID");
         return false;
     }
 
-    // MiniMP4可能不支持精确的时间定位
-    // 这里提供基础实现
-
-    if (timestamp < 0.0) {
-        timestamp = 0.0;
-    } else if (timestamp > duration_) {
-        timestamp = duration_;
-    }
-
-    // 重置所有轨道的sample索引
-    for (size_t i = 0; i < track_sample_indices_.size(); ++i) {
-        track_sample_indices_[i] = 0;
-    }
-
-    // 简单的重置到开头（MiniMP4限制）
-    if (timestamp == 0.0) {
-        current_time_ = 0.0;
-        PLUGIN_H264_LOG( ("Seeked to beginning, reset all track indices\n") );
-        return true;
-    }
-
-    // 对于非零时间戳，需要为每个轨道计算正确的sample索引
-    for (unsigned int track_id = 0; track_id < demuxer_.track_count; ++track_id) {
-        const MP4D_track_t* track = &demuxer_.track[track_id];
-        if (track->timescale > 0) {
-            // 计算对应的sample索引（简化实现）
-            uint64_t target_timestamp = static_cast<uint64_t>(timestamp * track->timescale);
-
-            // 遍历样本找到最接近的索引
-            unsigned int sample_index = 0;
-            unsigned int frame_bytes, sample_timestamp, duration;
-
-            while (sample_index < track->sample_count) {
-                MP4D_file_offset_t offset = MP4D_frame_offset(&demuxer_, track_id, sample_index,
-                                                             &frame_bytes, &sample_timestamp, &duration);
-                if (frame_bytes == 0) break;
-
-                if (sample_timestamp >= target_timestamp) {
-                    break;
-                }
-                sample_index++;
-            }
-
-            track_sample_indices_[track_id] = sample_index;
-            PLUGIN_H264_LOG( ("Track %d: Seeked to sample %u (timestamp %u, target %.3fs)\n",
-                   track_id, sample_index, sample_timestamp, timestamp) );
-        }
-    }
-
-    current_time_ = timestamp;
+    // 允许定位到末尾；分片MP4中之后到达的样本仍可继续读取
+    track_sample_indices_[track_id] = static_cast<unsigned int>(std::min(sample, sample_indices_[track_id].count()));
     return true;
 }
 
@@ -374,25 +1026,29 @@ double MP4Demuxer::getDuration() const {
     return duration_;
 }
 
-double MP4Demuxer::getCurrentTime() const {
-    return current_time_;
-}
-
 // 静态回调函数（基于验证结果）
 int MP4Demuxer::readCallback(int64_t offset, void* buffer, size_t size, void* token) {
     MP4Demuxer* demuxer = static_cast<MP4Demuxer*>(token);
-    if (demuxer == nullptr || !demuxer->file_.is_open()) {
+    if (demuxer == nullptr || !demuxer->source_) {
         return 1;
     }
 
-    // 定位到指定偏移
-    demuxer->file_.seekg(offset, std::ios::beg);
-    if (!demuxer->file_.good()) {
+    int64_t remaining = demuxer->source_->size() - offset;
+    if (offset < 0 || remaining <= 0) {
         return 1;
     }
 
-    // 读取数据
-    demuxer->file_.read(static_cast<char*>(buffer), size);
+    // 与原ifstream实现一致：读到文件末尾时只返回剩余部分，其余补零
+    size_t length = size;
+    if (static_cast<uint64_t>(remaining) < size) {
+        length = static_cast<size_t>(remaining);
+    }
+    if (!demuxer->source_->read(offset, buffer, length)) {
+        return 1;
+    }
+    if (length < size) {
+        memset(static_cast<uint8_t*>(buffer) + length, 0, size - length);
+    }
 
     return 0;
 }
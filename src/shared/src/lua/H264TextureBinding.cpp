@@ -8,7 +8,13 @@
 
 #include "lua/H264TextureBinding.h"
 #include "managers/H264Movie.h"
+#include "managers/AudioStreamer.h"
+#include "managers/MediaClock.h"
 #include "utils/Common.h"
+#include "utils/ColorConverter.h"
+#include "utils/MemoryTracker.h"
+#include "utils/PerfStats.h"
+#include "utils/WorkerPool.h"
 
 #include <memory>
 #include <cstring>
@@ -23,6 +29,34 @@ using namespace plugin_h264;
 // Number of audio buffers for streaming
 #define NUM_BUFFERS 8
 
+struct H264MovieTexture;
+
+// update 中填充缓冲区时的音频时钟源（只在主线程访问）
+struct QueuedAudioClock : public AudioClockSource {
+    ALuint source = 0;
+    AudioPlaybackPosition position;
+
+    bool getAudibleTime(double& seconds) const override {
+        return position.getTime(source, seconds);
+    }
+};
+
+// YUV输出模式：Y平面和上下拼接的U/V平面作为两张单通道纹理上传，颜色转换在着色器中完成
+struct YUVPlaneTextures {
+    H264MovieTexture *movie = nullptr;   // 影片纹理释放后置空，色度纹理可能比它晚释放
+    MemoryCounter memory;                // luma和chroma的缓冲区
+    TrackedVector<uint8_t> luma{TrackingAllocator<uint8_t>(&memory)};
+    TrackedVector<uint8_t> chroma{TrackingAllocator<uint8_t>(&memory)};
+    uint64_t luma_generation = 0;        // 平面缓存对应的帧代数
+    uint64_t chroma_generation = 0;
+};
+
+// 边下载边播放的进度，Lua 在主线程更新，解复用器在解码线程读取
+struct StreamProgress {
+    std::atomic<int64_t> bytes_available{-1};   // 负数表示以磁盘上的文件大小为准
+    std::atomic<bool> complete{false};
+};
+
 // H264MovieTexture wrapper for Solar2D texture integration
 struct H264MovieTexture {
     std::unique_ptr<plugin_h264::H264Movie> decoder;
@@ -30,7 +64,21 @@ struct H264MovieTexture {
     plugin_h264::AudioFrame current_audio_frame;
 
     // Converted RGBA frame data for Corona texture
-    std::vector<uint8_t> rgba_data;
+    MemoryCounter rgba_memory;
+    TrackedVector<uint8_t> rgba_data{TrackingAllocator<uint8_t>(&rgba_memory)};
+
+    // 帧代数：每次更换 current_video_frame 加1，代数未变时 GetImage 直接返回缓存
+    uint64_t frame_generation = 0;
+    uint64_t converted_generation = 0;
+    uint64_t conversions = 0;            // 实际执行的转换（或YUV平面打包）次数
+    uint64_t skipped_conversions = 0;    // 命中缓存跳过的次数
+
+    // YUV输出模式（yuvOutput选项），为空时使用RGBA输出
+    std::shared_ptr<YUVPlaneTextures> yuv_planes;
+
+    // 并行颜色转换（线程数来自 newMovieTexture 选项，1 表示禁用）
+    int conversion_threads = 1;
+    std::unique_ptr<plugin_h264::WorkerPool> conversion_pool;
 
     // Playback state - 与plugin_movie字段名完全一致
     bool playing = false;
@@ -54,12 +102,49 @@ struct H264MovieTexture {
     ALenum audioformat = 0;
     ALuint buffers[NUM_BUFFERS];
 
+    // 独立音频线程（默认开启），关闭时回退到在 update 中填充缓冲区
+    bool audio_thread = true;
+    std::unique_ptr<plugin_h264::AudioStreamer> audio_streamer;
+
+    // 主时钟：视频按它呈现，音频来源为 audio_streamer 或 queued_audio_clock
+    plugin_h264::MediaClock clock;
+    QueuedAudioClock queued_audio_clock;
+
+    // streaming 选项：文件仍在下载，为空时按普通文件打开
+    std::shared_ptr<StreamProgress> stream_progress;
+
+    // data 选项：在注册表中引用住Lua字符串，解复用器直接读取它的内存，纹理释放时解除引用
+    lua_State *data_state = nullptr;     // 主线程，创建纹理的协程可能先结束
+    int data_ref = LUA_NOREF;
+
     // Default empty pixel data
     unsigned char empty[4] = {0, 0, 0, 0}; // Transparent black RGBA
 };
 
+// 更换当前视频帧并推进帧代数
+static void setCurrentVideoFrame(H264MovieTexture *movie, const plugin_h264::VideoFrame& frame) {
+    movie->current_video_frame = frame;
+    movie->frame_generation++;
+}
+
+// 缓存代数与当前帧一致时不需要重新转换
+// 每帧只统计一次：YUV输出模式下只有Y平面（主纹理）计数，色度纹理传count_stats=false
+static bool isFrameCached(H264MovieTexture *movie, uint64_t& cached_generation, bool count_stats = true) {
+    if (cached_generation == movie->frame_generation) {
+        if (count_stats) {
+            movie->skipped_conversions++;
+        }
+        return true;
+    }
+    cached_generation = movie->frame_generation;
+    if (count_stats) {
+        movie->conversions++;
+    }
+    return false;
+}
+
 // YUV to RGBA conversion function
-void convertYUVtoRGBA(const plugin_h264::VideoFrame& yuv, std::vector<uint8_t>& rgba) {
+void convertYUVtoRGBA(const plugin_h264::VideoFrame& yuv, TrackedVector<uint8_t>& rgba, WorkerPool* pool) {
     if (!yuv.isValid()) {
         PLUGIN_H264_LOG( ("Invalid VideoFrame: y_plane=%p, u_plane=%p, v_plane=%p, size=%dx%d\n",
                yuv.y_plane, yuv.u_plane, yuv.v_plane, yuv.width, yuv.height) );
@@ -73,48 +158,96 @@ void convertYUVtoRGBA(const plugin_h264::VideoFrame& yuv, std::vector<uint8_t>&
 
     rgba.resize(width * height * 4);
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            // Y平面索引
-            int y_index = y * yuv.y_stride + x;
-
-            // UV平面索引 - YUV420格式中UV是2x2采样
-            int uv_y = y / 2;
-            int uv_x = x / 2;
-            int uv_index = uv_y * yuv.uv_stride + uv_x;
-
-            // 边界检查
-            if (y_index < 0 || uv_index < 0) continue;
-
-            // 获取YUV值
-            int Y = yuv.y_plane[y_index];
-            int U = yuv.u_plane[uv_index] - 128;
-            int V = yuv.v_plane[uv_index] - 128;
-
-            // BT.601标准YUV到RGB转换（更精确的系数）
-            int R = Y + (1.402f * V);
-            int G = Y - (0.344136f * U) - (0.714136f * V);
-            int B = Y + (1.772f * U);
-
-            // 限制到0-255范围
-            R = std::max(0, std::min(255, R));
-            G = std::max(0, std::min(255, G));
-            B = std::max(0, std::min(255, B));
-
-            // RGBA输出索引
-            int rgba_index = (y * width + x) * 4;
-
-            // 根据Solar2D的期望格式设置RGBA（可能需要BGRA顺序）
-            rgba[rgba_index + 0] = static_cast<uint8_t>(R);  // Red
-            rgba[rgba_index + 1] = static_cast<uint8_t>(G);  // Green
-            rgba[rgba_index + 2] = static_cast<uint8_t>(B);  // Blue
-            rgba[rgba_index + 3] = 255;                      // Alpha
-        }
-    }
+    // SIMD定点转换（按CPU能力自动选择实现），大帧按条带并行
+    ColorConverter::convertYUV420ToRGBA(yuv, rgba.data(), width * 4, pool);
 
     PLUGIN_H264_LOG( ("YUV to RGBA conversion completed for %dx%d frame\n", width, height) );
 }
 
+// 大帧才需要并行转换，线程池在第一次需要时才创建
+static WorkerPool* getConversionPool(H264MovieTexture *movie) {
+    const plugin_h264::VideoFrame& frame = movie->current_video_frame;
+    if (movie->conversion_threads <= 1 ||
+        frame.width * frame.height < ColorConverter::kParallelMinPixels) {
+        return nullptr;
+    }
+
+    if (!movie->conversion_pool) {
+        movie->conversion_pool.reset(new WorkerPool(movie->conversion_threads));
+        PLUGIN_H264_LOG( ("Created conversion pool with %d threads\n", movie->conversion_threads) );
+    }
+    return movie->conversion_pool.get();
+}
+
+// 读取 newMovieTexture 选项表中的整数字段
+static int getIntegerOption(lua_State *L, int index, const char *name, int default_value) {
+    if (!lua_istable(L, index)) {
+        return default_value;
+    }
+
+    lua_getfield(L, index, name);
+    int value = lua_isnumber(L, -1) ? (int)lua_tointeger(L, -1) : default_value;
+    lua_pop(L, 1);
+    return value;
+}
+
+// 读取 newMovieTexture 选项表中的数值字段
+static double getNumberOption(lua_State *L, int index, const char *name, double default_value) {
+    if (!lua_istable(L, index)) {
+        return default_value;
+    }
+
+    lua_getfield(L, index, name);
+    double value = lua_isnumber(L, -1) ? (double)lua_tonumber(L, -1) : default_value;
+    lua_pop(L, 1);
+    return value;
+}
+
+// 读取 newMovieTexture 选项表中的布尔字段
+static bool getBooleanOption(lua_State *L, int index, const char *name, bool default_value) {
+    if (!lua_istable(L, index)) {
+        return default_value;
+    }
+
+    lua_getfield(L, index, name);
+    bool value = lua_isboolean(L, -1) ? (lua_toboolean(L, -1) != 0) : default_value;
+    lua_pop(L, 1);
+    return value;
+}
+
+// 读取 newMovieTexture 选项表中的字符串字段，返回的指针在选项表存活期间有效
+static const char* getStringOption(lua_State *L, int index, const char *name, const char *default_value) {
+    if (!lua_istable(L, index)) {
+        return default_value;
+    }
+
+    lua_getfield(L, index, name);
+    const char *value = lua_isstring(L, -1) ? lua_tostring(L, -1) : default_value;
+    lua_pop(L, 1);
+    return value;
+}
+
+// 读取 newMovieTexture 选项表中的字符串字段及其长度（可包含\0，用于二进制数据），不存在时返回nullptr
+static const char* getBytesOption(lua_State *L, int index, const char *name, size_t& length) {
+    length = 0;
+    if (!lua_istable(L, index)) {
+        return nullptr;
+    }
+
+    lua_getfield(L, index, name);
+    const char *value = lua_type(L, -1) == LUA_TSTRING ? lua_tolstring(L, -1, &length) : nullptr;
+    lua_pop(L, 1);
+    return value;
+}
+
+// 释放 data 选项的字符串引用，调用前影片不能再读取这块内存
+static void releaseDataRef(H264MovieTexture *movie) {
+    if (movie->data_ref != LUA_NOREF) {
+        luaL_unref(movie->data_state, LUA_REGISTRYINDEX, movie->data_ref);
+        movie->data_ref = LUA_NOREF;
+    }
+}
+
 // Audio streaming functions - 匹配plugin_movie逻辑
 bool startAudioStream(H264MovieTexture *movie) {
     if (!movie->current_audio_frame.isValid()) {
@@ -127,6 +260,25 @@ bool startAudioStream(H264MovieTexture *movie) {
            (int)movie->current_audio_frame.samples.size(),
            movie->current_audio_frame.sample_rate) );
 
+    // 音频线程模式：解码和缓冲区填充都交给 AudioStreamer
+    if (movie->audio_thread) {
+        movie->audio_streamer.reset(new AudioStreamer(movie->decoder.get(), movie->source));
+        double first_timestamp = movie->current_audio_frame.timestamp;
+        if (!movie->audio_streamer->start(std::move(movie->current_audio_frame))) {
+            PLUGIN_H264_LOG( ("Audio streamer failed to start: %s\n", movie->audio_streamer->getLastMessage().c_str()) );
+            movie->audio_streamer.reset();
+            return false;
+        }
+        movie->last_audio_timestamp = first_timestamp;
+        movie->current_audio_frame = AudioFrame();
+        movie->clock.setAudioSource(movie->audio_streamer.get());
+        return true;
+    }
+
+    movie->queued_audio_clock.source = movie->source;
+    movie->queued_audio_clock.position.reset(movie->current_audio_frame.timestamp,
+                                             movie->current_audio_frame.sample_rate);
+
     // 确保音频缓冲区存在（可能在 stopAudioStream 中被删除了）
     ALboolean buffers_valid = alIsBuffer(movie->buffers[0]);
     if (!buffers_valid) {
@@ -192,6 +344,8 @@ bool startAudioStream(H264MovieTexture *movie) {
                    error, i, movie->audioformat, size, movie->current_audio_frame.sample_rate) );
             return false;
         }
+        movie->queued_audio_clock.position.queued(
+            movie->current_audio_frame.samples.size() / std::max(1, movie->current_audio_frame.channels));
 
         // 获取下一个音频帧（使用分离的音频解码）
         if (!movie->decoder->hasNewAudioFrame()) {
@@ -199,7 +353,7 @@ bool startAudioStream(H264MovieTexture *movie) {
         }
 
         if(movie->decoder->hasNewAudioFrame()) {
-            movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
+            movie->current_audio_frame = movie->decoder->takeCurrentAudioFrame();
         } else {
             PLUGIN_H264_LOG( ("Only %d audio buffers filled (expected %d)\n", i+1, NUM_BUFFERS) );
             break;
@@ -220,21 +374,114 @@ bool startAudioStream(H264MovieTexture *movie) {
         return false;
     }
 
+    movie->clock.setAudioSource(&movie->queued_audio_clock);
+
     PLUGIN_H264_LOG( ("Audio stream started successfully with %d buffers\n", i) );
     return true;
 }
 
 void stopAudioStream(H264MovieTexture *movie) {
+    // 音频来源即将失效，主时钟从当前位置改按系统时间推进
+    movie->clock.setAudioSource(nullptr);
+
+    // 先停止音频线程，之后才能在主线程上解码音频
+    if (movie->audio_streamer) {
+        movie->audio_streamer->stop();
+        movie->audio_streamer.reset();
+    }
+
     alSourceStop(movie->source);
     alSourceRewind(movie->source);
     alSourcei(movie->source, AL_BUFFER, 0);
     alDeleteBuffers(NUM_BUFFERS, movie->buffers);
 }
 
+// 单通道纹理每行按4字节对齐，不依赖GL_UNPACK_ALIGNMENT
+static int alignedPlaneWidth(int width) {
+    return (width + 3) & ~3;
+}
+
+static int chromaWidth(const plugin_h264::VideoFrame& frame) {
+    return (frame.width + 1) / 2;
+}
+
+static int chromaHeight(const plugin_h264::VideoFrame& frame) {
+    return (frame.height + 1) / 2;
+}
+
+// 按行拷贝平面，去掉解码器的行填充
+static void packPlane(const uint8_t *src, int src_stride, int width, int height, uint8_t *dst, int dst_stride) {
+    for (int row = 0; row < height; row++) {
+        memcpy(dst + row * dst_stride, src + row * src_stride, width);
+    }
+}
+
+#if PLUGIN_H264_ENABLE_PERF_STATS
+// 颜色转换和音频填充在这里完成，计时记到影片的统计上
+static PerfStats* getPerfStats(H264MovieTexture *movie) {
+    return movie->decoder ? &movie->decoder->getPerfStats() : nullptr;
+}
+#endif
+
+// Y平面：宽度按4字节对齐，右侧填充列由着色器的lumaScale裁掉
+static const void* packLumaPlane(H264MovieTexture *movie) {
+    const plugin_h264::VideoFrame& frame = movie->current_video_frame;
+    YUVPlaneTextures& planes = *movie->yuv_planes;
+
+    if (!frame.isValid()) {
+        planes.luma.assign(1, 0);
+        return planes.luma.data();
+    }
+    if (isFrameCached(movie, planes.luma_generation)) {
+        return planes.luma.data();
+    }
+
+    PLUGIN_H264_PERF_SCOPE(getPerfStats(movie), PerfStage::YUV_TO_RGBA);
+    int stride = alignedPlaneWidth(frame.width);
+    planes.luma.resize(stride * frame.height);
+    packPlane(frame.y_plane, frame.y_stride, frame.width, frame.height, planes.luma.data(), stride);
+    return planes.luma.data();
+}
+
+// 色度平面：U在上半部分，V在下半部分
+// 每半部分在相邻处多一行重复的边缘行，线性过滤时U的最后一行和V的第一行不会混入另一平面
+static const void* packChromaPlane(H264MovieTexture *movie) {
+    YUVPlaneTextures& planes = *movie->yuv_planes;
+
+    if (!movie->current_video_frame.isValid()) {
+        planes.chroma.assign(1, 128);
+        return planes.chroma.data();
+    }
+
+    if (isFrameCached(movie, planes.chroma_generation, false)) {
+        return planes.chroma.data();
+    }
+
+    PLUGIN_H264_PERF_SCOPE(getPerfStats(movie), PerfStage::YUV_TO_RGBA);
+    const plugin_h264::VideoFrame& frame = movie->current_video_frame;
+    int width = chromaWidth(frame);
+    int height = chromaHeight(frame);
+    int stride = alignedPlaneWidth(width);
+    planes.chroma.resize(stride * (height + 1) * 2);
+    uint8_t *u = planes.chroma.data();
+    uint8_t *v = u + stride * (height + 2);
+    packPlane(frame.u_plane, frame.uv_stride, width, height, u, stride);
+    packPlane(frame.v_plane, frame.uv_stride, width, height, v, stride);
+    memcpy(u + stride * height, u + stride * (height - 1), stride);
+    memcpy(v - stride, v, stride);
+    return planes.chroma.data();
+}
+
 // Texture callback implementations
 static unsigned int GetWidth(void *context) {
     H264MovieTexture *movie = (H264MovieTexture*)context;
-    return movie->current_video_frame.width > 0 ? movie->current_video_frame.width : 1;
+    if (movie->current_video_frame.width <= 0) {
+        return 1;
+    }
+    if (movie->yuv_planes) {
+        return alignedPlaneWidth(movie->current_video_frame.width);
+    }
+    return movie->current_video_frame.width;
 }
 
 static unsigned int GetHeight(void *context) {
@@ -245,13 +492,24 @@ static unsigned int GetHeight(void *context) {
 static const void* GetImage(void *context) {
     H264MovieTexture *movie = (H264MovieTexture*)context;
 
+    if (movie->yuv_planes) {
+        return packLumaPlane(movie);
+    }
+
     PLUGIN_H264_LOG( ("GetImage called: playing=%s, frame_valid=%s\n",
            movie->playing ? "true" : "false",
            movie->current_video_frame.isValid() ? "true" : "false") );
 
     if (movie->current_video_frame.isValid()) {
-        // 总是转换YUV到RGBA，确保获得最新的帧数据
-        convertYUVtoRGBA(movie->current_video_frame, movie->rgba_data);
+        // 帧没有变化时直接返回上次转换的结果
+        if (isFrameCached(movie, movie->converted_generation)) {
+            return movie->rgba_data.data();
+        }
+
+        {
+            PLUGIN_H264_PERF_SCOPE(getPerfStats(movie), PerfStage::YUV_TO_RGBA);
+            convertYUVtoRGBA(movie->current_video_frame, movie->rgba_data, getConversionPool(movie));
+        }
 
         PLUGIN_H264_LOG( ("GetImage: Converted YUV to RGBA, size=%zu bytes\n", movie->rgba_data.size()) );
 
@@ -274,6 +532,36 @@ static const void* GetImage(void *context) {
     }
 }
 
+// 着色器用于裁掉对齐填充列的纹理坐标缩放
+static int planeScale(lua_State *L, void *context, bool chroma) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    const plugin_h264::VideoFrame& frame = movie->current_video_frame;
+    double scale = 1.0;
+
+    if (movie->yuv_planes && frame.width > 0) {
+        int width = chroma ? chromaWidth(frame) : frame.width;
+        scale = (double)width / alignedPlaneWidth(width);
+    }
+
+    lua_pushnumber(L, scale);
+    return 1;
+}
+
+// 色度纹理每半部分中有效行的比例，着色器据此跳过保护行
+static int chromaRowScale(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    const plugin_h264::VideoFrame& frame = movie->current_video_frame;
+    double scale = 1.0;
+
+    if (movie->yuv_planes && frame.height > 0) {
+        int height = chromaHeight(frame);
+        scale = (double)height / (height + 1);
+    }
+
+    lua_pushnumber(L, scale);
+    return 1;
+}
+
 // CRITICAL: onGetField callback - 动态提供方法，与plugin_movie完全一致
 static int GetField(lua_State *L, const char *field, void *context) {
     int result = 0;
@@ -293,10 +581,9 @@ static int GetField(lua_State *L, const char *field, void *context) {
     else if(strcmp(field, "replay") == 0) {
         result = PushCachedFunction(L, replay);
     }
-    // seek is not correctly implemented
-    // else if(strcmp(field, "seek") == 0) {
-    //     result = PushCachedFunction(L, seek);
-    // }
+    else if(strcmp(field, "seek") == 0) {
+        result = PushCachedFunction(L, seek);
+    }
     else if(strcmp(field, "invalidate") == 0) {
         result = PushCachedFunction(L, invalidate);
     }
@@ -306,12 +593,99 @@ static int GetField(lua_State *L, const char *field, void *context) {
         result = isPlaying(L, context);
     else if(strcmp(field, "currentTime") == 0)
         result = currentTime(L, context);
+    else if(strcmp(field, "frameGeneration") == 0)
+        result = frameGeneration(L, context);
+    else if(strcmp(field, "conversionStats") == 0)
+        result = conversionStats(L, context);
+    else if(strcmp(field, "presentationStats") == 0)
+        result = presentationStats(L, context);
+    else if(strcmp(field, "setClock") == 0)
+        result = PushCachedFunction(L, setClock);
+    else if(strcmp(field, "setSyncMode") == 0)
+        result = PushCachedFunction(L, setSyncMode);
+    else if(strcmp(field, "clockTime") == 0)
+        result = clockTime(L, context);
+    else if(strcmp(field, "syncMode") == 0)
+        result = syncMode(L, context);
+    else if(strcmp(field, "decodeSkip") == 0)
+        result = decodeSkip(L, context);
+    else if(strcmp(field, "skipStats") == 0)
+        result = skipStats(L, context);
+    else if(strcmp(field, "setDecodeSkip") == 0)
+        result = PushCachedFunction(L, setDecodeSkip);
+    else if(strcmp(field, "setDecodeLate") == 0)
+        result = PushCachedFunction(L, setDecodeLate);
+    else if(strcmp(field, "setBytesAvailable") == 0)
+        result = PushCachedFunction(L, setBytesAvailable);
+    else if(strcmp(field, "waitingForData") == 0)
+        result = waitingForData(L, context);
+    else if(strcmp(field, "memoryUsage") == 0)
+        result = memoryUsage(L, context);
+    else if(strcmp(field, "getStats") == 0)
+        result = PushCachedFunction(L, getStats);
+    else if(strcmp(field, "lumaScale") == 0)
+        result = planeScale(L, context, false);
+    else if(strcmp(field, "chromaScale") == 0)
+        result = planeScale(L, context, true);
+    else if(strcmp(field, "chromaRowScale") == 0)
+        result = chromaRowScale(L, context);
 
     return result;
 }
 
 static CoronaExternalBitmapFormat GetFormat(void *context) {
-    return kExternalBitmapFormat_RGBA;
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    return movie->yuv_planes ? kExternalBitmapFormat_Mask : kExternalBitmapFormat_RGBA;
+}
+
+// 色度纹理回调，context 为 shared_ptr<YUVPlaneTextures>*
+static H264MovieTexture* chromaMovie(void *context) {
+    return (*(std::shared_ptr<YUVPlaneTextures>*)context)->movie;
+}
+
+static unsigned int GetChromaWidth(void *context) {
+    H264MovieTexture *movie = chromaMovie(context);
+    if (!movie || movie->current_video_frame.width <= 0) {
+        return 1;
+    }
+    return alignedPlaneWidth(chromaWidth(movie->current_video_frame));
+}
+
+static unsigned int GetChromaHeight(void *context) {
+    H264MovieTexture *movie = chromaMovie(context);
+    if (!movie || movie->current_video_frame.height <= 0) {
+        return 1;
+    }
+    return (chromaHeight(movie->current_video_frame) + 1) * 2;
+}
+
+static const void* GetChromaImage(void *context) {
+    H264MovieTexture *movie = chromaMovie(context);
+    if (!movie) {
+        // 影片纹理已释放，保持尺寸为1x1的中性色度
+        static const uint8_t neutral[4] = {128, 128, 128, 128};
+        return neutral;
+    }
+    return packChromaPlane(movie);
+}
+
+static CoronaExternalBitmapFormat GetChromaFormat(void * /*context*/) {
+    return kExternalBitmapFormat_Mask;
+}
+
+// 创建色度纹理，与影片纹理共享 YUVPlaneTextures
+static int pushChromaTexture(lua_State *L, H264MovieTexture *movie) {
+    CoronaExternalTextureCallbacks callbacks = {};
+    callbacks.size = sizeof(CoronaExternalTextureCallbacks);
+    callbacks.getWidth = GetChromaWidth;
+    callbacks.getHeight = GetChromaHeight;
+    callbacks.onRequestBitmap = GetChromaImage;
+    callbacks.getFormat = GetChromaFormat;
+    callbacks.onFinalize = [](void* context) {
+        delete (std::shared_ptr<YUVPlaneTextures>*)context;
+    };
+
+    return CoronaExternalPushTexture(L, &callbacks, new std::shared_ptr<YUVPlaneTextures>(movie->yuv_planes));
 }
 
 // Core texture creation function
@@ -320,28 +694,89 @@ int newMovieTexture(lua_State *L) {
 
     const char *path = lua_tostring(L, 1);
 
-    if(!path) {
+    // data 选项：内存中的影片数据（Lua字符串），代替文件路径
+    size_t data_size = 0;
+    const char *data = getBytesOption(L, 4, "data", data_size);
+
+    if(!path && !data) {
         delete movie;
         lua_pushnil(L);
         return 1;
     }
 
+    // 选项表（第4个参数）
+    movie->conversion_threads = WorkerPool::resolveThreadCount(getIntegerOption(L, 4, "conversionThreads", 0));
+    movie->audio_thread = getBooleanOption(L, 4, "audioThread", true);
+
+    // 主时钟模式："audio"（默认）/"video"/"external"
+    ClockMode clock_mode = ClockMode::AUDIO_MASTER;
+    MediaClock::parseMode(getStringOption(L, 4, "syncMode", "audio"), clock_mode);
+    movie->clock.setMode(clock_mode);
+    if (getBooleanOption(L, 4, "yuvOutput", false)) {
+        movie->yuv_planes = std::make_shared<YUVPlaneTextures>();
+        movie->yuv_planes->movie = movie;
+    }
+
     // Create H.264 decoder instance
     movie->decoder = std::make_unique<plugin_h264::H264Movie>();
 
+    // OpenH264内部解码线程数（默认单线程）
+    H264DecoderConfig decoder_config;
+    decoder_config.thread_count = getIntegerOption(L, 4, "decodeThreads", decoder_config.thread_count);
+    // 落后时的跳帧策略："none"/"nonref"（默认）/"idr"
+    H264Decoder::parseSkipPolicy(getStringOption(L, 4, "decodeSkip", "nonref"), decoder_config.skip_policy);
+    movie->decoder->setDecoderConfig(decoder_config);
+
+    // 裸H.264码流（.h264）没有时间戳，按帧率合成；默认使用SPS中的帧率，没有时为25fps
+    movie->decoder->setStreamFrameRate(getNumberOption(L, 4, "frameRate", 0.0));
+
     // Load video file
-    if(!movie->decoder->loadFromFile(path)) {
+    bool loaded;
+    if (data) {
+        // 引用住字符串，纹理释放之前不会被回收，解复用器直接读取，不复制
+        lua_getfield(L, 4, "data");
+        movie->data_state = CoronaLuaGetCoronaThread(L);
+        movie->data_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        loaded = movie->decoder->loadFromMemory(reinterpret_cast<const uint8_t*>(data), data_size,
+                                                MemoryOwnership::BORROW);
+    } else if (getBooleanOption(L, 4, "streaming", false)) {
+        // 边下载边播放：文件中至少要有moov，之后的分片到达后陆续可播放
+        movie->stream_progress = std::make_shared<StreamProgress>();
+        movie->stream_progress->bytes_available = (int64_t)getNumberOption(L, 4, "bytesAvailable", -1);
+        std::shared_ptr<StreamProgress> progress = movie->stream_progress;
+        loaded = movie->decoder->loadFromStream(path, [progress](bool& complete) {
+            complete = progress->complete;
+            return static_cast<int64_t>(progress->bytes_available);
+        });
+    } else {
+        loaded = movie->decoder->loadFromFile(path);
+    }
+
+    if(!loaded) {
+        movie->decoder.reset();
+        releaseDataRef(movie);
         delete movie;
         lua_pushnil(L);
         return 1;
     }
 
+    // 异步解码：解码线程提前把帧解到有界队列中，必须在解码第一帧之前开启
+    if (getBooleanOption(L, 4, "asyncDecode", false)) {
+        FrameQueueConfig queue_config;
+        queue_config.depth = getIntegerOption(L, 4, "decodeQueueDepth", queue_config.depth);
+        queue_config.high_watermark = getIntegerOption(L, 4, "decodeHighWatermark", queue_config.depth);
+        queue_config.low_watermark = getIntegerOption(L, 4, "decodeLowWatermark", queue_config.high_watermark / 2);
+        queue_config.blocking_pop = getBooleanOption(L, 4, "decodeBlockingPop", queue_config.blocking_pop);
+        queue_config.pop_timeout_ms = getIntegerOption(L, 4, "decodePopTimeout", queue_config.pop_timeout_ms);
+        movie->decoder->enableAsyncDecode(queue_config);
+    }
+
     // 解码第一帧以便立即显示
     bool result = movie->decoder->decodeNextFrame();
     PLUGIN_H264_LOG( ("Attempting to decode first frame: %s...\n", result ? "true" : "false") );
 
     if(movie->decoder->hasNewVideoFrame()) {
-        movie->current_video_frame = movie->decoder->getCurrentVideoFrame();
+        setCurrentVideoFrame(movie, movie->decoder->getCurrentVideoFrame());
         PLUGIN_H264_LOG( ("First video frame decoded successfully: %dx%d, timestamp=%.3fs\n",
                movie->current_video_frame.width, movie->current_video_frame.height,
                movie->current_video_frame.timestamp) );
@@ -350,7 +785,7 @@ int newMovieTexture(lua_State *L) {
     }
 
     if(movie->decoder->hasNewAudioFrame()) {
-        movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
+        movie->current_audio_frame = movie->decoder->takeCurrentAudioFrame();
         PLUGIN_H264_LOG( ("First audio frame decoded: %d channels, %d samples\n",
                movie->current_audio_frame.channels, (int)movie->current_audio_frame.samples.size()) );
     } else {
@@ -369,7 +804,7 @@ int newMovieTexture(lua_State *L) {
     callbacks.getWidth = GetWidth;
     callbacks.getHeight = GetHeight;
     callbacks.onRequestBitmap = GetImage;
-    callbacks.getFormat = GetFormat;        // 提供RGBA格式信息
+    callbacks.getFormat = GetFormat;        // RGBA，YUV输出模式下为单通道Y平面
     callbacks.onGetField = GetField;        // 关键：动态提供methods和properties
     callbacks.onFinalize = [](void* context) {
         H264MovieTexture *movie = (H264MovieTexture*)context;
@@ -394,10 +829,26 @@ int newMovieTexture(lua_State *L) {
         movie->rgba_data.clear();
         movie->rgba_data.shrink_to_fit();
 
+        // 色度纹理可能还活着，断开它对影片的引用
+        if (movie->yuv_planes) {
+            movie->yuv_planes->movie = nullptr;
+        }
+
+        // 解码器（和读取它的音频线程）不再读取 data 字符串之后才能解除引用
+        movie->audio_streamer.reset();
+        movie->decoder.reset();
+        releaseDataRef(movie);
+
         delete movie;
     };
 
-    return CoronaExternalPushTexture(L, &callbacks, movie);
+    int pushed = CoronaExternalPushTexture(L, &callbacks, movie);
+
+    // YUV输出模式额外返回色度纹理
+    if (pushed && movie->yuv_planes) {
+        pushed += pushChromaTexture(L, movie);
+    }
+    return pushed;
 }
 
 // 实现所有texture方法 - 与plugin_movie逻辑完全一致
@@ -422,17 +873,17 @@ static int update(lua_State *L) {
                 movie->decoder->decodeNextVideoFrame();
             }
             if (movie->decoder->hasNewVideoFrame()) {
-                movie->current_video_frame = movie->decoder->getCurrentVideoFrame();
+                setCurrentVideoFrame(movie, movie->decoder->getCurrentVideoFrame());
             }
         }
 
-        // 独立解码音频帧（仅当文件包含音频时）
-        if (!movie->current_audio_frame.isValid() && movie->decoder->hasAudioTrack()) {
+        // 独立解码音频帧（仅当文件包含音频时，音频线程运行时由其自行解码）
+        if (!movie->current_audio_frame.isValid() && movie->decoder->hasAudioTrack() && !movie->audio_streamer) {
             if (!movie->decoder->hasNewAudioFrame()) {
                 movie->decoder->decodeNextAudioFrame();
             }
             if (movie->decoder->hasNewAudioFrame()) {
-                movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
+                movie->current_audio_frame = movie->decoder->takeCurrentAudioFrame();
             }
         }
 
@@ -464,151 +915,99 @@ static int update(lua_State *L) {
                     }
                 }
 
-                ALint state, processed;
-                alGetSourcei(movie->source, AL_SOURCE_STATE, &state);
-                alGetSourcei(movie->source, AL_BUFFERS_PROCESSED, &processed);
-
-                // 计算期望的播放时间（基于播放开始时间）
-                double expected_time = (currentTime / 1000.0) - movie->playback_start_time;
-                double audio_timestamp = movie->current_audio_frame.timestamp;
-
-                // 更新音频时间戳记录
-                movie->last_audio_timestamp = audio_timestamp;
-
-                // 计算音视频偏移量（音频时间戳 - 期望时间）
-                double audio_offset = audio_timestamp - expected_time;
-
-                while(processed > 0) {
-                    ALuint buffID;
-                    alSourceUnqueueBuffers(movie->source, 1, &buffID);
-                    processed--;
+                // 音频线程已接管缓冲区填充
+                if (!movie->audio_streamer) {
+                    ALint state, processed;
+                    alGetSourcei(movie->source, AL_SOURCE_STATE, &state);
+                    alGetSourcei(movie->source, AL_BUFFERS_PROCESSED, &processed);
+
+                    // 计算期望的播放时间（基于播放开始时间）
+                    double expected_time = (currentTime / 1000.0) - movie->playback_start_time;
+                    double audio_timestamp = movie->current_audio_frame.timestamp;
+
+                    // 更新音频时间戳记录
+                    movie->last_audio_timestamp = audio_timestamp;
+
+                    // 计算音视频偏移量（音频时间戳 - 期望时间）
+                    double audio_offset = audio_timestamp - expected_time;
+
+                    while(processed > 0) {
+                        ALuint buffID;
+                        alSourceUnqueueBuffers(movie->source, 1, &buffID);
+                        movie->queued_audio_clock.position.unqueued();
+                        processed--;
+
+                        {
+                            PLUGIN_H264_PERF_SCOPE(getPerfStats(movie), PerfStage::AUDIO_REFILL);
+                            ALsizei size = movie->current_audio_frame.samples.size() * sizeof(int16_t);
+                            alBufferData(buffID, movie->audioformat,
+                                        movie->current_audio_frame.samples.data(), size,
+                                        movie->current_audio_frame.sample_rate);
+                        }
 
-                    ALsizei size = movie->current_audio_frame.samples.size() * sizeof(int16_t);
-                    alBufferData(buffID, movie->audioformat,
-                                movie->current_audio_frame.samples.data(), size,
-                                movie->current_audio_frame.sample_rate);
+                        alSourceQueueBuffers(movie->source, 1, &buffID);
+                        movie->queued_audio_clock.position.queued(
+                            movie->current_audio_frame.samples.size() / std::max(1, movie->current_audio_frame.channels));
 
-                    alSourceQueueBuffers(movie->source, 1, &buffID);
+                        // 获取下一个音频帧（使用分离的音频解码）
+                        if (!movie->decoder->hasNewAudioFrame()) {
+                            movie->decoder->decodeNextAudioFrame();
+                        }
 
-                    // 获取下一个音频帧（使用分离的音频解码）
-                    if (!movie->decoder->hasNewAudioFrame()) {
-                        movie->decoder->decodeNextAudioFrame();
+                        if(movie->decoder->hasNewAudioFrame()) {
+                            movie->current_audio_frame = movie->decoder->takeCurrentAudioFrame();
+                            movie->last_audio_timestamp = movie->current_audio_frame.timestamp;
+                        } else {
+                            movie->current_audio_frame = AudioFrame(); // 清空
+                            break;
+                        }
                     }
 
-                    if(movie->decoder->hasNewAudioFrame()) {
-                        movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
-                        movie->last_audio_timestamp = movie->current_audio_frame.timestamp;
-                    } else {
-                        movie->current_audio_frame = AudioFrame(); // 清空
-                        break;
+                    // 打印同步信息（仅当差距较大时）
+                    if (fabs(audio_offset) > 0.1) {
+                        PLUGIN_H264_LOG( ("Audio sync: expected=%.3fs, audio=%.3fs, offset=%.3fs\n",
+                               expected_time, audio_timestamp, audio_offset) );
                     }
-                }
 
-                // 打印同步信息（仅当差距较大时）
-                if (fabs(audio_offset) > 0.1) {
-                    PLUGIN_H264_LOG( ("Audio sync: expected=%.3fs, audio=%.3fs, offset=%.3fs\n",
-                           expected_time, audio_timestamp, audio_offset) );
+                    if(state == AL_STOPPED) {
+                        if(movie->decoder->hasNewAudioFrame()) {
+                            alSourcePlay(movie->source);
+                        } else {
+                            movie->audiocompleted = true;
+                        }
+                    }
                 }
+            }
 
-                if(state == AL_STOPPED) {
-                    if(movie->decoder->hasNewAudioFrame()) {
-                        alSourcePlay(movie->source);
-                    } else {
-                        movie->audiocompleted = true;
-                    }
+            // 音频线程模式：音频进度来自已送入OpenAL的样本
+            if (movie->audio_streamer) {
+                movie->last_audio_timestamp = movie->audio_streamer->getQueuedTime();
+                if (movie->audio_streamer->isFinished()) {
+                    movie->audiocompleted = true;
                 }
             }
 
-            // 视频处理 - 基于播放时间基准的同步控制
+            // 视频处理：呈现调度器按主时钟解码并丢弃中间帧，直接落在此刻应显示的帧上
             if(movie->current_video_frame.isValid()) {
                 double currentTimeSeconds = currentTime / 1000.0;
-                double frameTime = movie->current_video_frame.timestamp;
-
-                // 更新视频时间戳记录
-                movie->last_video_timestamp = frameTime;
-
-                // 如果播放已开始，计算期望的播放时间
-                double expected_time = 0.0;
-                double video_offset = 0.0;
-                bool should_advance_frame = false;
-
-                if (movie->playback_start_time > 0.0) {
-                    expected_time = currentTimeSeconds - movie->playback_start_time;
-                    video_offset = frameTime - expected_time;
-
-                    // 视频等待音频：基于音频时间戳来控制视频进度
-                    if (movie->last_audio_timestamp > 0.0) {
-                        // 只有当视频落后于音频时才推进视频帧
-                        if (frameTime < movie->last_audio_timestamp - 0.040) { // 视频滞后于音频40ms以上
-                            should_advance_frame = true;
-                        }
-                        // 如果视频超前于音频，则等待（不推进）
-                        // 这样确保视频不会超前于音频播放
-                    } else {
-                        // 如果还没有音频时间戳，使用期望时间
-                        if (video_offset < -0.050) {
-                            should_advance_frame = true;
-                        }
-                    }
-                } else {
-                    // 如果还没开始播放，初始化播放时间基准
-                    if (movie->playback_start_time == 0.0) {
-                        movie->playback_start_time = currentTimeSeconds;
-                        PLUGIN_H264_LOG( ("Video playback started at time %.3fs (first frame: %.3fs)\n",
-                               movie->playback_start_time, frameTime) );
-                        // 立即推进到下一帧，因为当前帧已经显示
-                        should_advance_frame = true;
-                    } else {
-                        // 使用传统的时间戳比较
-                        if (currentTimeSeconds > frameTime + 0.040) {
-                            should_advance_frame = true;
-                        }
-                    }
-                }
-
-                // 获取视频总时长用于进度显示
-                double totalDuration = movie->decoder->getDuration();
-                double progress = totalDuration > 0 ? (frameTime / totalDuration) * 100.0 : 0.0;
-
-                // 打印同步信息（显示视频相对于音频的状态）
-                if (movie->playback_start_time > 0.0 && movie->last_audio_timestamp > 0.0) {
-                    double av_diff = frameTime - movie->last_audio_timestamp;
-                    if (fabs(av_diff) > 0.05 || should_advance_frame) {
-                        PLUGIN_H264_LOG( ("Video waiting for audio: video=%.3fs, audio=%.3fs, V-A=%.3fs, advance=%s\n",
-                               frameTime, movie->last_audio_timestamp, av_diff,
-                               should_advance_frame ? "YES" : "NO") );
-                    }
-                } else if (movie->playback_start_time > 0.0 && fabs(video_offset) > 0.1) {
-                    PLUGIN_H264_LOG( ("Video sync (no audio ref): expected=%.3fs, video=%.3fs, offset=%.3fs\n",
-                           expected_time, frameTime, video_offset) );
+                if (movie->playback_start_time == 0.0) {
+                    movie->playback_start_time = currentTimeSeconds;
+                    PLUGIN_H264_LOG( ("Video playback started at time %.3fs (first frame: %.3fs)\n",
+                           movie->playback_start_time, movie->current_video_frame.timestamp) );
                 }
 
-                if (should_advance_frame) {
-                    // 尝试解码下一视频帧（使用分离的视频解码）
-                    if (!movie->decoder->hasNewVideoFrame()) {
-                        movie->decoder->decodeNextVideoFrame();
-                    }
+                // 主时钟：默认为真正播放出来的音频位置（AL_SAMPLE_OFFSET），没有音频时按系统时间推进
+                double master_clock = movie->clock.getTime();
 
-                    if(movie->decoder->hasNewVideoFrame()) {
-                        auto next_frame = movie->decoder->getCurrentVideoFrame();
-                        if(next_frame.isValid()) {
-                            movie->current_video_frame = next_frame;
-                            movie->last_video_timestamp = movie->current_video_frame.timestamp;
-                            // 清空RGBA缓存强制重新转换
-                            movie->rgba_data.clear();
-
-                            if (movie->playback_start_time > 0.0) {
-                                if (movie->last_audio_timestamp > 0.0) {
-                                    PLUGIN_H264_LOG( ("Video frame advanced: %.3fs -> %.3fs (audio at: %.3fs)\n",
-                                           frameTime, movie->current_video_frame.timestamp, movie->last_audio_timestamp) );
-                                } else {
-                                    PLUGIN_H264_LOG( ("Video frame advanced: %.3fs -> %.3fs (expected: %.3fs)\n",
-                                           frameTime, movie->current_video_frame.timestamp, expected_time) );
-                                }
-                            }
-                        }
+                if (movie->decoder->presentVideoFrame(master_clock)) {
+                    auto next_frame = movie->decoder->getCurrentVideoFrame();
+                    if(next_frame.isValid()) {
+                        PLUGIN_H264_LOG( ("Video frame advanced: %.3fs -> %.3fs (clock: %.3fs)\n",
+                               movie->current_video_frame.timestamp, next_frame.timestamp, master_clock) );
+                        setCurrentVideoFrame(movie, next_frame);
                     }
                 }
+                movie->last_video_timestamp = movie->current_video_frame.timestamp;
             }
 
             // 周期性同步状态报告（每2秒报告一次）
@@ -631,7 +1030,9 @@ static int update(lua_State *L) {
     // 处理解码完成后剩余音频
     else if(movie->audiostarted && !movie->audiocompleted) {
         // 简化的完成检查
-        if(!movie->decoder || (!movie->decoder->hasNewAudioFrame() && !movie->decoder->hasNewVideoFrame())) {
+        if (movie->audio_streamer) {
+            movie->audiocompleted = movie->audio_streamer->isFinished();
+        } else if(!movie->decoder || (!movie->decoder->hasNewAudioFrame() && !movie->decoder->hasNewVideoFrame())) {
             movie->audiocompleted = true;
         }
     }
@@ -644,8 +1045,13 @@ static int play(lua_State *L) {
 
     if(!movie->playing) {
         movie->playing = true;
+        movie->clock.resume();
         if(movie->audiostarted && !movie->audiocompleted) {
-            alSourcePlay(movie->source);
+            if (movie->audio_streamer) {
+                movie->audio_streamer->resume();
+            } else {
+                alSourcePlay(movie->source);
+            }
         }
     }
 
@@ -657,8 +1063,13 @@ static int pause(lua_State *L) {
 
     if(movie->playing) {
         movie->playing = false;
+        movie->clock.pause();
         if(movie->audiostarted && !movie->audiocompleted) {
-            alSourcePause(movie->source);
+            if (movie->audio_streamer) {
+                movie->audio_streamer->pause();
+            } else {
+                alSourcePause(movie->source);
+            }
         }
     }
 
@@ -670,6 +1081,7 @@ static int stop(lua_State *L) {
 
     movie->stopped = true;
     movie->playing = false;
+    movie->clock.pause();
 
     // 使用统一的stopAudioStream函数
     if(movie->audiostarted) {
@@ -716,7 +1128,7 @@ static int replay(lua_State *L) {
     movie->last_sync_report_time = 0.0;
 
     // 清空当前帧数据
-    movie->current_video_frame = plugin_h264::VideoFrame();
+    setCurrentVideoFrame(movie, plugin_h264::VideoFrame());
     movie->current_audio_frame = plugin_h264::AudioFrame();
 
     PLUGIN_H264_LOG( ("Reset H264MovieTexture state for replay\n") );
@@ -727,8 +1139,10 @@ static int replay(lua_State *L) {
     PLUGIN_H264_LOG( ("H264Movie replay result: %s\n", success ? "true" : "false") );
 
     // 如果 replay 成功，设置播放状态为 true
+    movie->clock.reset(0.0);
     if (success) {
         movie->playing = true;
+        movie->clock.resume();
         PLUGIN_H264_LOG( ("Set movie->playing = true after successful replay\n") );
     }
 
@@ -750,7 +1164,7 @@ static int replay(lua_State *L) {
         }
 
         if(movie->decoder->hasNewVideoFrame()) {
-            movie->current_video_frame = movie->decoder->getCurrentVideoFrame();
+            setCurrentVideoFrame(movie, movie->decoder->getCurrentVideoFrame());
             PLUGIN_H264_LOG( ("First video frame decoded after replay (attempt %d): %dx%d, timestamp=%.3fs\n",
                    decode_attempts, movie->current_video_frame.width, movie->current_video_frame.height,
                    movie->current_video_frame.timestamp) );
@@ -759,7 +1173,7 @@ static int replay(lua_State *L) {
         }
 
         if(movie->decoder->hasNewAudioFrame()) {
-            movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
+            movie->current_audio_frame = movie->decoder->takeCurrentAudioFrame();
             PLUGIN_H264_LOG( ("First audio frame decoded after replay: %d channels, %d samples\n",
                    movie->current_audio_frame.channels, (int)movie->current_audio_frame.samples.size()) );
         }
@@ -796,6 +1210,228 @@ static int isPlaying(lua_State *L, void *context) {
     return 1;
 }
 
+// 帧代数变化时 Lua 侧才需要 invalidate 纹理
+static int frameGeneration(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+
+    lua_pushnumber(L, (lua_Number)movie->frame_generation);
+    return 1;
+}
+
+static int conversionStats(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+
+    lua_createtable(L, 0, 2);
+    lua_pushnumber(L, (lua_Number)movie->conversions);
+    lua_setfield(L, -2, "conversions");
+    lua_pushnumber(L, (lua_Number)movie->skipped_conversions);
+    lua_setfield(L, -2, "skipped");
+    return 1;
+}
+
+// 外部主时钟模式下由 Lua 推进媒体时间（秒）
+static int setClock(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    movie->clock.setExternalTime(luaL_checknumber(L, 2));
+    return 0;
+}
+
+static int setSyncMode(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    ClockMode mode;
+    if (!MediaClock::parseMode(luaL_checkstring(L, 2), mode)) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    movie->clock.setMode(mode);
+    lua_pushboolean(L, true);
+    return 1;
+}
+
+static int clockTime(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+
+    lua_pushnumber(L, movie->clock.getTime());
+    return 1;
+}
+
+static int syncMode(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+
+    lua_pushstring(L, MediaClock::getModeName(movie->clock.getMode()));
+    return 1;
+}
+
+static int decodeSkip(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    DecodeSkipPolicy policy = movie->decoder ? movie->decoder->getDecodeSkipPolicy() : DecodeSkipPolicy::NONE;
+
+    lua_pushstring(L, H264Decoder::getSkipPolicyName(policy));
+    return 1;
+}
+
+// 解码器按跳帧策略丢弃的帧数
+static int skipStats(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    DecodeSkipStats stats;
+    if (movie->decoder) {
+        stats = movie->decoder->getDecodeSkipStats();
+    }
+
+    lua_createtable(L, 0, 2);
+    lua_pushnumber(L, (lua_Number)stats.non_reference);
+    lua_setfield(L, -2, "nonReference");
+    lua_pushnumber(L, (lua_Number)stats.until_idr);
+    lua_setfield(L, -2, "untilIDR");
+    return 1;
+}
+
+static int setDecodeSkip(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    DecodeSkipPolicy policy;
+    if (!movie->decoder || !H264Decoder::parseSkipPolicy(luaL_checkstring(L, 2), policy)) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    lua_pushboolean(L, movie->decoder->setDecodeSkipPolicy(policy));
+    return 1;
+}
+
+// 游戏帧超出预算时由 Lua 置位，解码器按跳帧策略减负
+static int setDecodeLate(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    if (movie->decoder) {
+        movie->decoder->setDecodeLate(lua_toboolean(L, 2) != 0);
+    }
+    return 0;
+}
+
+// 下载进度：已写入文件的字节数（nil 表示以磁盘上的文件大小为准），complete 为 true 表示下载完成
+static int setBytesAvailable(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    if (movie->stream_progress) {
+        movie->stream_progress->bytes_available = lua_isnumber(L, 2) ? (int64_t)lua_tonumber(L, 2) : -1;
+        if (lua_toboolean(L, 3)) {
+            movie->stream_progress->complete = true;
+        }
+    }
+    return 0;
+}
+
+static int waitingForData(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+
+    lua_pushboolean(L, movie->decoder && movie->decoder->isWaitingForData());
+    return 1;
+}
+
+// 内存占用（字节），framePool为所有影片共用的帧缓冲池
+static int memoryUsage(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    MemoryUsage usage;
+    if (movie->decoder) {
+        usage = movie->decoder->getMemoryUsage();
+    }
+    usage.texture_buffers = movie->rgba_memory.getBytes();
+    if (movie->yuv_planes) {
+        usage.texture_buffers += movie->yuv_planes->memory.getBytes();
+    }
+    if (movie->audio_streamer) {
+        usage.audio_queues += movie->audio_streamer->getMemoryUsage();
+    }
+
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, (lua_Number)usage.decoder_dpb);
+    lua_setfield(L, -2, "dpb");
+    lua_pushnumber(L, (lua_Number)usage.frame_pool);
+    lua_setfield(L, -2, "framePool");
+    lua_pushnumber(L, (lua_Number)usage.texture_buffers);
+    lua_setfield(L, -2, "rgba");
+    lua_pushnumber(L, (lua_Number)usage.demuxer_index);
+    lua_setfield(L, -2, "demuxerIndex");
+    lua_pushnumber(L, (lua_Number)usage.audio_queues);
+    lua_setfield(L, -2, "audioQueues");
+    lua_pushnumber(L, (lua_Number)usage.total());
+    lua_setfield(L, -2, "total");
+    return 1;
+}
+
+// 分阶段耗时统计：texture:getStats([reset])，按阶段名返回次数、耗时（毫秒）和直方图
+// 编译时关闭计时（PLUGIN_H264_ENABLE_PERF_STATS为0）时返回nil
+static int getStats(lua_State *L) {
+    H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
+
+    if (!PerfStats::isEnabled() || !movie->decoder) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    PerfStats& perf_stats = movie->decoder->getPerfStats();
+    lua_createtable(L, 0, static_cast<int>(PerfStage::COUNT));
+    for (int i = 0; i < static_cast<int>(PerfStage::COUNT); i++) {
+        PerfStage stage = static_cast<PerfStage>(i);
+        PerfStageStats stats = perf_stats.getStageStats(stage);
+
+        lua_createtable(L, 0, 8);
+        lua_pushnumber(L, (lua_Number)stats.count);
+        lua_setfield(L, -2, "count");
+        lua_pushnumber(L, (lua_Number)stats.total_ns / 1e6);
+        lua_setfield(L, -2, "totalMs");
+        lua_pushnumber(L, stats.getMeanMs());
+        lua_setfield(L, -2, "meanMs");
+        lua_pushnumber(L, (lua_Number)stats.max_ns / 1e6);
+        lua_setfield(L, -2, "maxMs");
+        lua_pushnumber(L, stats.getPercentileMs(0.5));
+        lua_setfield(L, -2, "p50Ms");
+        lua_pushnumber(L, stats.getPercentileMs(0.95));
+        lua_setfield(L, -2, "p95Ms");
+        lua_pushnumber(L, stats.getPercentileMs(0.99));
+        lua_setfield(L, -2, "p99Ms");
+
+        // 直方图：第k个元素为耗时小于2^(k-1)微秒的次数，最后一个元素不设上限
+        lua_createtable(L, PerfStageStats::kBucketCount, 0);
+        for (int bucket = 0; bucket < PerfStageStats::kBucketCount; bucket++) {
+            lua_pushnumber(L, (lua_Number)stats.buckets[bucket]);
+            lua_rawseti(L, -2, bucket + 1);
+        }
+        lua_setfield(L, -2, "histogram");
+
+        lua_setfield(L, -2, PerfStats::getStageName(stage));
+    }
+
+    if (lua_toboolean(L, 2)) {
+        perf_stats.reset();
+    }
+    return 1;
+}
+
+// 呈现调度统计：显示/丢弃/跳过解码/重复显示的帧数
+static int presentationStats(lua_State *L, void *context) {
+    H264MovieTexture *movie = (H264MovieTexture*)context;
+    PresentationStats stats;
+    if (movie->decoder) {
+        stats = movie->decoder->getPresentationStats();
+    }
+
+    lua_createtable(L, 0, 4);
+    lua_pushnumber(L, (lua_Number)stats.presented);
+    lua_setfield(L, -2, "presented");
+    lua_pushnumber(L, (lua_Number)stats.dropped);
+    lua_setfield(L, -2, "dropped");
+    lua_pushnumber(L, (lua_Number)stats.skipped);
+    lua_setfield(L, -2, "skipped");
+    lua_pushnumber(L, (lua_Number)stats.duplicated);
+    lua_setfield(L, -2, "duplicated");
+    return 1;
+}
+
 static int invalidate(lua_State *L) {
     // Solar2D 应该会自动检测纹理数据变化
     // 这个方法主要是为了兼容 plugin_movie 的 API
@@ -809,7 +1445,7 @@ static int currentTime(lua_State *L, void *context) {
     return 1;
 }
 
-// seek is not correctly implemented
+// seek：解复用器退回到目标之前最近的关键帧，解码并丢弃到目标时间，显示目标位置的帧
 static int seek(lua_State *L) {
     H264MovieTexture *movie = (H264MovieTexture*)CoronaExternalGetUserData(L, 1);
 
@@ -822,77 +1458,91 @@ static int seek(lua_State *L) {
         return 1;
     }
 
-    // 调用解码器 seek
-    bool seek_success = movie->decoder->seekTo(timestamp);
-    if (!seek_success) {
-        PLUGIN_H264_LOG( ("Decoder seek failed\n") );
+    // 停止音频（音频线程不能与seek并发解码），update 中会从新位置重新启动
+    if(movie->audiostarted) {
+        stopAudioStream(movie);
+        movie->audiostarted = false;
+        movie->audiocompleted = false;
+    }
+
+    if (!movie->decoder->seekTo(timestamp)) {
+        PLUGIN_H264_LOG( ("Decoder seek failed: %s\n", movie->decoder->getLastMessage().c_str()) );
         lua_pushboolean(L, false);
         return 1;
     }
 
-    // 更新播放时间位置
-    movie->elapsed = (unsigned int)(timestamp * 1000.0);
+    if (timestamp < 0.0) {
+        timestamp = 0.0;
+    }
+
+    // 保持 expected_time = elapsed - playback_start_time 的关系，让同步逻辑从目标时间继续
+    if (movie->playback_start_time <= 0.0) {
+        movie->playback_start_time = 0.001;
+    }
+    movie->elapsed = (unsigned int)((timestamp + movie->playback_start_time) * 1000.0);
+    movie->clock.reset(timestamp);
+    movie->last_audio_timestamp = 0.0;
+    movie->last_video_timestamp = timestamp;
 
     // 清空当前帧，强制获取新位置的帧
-    movie->current_video_frame = plugin_h264::VideoFrame();
+    setCurrentVideoFrame(movie, plugin_h264::VideoFrame());
     movie->current_audio_frame = plugin_h264::AudioFrame();
 
-    // 尝试解码新位置的第一帧，处理 B-frame 参考帧丢失问题
-    bool decode_success = false;
-    int decode_failures = 0;
+    // 解码目标位置的帧以便立即显示；多线程解码有输出延迟，可能需要多送几个样本
     const int max_decode_attempts = 10;
-
-    for (int attempt = 0; attempt < max_decode_attempts && !decode_success; attempt++) {
-        bool frame_decoded = movie->decoder->decodeNextFrame();
-
-        if (frame_decoded && movie->decoder->hasNewVideoFrame()) {
+    for (int attempt = 0; attempt < max_decode_attempts; attempt++) {
+        movie->decoder->decodeNextVideoFrame();
+        if (movie->decoder->hasNewVideoFrame()) {
             auto frame = movie->decoder->getCurrentVideoFrame();
-            if (frame.isValid() && frame.width > 0 && frame.height > 0) {
-                movie->current_video_frame = frame;
-                // 强制更新纹理
-                movie->rgba_data.clear();
-                decode_success = true;
-                PLUGIN_H264_LOG( ("Decoded valid frame: %.3fs (attempt %d)\n", frame.timestamp, attempt + 1) );
+            if (frame.isValid()) {
+                setCurrentVideoFrame(movie, frame);
+                movie->last_video_timestamp = frame.timestamp;
+                PLUGIN_H264_LOG( ("Decoded frame at %.3fs after seek (attempt %d)\n", frame.timestamp, attempt + 1) );
                 break;
             }
         }
-
-        if (!frame_decoded) {
-            decode_failures++;
-            // 如果连续解码失败，可能遇到了 B-frame 参考帧问题
-            if (decode_failures >= 3) {
-                PLUGIN_H264_LOG( ("Multiple decode failures (%d), seeking to nearby keyframe\n", decode_failures) );
-
-                // 向前寻找最近的关键帧位置（通常在GOP开始）
-                double keyframe_seek = timestamp - 1.0; // 向前1秒寻找关键帧
-                if (keyframe_seek < 0) keyframe_seek = 0;
-
-                if (movie->decoder->seekTo(keyframe_seek)) {
-                    PLUGIN_H264_LOG( ("Seeked to keyframe position: %.3fs\n", keyframe_seek) );
-                    // 更新 elapsed 到实际 seek 位置
-                    movie->elapsed = (unsigned int)(keyframe_seek * 1000.0);
-                    decode_failures = 0; // 重置失败计数
-                } else {
-                    PLUGIN_H264_LOG( ("Keyframe seek failed, continuing with current position\n") );
-                    break;
-                }
-            }
-        }
     }
 
-    if (!decode_success) {
-        PLUGIN_H264_LOG( ("Warning: Could not decode valid frame after %d attempts\n", max_decode_attempts) );
-    }
-
-    // 获取音频帧（如果有）
-    if (movie->decoder->hasNewAudioFrame()) {
-        movie->current_audio_frame = movie->decoder->getCurrentAudioFrame();
+    if (!movie->current_video_frame.isValid()) {
+        PLUGIN_H264_LOG( ("Warning: Could not decode a frame after seek\n") );
     }
 
     lua_pushboolean(L, true);
     return 1;
 }
 
+// 共用视频帧缓冲池的统计：命中/未命中次数、空闲字节、使用中字节、已分配字节高水位、空闲字节上限
+static int getFramePoolStats(lua_State *L) {
+    FrameBufferPoolStats stats = FrameBufferPool::shared().getStats();
+
+    lua_createtable(L, 0, 6);
+    lua_pushnumber(L, (lua_Number)stats.hits);
+    lua_setfield(L, -2, "hits");
+    lua_pushnumber(L, (lua_Number)stats.misses);
+    lua_setfield(L, -2, "misses");
+    lua_pushnumber(L, (lua_Number)stats.bytes_held);
+    lua_setfield(L, -2, "bytesHeld");
+    lua_pushnumber(L, (lua_Number)stats.bytes_in_use);
+    lua_setfield(L, -2, "bytesInUse");
+    lua_pushnumber(L, (lua_Number)stats.high_water);
+    lua_setfield(L, -2, "highWater");
+    lua_pushnumber(L, (lua_Number)stats.max_free_bytes);
+    lua_setfield(L, -2, "maxFreeBytes");
+    return 1;
+}
+
+// 共用视频帧缓冲池的空闲字节上限，降低时立即释放超出的空闲块；第二个参数为true时同时清零统计
+static int setFramePoolLimit(lua_State *L) {
+    lua_Number bytes = luaL_checknumber(L, 1);
+    FrameBufferPool& pool = FrameBufferPool::shared();
+
+    pool.setMaxFreeBytes(bytes > 0 ? (size_t)bytes : 0);
+    if (lua_toboolean(L, 2)) {
+        pool.resetStats();
+    }
+    return 0;
+}
+
 // Main plugin entry point
 CORONA_EXPORT int luaopen_plugin_h264(lua_State *L) {
     lua_CFunction factory = Corona::Lua::Open<CoronaPluginLuaLoad_plugin_h264>;
@@ -901,6 +1551,8 @@ CORONA_EXPORT int luaopen_plugin_h264(lua_State *L) {
     if(result) {
         const luaL_Reg kFunctions[] = {
             {"_newMovieTexture", newMovieTexture},
+            {"getFramePoolStats", getFramePoolStats},
+            {"setFramePoolLimit", setFramePoolLimit},
             {NULL, NULL}
         };
 
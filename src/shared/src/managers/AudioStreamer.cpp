@@ -0,0 +1,322 @@
+#include "../include/managers/AudioStreamer.h"
+#include "../include/managers/H264Movie.h"
+#include <algorithm>
+#include <chrono>
+
+namespace plugin_h264 {
+
+// 环形缓冲区大约容纳半秒PCM
+static const int kRingMilliseconds = 500;
+
+// 连续解码失败（损坏或无法解码的AAC包，或解码器无法配置）达到这个次数时按码流结束处理
+static const int kMaxConsecutiveDecodeFailures = 32;
+
+static void sleepPollInterval() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(AudioStreamer::kPollIntervalMs));
+}
+
+AudioPlaybackPosition::AudioPlaybackPosition()
+    : start_time_(0.0)
+    , sample_rate_(0)
+    , unqueued_frames_(0) {
+}
+
+void AudioPlaybackPosition::reset(double start_time, int sample_rate) {
+    start_time_ = start_time;
+    sample_rate_ = sample_rate;
+    unqueued_frames_ = 0;
+    queued_frames_.clear();
+}
+
+void AudioPlaybackPosition::queued(size_t frames) {
+    queued_frames_.push_back(frames);
+}
+
+void AudioPlaybackPosition::unqueued() {
+    if (!queued_frames_.empty()) {
+        unqueued_frames_ += queued_frames_.front();
+        queued_frames_.pop_front();
+    }
+}
+
+bool AudioPlaybackPosition::getTime(ALuint source, double& seconds) const {
+    if (sample_rate_ <= 0) {
+        return false;
+    }
+
+    ALint state = 0;
+    alGetSourcei(source, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING && state != AL_PAUSED) {
+        return false;
+    }
+
+    ALint offset = 0;
+    alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+    seconds = start_time_ + static_cast<double>(unqueued_frames_ + offset) / sample_rate_;
+    return true;
+}
+
+AudioStreamer::AudioStreamer(H264Movie* movie, ALuint source)
+    : movie_(movie)
+    , source_(source)
+    , buffers_created_(false)
+    , format_(0)
+    , sample_rate_(0)
+    , channels_(0)
+    , start_timestamp_(0.0)
+    , queued_samples_(0)
+    , al_buffer_bytes_(0)
+    , chunk_(TrackingAllocator<int16_t>(&memory_))
+    , position_valid_(false)
+    , stop_requested_(false)
+    , paused_(false)
+    , decoder_finished_(false)
+    , finished_(false)
+    , queued_time_(0.0) {
+    for (int i = 0; i < kNumBuffers; ++i) {
+        buffers_[i] = 0;
+    }
+}
+
+AudioStreamer::~AudioStreamer() {
+    stop();
+}
+
+bool AudioStreamer::start(AudioFrame&& first_frame) {
+    if (!movie_ || !first_frame.isValid()) {
+        setError(H264Error::INVALID_PARAM, "Invalid first audio frame");
+        return false;
+    }
+
+    stop();
+
+    sample_rate_ = first_frame.sample_rate;
+    channels_ = first_frame.channels;
+    format_ = (channels_ == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    start_timestamp_ = first_frame.timestamp;
+    queued_samples_ = 0;
+    queued_time_ = start_timestamp_;
+    position_.reset(start_timestamp_, sample_rate_);
+
+    size_t ring_samples = static_cast<size_t>(sample_rate_) * channels_ * kRingMilliseconds / 1000;
+    ring_.reset(new PCMRingBuffer(std::max<size_t>(ring_samples, kChunkFrames * channels_ * 2), &memory_));
+    chunk_.resize(kChunkFrames * channels_);
+    idle_buffers_.clear();
+
+    // 清除之前的错误并确保 source 处于初始状态
+    alGetError();
+    alSourceStop(source_);
+    alSourceRewind(source_);
+    alSourcei(source_, AL_BUFFER, 0);
+
+    alGenBuffers(kNumBuffers, buffers_);
+    ALenum error = alGetError();
+    if (error != AL_NO_ERROR) {
+        setError(H264Error::DECODER_INIT_FAILED, "Failed to generate audio buffers");
+        return false;
+    }
+    buffers_created_ = true;
+    // OpenAL在实现内部保存缓冲区数据，按每个缓冲区一个满块估算
+    al_buffer_bytes_ = static_cast<size_t>(kNumBuffers) * chunk_.size() * sizeof(int16_t);
+    position_valid_ = true;
+
+    stop_requested_ = false;
+    decoder_finished_ = false;
+    finished_ = false;
+
+    decode_thread_ = std::thread(&AudioStreamer::decodeLoop, this, std::move(first_frame));
+    feed_thread_ = std::thread(&AudioStreamer::feedLoop, this);
+
+    PLUGIN_H264_LOG( ("Audio streamer started: %d Hz, %d channels, ring=%zu samples\n",
+           sample_rate_, channels_, ring_->capacity()) );
+
+    clearError();
+    return true;
+}
+
+void AudioStreamer::stop() {
+    stop_requested_ = true;
+    position_valid_ = false;
+    if (decode_thread_.joinable()) {
+        decode_thread_.join();
+    }
+    if (feed_thread_.joinable()) {
+        feed_thread_.join();
+    }
+
+    if (buffers_created_) {
+        alSourceStop(source_);
+        alSourceRewind(source_);
+        alSourcei(source_, AL_BUFFER, 0);
+        alDeleteBuffers(kNumBuffers, buffers_);
+        buffers_created_ = false;
+        al_buffer_bytes_ = 0;
+    }
+}
+
+void AudioStreamer::pause() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    paused_ = true;
+    if (buffers_created_) {
+        alSourcePause(source_);
+    }
+}
+
+void AudioStreamer::resume() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    paused_ = false;
+    if (buffers_created_ && !finished_) {
+        alSourcePlay(source_);
+    }
+}
+
+bool AudioStreamer::isRunning() const {
+    return buffers_created_ && !finished_;
+}
+
+bool AudioStreamer::isFinished() const {
+    return finished_;
+}
+
+double AudioStreamer::getQueuedTime() const {
+    return queued_time_;
+}
+
+size_t AudioStreamer::getMemoryUsage() const {
+    return memory_.getBytes() + al_buffer_bytes_.load(std::memory_order_relaxed);
+}
+
+bool AudioStreamer::getAudibleTime(double& seconds) const {
+    if (!position_valid_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(position_mutex_);
+    return position_.getTime(source_, seconds);
+}
+
+void AudioStreamer::decodeLoop(AudioFrame frame) {
+    size_t offset = 0;
+    int decode_failures = 0;
+
+    while (!stop_requested_) {
+        if (offset >= frame.samples.size()) {
+            // 当前帧已全部写入，解码下一帧
+            if (!movie_->decodeNextAudioFrame()) {
+                if (movie_->isAudioTrackFinished()) {
+                    break;
+                }
+                if (movie_->isWaitingForData()) {
+                    decode_failures = 0;
+                    sleepPollInterval();
+                    continue;
+                }
+                // 坏包被跳过，下一次读取后面的样本；一直失败时不再空转
+                if (++decode_failures >= kMaxConsecutiveDecodeFailures) {
+                    PLUGIN_H264_LOG( ("Audio decode keeps failing, treating as end of stream\n") );
+                    break;
+                }
+                continue;
+            }
+            decode_failures = 0;
+            frame = movie_->takeCurrentAudioFrame();
+            offset = 0;
+        }
+
+        offset += ring_->write(frame.samples.data() + offset, frame.samples.size() - offset);
+
+        // 环形缓冲区已满，等待填充线程取走数据
+        if (offset < frame.samples.size()) {
+            sleepPollInterval();
+        }
+    }
+
+    decoder_finished_ = true;
+    PLUGIN_H264_LOG( ("Audio decode thread finished\n") );
+}
+
+size_t AudioStreamer::fillBuffer(ALuint buffer) {
+    // 解码未结束时只提交完整的块，避免过小的缓冲区造成欠载
+    size_t available = ring_->available();
+    if (available < chunk_.size() && !(decoder_finished_ && available > 0)) {
+        return 0;
+    }
+
+    PLUGIN_H264_PERF_SCOPE(&movie_->getPerfStats(), PerfStage::AUDIO_REFILL);
+    size_t count = ring_->read(chunk_.data(), chunk_.size());
+    count -= count % channels_;
+    if (count == 0) {
+        return 0;
+    }
+
+    alBufferData(buffer, format_, chunk_.data(),
+                 static_cast<ALsizei>(count * sizeof(int16_t)), sample_rate_);
+
+    queued_samples_ += count;
+    queued_time_ = start_timestamp_ + static_cast<double>(queued_samples_ / channels_) / sample_rate_;
+    return count / channels_;
+}
+
+void AudioStreamer::playIfNeeded() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (paused_) {
+        return;
+    }
+
+    ALint state = 0;
+    ALint queued = 0;
+    alGetSourcei(source_, AL_SOURCE_STATE, &state);
+    alGetSourcei(source_, AL_BUFFERS_QUEUED, &queued);
+
+    // 初次启动或欠载停止后重新播放
+    if (state != AL_PLAYING && queued > 0) {
+        alSourcePlay(source_);
+    }
+}
+
+void AudioStreamer::feedLoop() {
+    for (int i = 0; i < kNumBuffers; ++i) {
+        idle_buffers_.push_back(buffers_[i]);
+    }
+
+    while (!stop_requested_) {
+        // 回收已播放完的缓冲区
+        ALint processed = 0;
+        alGetSourcei(source_, AL_BUFFERS_PROCESSED, &processed);
+        while (processed > 0) {
+            ALuint buffer;
+            {
+                std::lock_guard<std::mutex> lock(position_mutex_);
+                alSourceUnqueueBuffers(source_, 1, &buffer);
+                position_.unqueued();
+            }
+            idle_buffers_.push_back(buffer);
+            --processed;
+        }
+
+        // 用环形缓冲区中的数据重新填充
+        size_t frames;
+        while (!idle_buffers_.empty() && (frames = fillBuffer(idle_buffers_.back())) > 0) {
+            {
+                std::lock_guard<std::mutex> lock(position_mutex_);
+                alSourceQueueBuffers(source_, 1, &idle_buffers_.back());
+                position_.queued(frames);
+            }
+            idle_buffers_.pop_back();
+        }
+
+        playIfNeeded();
+
+        // 全部数据已播放完毕
+        if (decoder_finished_ && ring_->available() == 0 &&
+            idle_buffers_.size() == static_cast<size_t>(kNumBuffers)) {
+            finished_ = true;
+            PLUGIN_H264_LOG( ("Audio stream finished at %.3fs\n", getQueuedTime()) );
+            break;
+        }
+
+        sleepPollInterval();
+    }
+}
+
+} // namespace plugin_h264
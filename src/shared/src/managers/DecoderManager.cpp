@@ -1,4 +1,5 @@
 #include "../include/managers/DecoderManager.h"
+#include "../include/decoders/DemuxerFactory.h"
 
 namespace plugin_h264 {
 
@@ -19,10 +20,9 @@ bool DecoderManager::initialize() {
     // 创建解码器实例
     h264_decoder_ = std::make_unique<H264Decoder>();
     aac_decoder_ = std::make_unique<AACDecoder>();
-    mp4_demuxer_ = std::make_unique<MP4Demuxer>();
     
     // 初始化解码器
-    if (!h264_decoder_->initialize()) {
+    if (!h264_decoder_->initialize(h264_config_)) {
         setError(H264Error::DECODER_INIT_FAILED, "Failed to initialize H264 decoder: " + h264_decoder_->getLastMessage());
         return false;
     }
@@ -37,6 +37,30 @@ bool DecoderManager::initialize() {
     return true;
 }
 
+bool DecoderManager::setH264DecoderConfig(const H264DecoderConfig& config) {
+    h264_config_ = config;
+
+    if (!initialized_ || !h264_decoder_) {
+        return true;
+    }
+
+    h264_decoder_->destroy();
+    if (!h264_decoder_->initialize(h264_config_)) {
+        setError(H264Error::DECODER_INIT_FAILED, "Failed to initialize H264 decoder: " + h264_decoder_->getLastMessage());
+        return false;
+    }
+
+    clearError();
+    return true;
+}
+
+void DecoderManager::setH264SkipPolicy(DecodeSkipPolicy policy) {
+    h264_config_.skip_policy = policy;
+    if (h264_decoder_) {
+        h264_decoder_->setSkipPolicy(policy);
+    }
+}
+
 bool DecoderManager::openFile(const std::string& file_path) {
     if (!initialized_) {
         if (!initialize()) {
@@ -48,9 +72,10 @@ bool DecoderManager::openFile(const std::string& file_path) {
         closeFile();
     }
     
-    // 打开MP4文件
-    if (!mp4_demuxer_->open(file_path)) {
-        setError(H264Error::FILE_OPEN_FAILED, "Failed to open MP4 file: " + mp4_demuxer_->getLastMessage());
+    std::string error;
+    demuxer_ = DemuxerFactory::open(file_path, demuxer_options_, error);
+    if (!demuxer_) {
+        setError(H264Error::FILE_OPEN_FAILED, error);
         return false;
     }
     
@@ -59,29 +84,66 @@ bool DecoderManager::openFile(const std::string& file_path) {
     return true;
 }
 
+bool DecoderManager::openSource(std::unique_ptr<ByteSource> source) {
+    if (!initialized_) {
+        if (!initialize()) {
+            return false;
+        }
+    }
+
+    if (file_open_) {
+        closeFile();
+    }
+
+    std::string error;
+    demuxer_ = DemuxerFactory::open(std::move(source), demuxer_options_, error);
+    if (!demuxer_) {
+        setError(H264Error::FILE_OPEN_FAILED, error);
+        return false;
+    }
+
+    file_open_ = true;
+    clearError();
+    return true;
+}
+
 void DecoderManager::closeFile() {
-    if (file_open_ && mp4_demuxer_) {
-        mp4_demuxer_->close();
+    if (file_open_ && demuxer_) {
+        demuxer_->close();
         file_open_ = false;
     }
 }
 
 bool DecoderManager::getFileInfo(std::vector<TrackInfo>& tracks, double& duration) const {
-    if (!file_open_ || !mp4_demuxer_) {
+    if (!file_open_ || !demuxer_) {
         return false;
     }
     
-    tracks = mp4_demuxer_->getTrackInfo();
-    duration = mp4_demuxer_->getDuration();
+    tracks = demuxer_->getTrackInfo();
+    duration = demuxer_->getDuration();
     return true;
 }
 
+MemoryUsage DecoderManager::getMemoryUsage() const {
+    MemoryUsage usage;
+    if (h264_decoder_) {
+        usage.decoder_dpb = h264_decoder_->getDPBMemoryUsage();
+    }
+    if (demuxer_) {
+        usage.demuxer_index = demuxer_->getIndexMemoryUsage();
+    }
+    if (aac_decoder_) {
+        usage.audio_queues = aac_decoder_->getMemoryUsage();
+    }
+    return usage;
+}
+
 void DecoderManager::destroy() {
     closeFile();
     
     h264_decoder_.reset();
     aac_decoder_.reset();
-    mp4_demuxer_.reset();
+    demuxer_.reset();
     
     initialized_ = false;
     clearError();
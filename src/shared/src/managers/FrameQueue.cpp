@@ -0,0 +1,187 @@
+#include "../include/managers/FrameQueue.h"
+#include <algorithm>
+#include <chrono>
+
+namespace plugin_h264 {
+
+void OwnedVideoFrame::copyFrom(const VideoFrame& source, FrameBufferPool& pool) {
+    if (source.isOwned()) {
+        frame = source;
+        return;
+    }
+
+    FrameBuffer buffer = pool.acquire(source.width, source.height);
+    buffer.copyFrom(source.y_plane, source.u_plane, source.v_plane, source.y_stride, source.uv_stride);
+
+    frame = source;
+    frame.setBuffer(std::move(buffer));
+}
+
+FrameQueue::FrameQueue(const FrameQueueConfig& config)
+    : config_(config)
+    , buffer_pool_(FrameBufferPool::shared())
+    , closed_(false)
+    , end_of_stream_(false)
+    , producer_paused_(false)
+    , dropped_frames_(0) {
+
+    // 规范化配置：1 <= low < high <= depth
+    config_.depth = std::max(1, config_.depth);
+    config_.high_watermark = std::min(std::max(1, config_.high_watermark), config_.depth);
+    config_.low_watermark = std::min(std::max(0, config_.low_watermark), config_.high_watermark - 1);
+    config_.pop_timeout_ms = std::max(0, config_.pop_timeout_ms);
+
+    // 预分配全部槽位：队列中的帧 + 正在写入的一帧 + 消费者持有的一帧
+    for (int i = 0; i < config_.depth + 2; ++i) {
+        free_.push_back(std::unique_ptr<OwnedVideoFrame>(new OwnedVideoFrame()));
+    }
+}
+
+OwnedVideoFrame* FrameQueue::beginPush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // 水位滞回：达到高水位后暂停，直到降到低水位才恢复
+    if (static_cast<int>(ready_.size()) >= config_.high_watermark) {
+        producer_paused_ = true;
+    }
+    if (producer_paused_) {
+        space_cv_.wait(lock, [this] {
+            return closed_ || static_cast<int>(ready_.size()) <= config_.low_watermark;
+        });
+        producer_paused_ = false;
+    }
+
+    if (closed_ || writing_ || free_.empty()) {
+        return nullptr;
+    }
+
+    writing_ = std::move(free_.back());
+    free_.pop_back();
+    return writing_.get();
+}
+
+void FrameQueue::endPush(OwnedVideoFrame* slot, bool commit) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!writing_ || writing_.get() != slot) {
+            return;
+        }
+        if (commit && !closed_) {
+            ready_.push_back(std::move(writing_));
+        } else {
+            recycleLocked(std::move(writing_));
+        }
+    }
+    frame_cv_.notify_one();
+}
+
+void FrameQueue::setEndOfStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        end_of_stream_ = true;
+    }
+    frame_cv_.notify_all();
+}
+
+const VideoFrame* FrameQueue::popDue(double due_time) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return popLocked(lock, due_time, true, -1);
+}
+
+const VideoFrame* FrameQueue::popNext(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return popLocked(lock, 0.0, false, timeout_ms);
+}
+
+const VideoFrame* FrameQueue::popLocked(std::unique_lock<std::mutex>& lock, double due_time,
+                                        bool check_due, int timeout_ms) {
+    if (timeout_ms < 0) {
+        timeout_ms = config_.blocking_pop ? config_.pop_timeout_ms : 0;
+    }
+
+    if (ready_.empty() && timeout_ms > 0) {
+        frame_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+            return closed_ || end_of_stream_ || !ready_.empty();
+        });
+    }
+
+    if (ready_.empty()) {
+        return nullptr;
+    }
+
+    if (check_due && ready_.front()->frame.timestamp > due_time) {
+        return nullptr; // 队首帧尚未到期
+    }
+
+    std::unique_ptr<OwnedVideoFrame> frame = std::move(ready_.front());
+    ready_.pop_front();
+
+    // 已经过期的中间帧直接丢弃，只保留最新的到期帧
+    if (check_due) {
+        while (!ready_.empty() && ready_.front()->frame.timestamp <= due_time) {
+            recycleLocked(std::move(frame));
+            frame = std::move(ready_.front());
+            ready_.pop_front();
+            ++dropped_frames_;
+        }
+    }
+
+    if (presented_) {
+        recycleLocked(std::move(presented_));
+    }
+    presented_ = std::move(frame);
+
+    lock.unlock();
+    space_cv_.notify_one();
+    return &presented_->frame;
+}
+
+void FrameQueue::recycleLocked(std::unique_ptr<OwnedVideoFrame> slot) {
+    // 放弃本槽的引用，没有其他副本时缓冲区回到池中
+    slot->frame = VideoFrame();
+    free_.push_back(std::move(slot));
+}
+
+void FrameQueue::flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!ready_.empty()) {
+            recycleLocked(std::move(ready_.front()));
+            ready_.pop_front();
+        }
+        end_of_stream_ = false;
+    }
+    space_cv_.notify_all();
+}
+
+void FrameQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    space_cv_.notify_all();
+    frame_cv_.notify_all();
+}
+
+void FrameQueue::reopen() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+    producer_paused_ = false;
+}
+
+size_t FrameQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_.size();
+}
+
+bool FrameQueue::isEndOfStream() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return end_of_stream_ && ready_.empty();
+}
+
+unsigned int FrameQueue::getDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_frames_;
+}
+
+} // namespace plugin_h264
@@ -1,48 +1,20 @@
 #include "../include/managers/H264Movie.h"
-#include "../include/decoders/MP4Demuxer.h"
+#include "../include/decoders/Demuxer.h"
+#include "../include/utils/NALConverter.h"
+#include "../include/utils/SPSParser.h"
+#include <algorithm>
+#include <chrono>
 
 namespace plugin_h264 {
 
-// 辅助函数：将AVCC格式转换为Annex-B格式
-// std::vector<uint8_t> convertAVCCToAnnexB(const std::vector<uint8_t>& avcc_data, int nal_length_size = 4) {
-//     std::vector<uint8_t> annexb_data;
+// 刚加载或seek后还没有可显示的帧时，最多等待解码线程的时间
+static const int kFirstFrameTimeoutMs = 500;
 
-//     if (avcc_data.size() < nal_length_size) {
-//         return annexb_data; // 数据太短，无效
-//     }
+// seek丢帧时的时间戳容差（解码器时间戳以微秒取整）
+static const double kSeekToleranceSeconds = 0.001;
 
-//     size_t offset = 0;
-//     while (offset + nal_length_size <= avcc_data.size()) {
-//         // 读取NAL单元长度（大端序）
-//         uint32_t nal_length = 0;
-//         for (int i = 0; i < nal_length_size; ++i) {
-//             nal_length = (nal_length << 8) | avcc_data[offset + i];
-//         }
-
-//         offset += nal_length_size;
-
-//         // 检查长度是否有效
-//         if (nal_length == 0 || offset + nal_length > avcc_data.size()) {
-//             PLUGIN_H264_LOG( ("Invalid NAL length: %u, remaining data: %zu\n", nal_length, avcc_data.size() - offset) );
-//             break; // 无效长度，停止处理
-//         }
-
-//         // 添加Annex-B起始码
-//         annexb_data.insert(annexb_data.end(), {0x00, 0x00, 0x00, 0x01});
-
-//         // 添加NAL单元数据
-//         annexb_data.insert(annexb_data.end(),
-//                           avcc_data.begin() + offset,
-//                           avcc_data.begin() + offset + nal_length);
-
-//         PLUGIN_H264_LOG( ("Converted NAL unit: length=%u, type=0x%02X\n", nal_length,
-//                nal_length > 0 ? avcc_data[offset] & 0x1F : 0) );
-
-//         offset += nal_length;
-//     }
-
-//     return annexb_data;
-// }
+// 边下载边播放时解码线程等待数据写入的间隔
+static const int kWaitForDataMs = 10;
 
 H264Movie::H264Movie()
     : is_loaded_(false)
@@ -52,8 +24,12 @@ H264Movie::H264Movie()
     , has_new_audio_frame_(false)
     , video_track_finished_(false)
     , audio_track_finished_(false)
+    , seek_target_(-1.0)
+    , decode_late_(false)
     , sps_pps_sent_(false)
-    , aac_configured_(false) {
+    , aac_configured_(false)
+    , nal_length_size_(4)
+    , decode_thread_stop_(false) {
 
     decoder_manager_ = std::make_unique<DecoderManager>();
 }
@@ -62,6 +38,25 @@ H264Movie::~H264Movie() {
     stop();
 }
 
+bool H264Movie::setDecoderConfig(const H264DecoderConfig& config) {
+    if (is_loaded_) {
+        setError(H264Error::INVALID_PARAM, "Decoder config must be set before loading");
+        return false;
+    }
+
+    if (!decoder_manager_->setH264DecoderConfig(config)) {
+        setError(H264Error::DECODER_INIT_FAILED, decoder_manager_->getLastMessage());
+        return false;
+    }
+
+    clearError();
+    return true;
+}
+
+void H264Movie::setStreamFrameRate(double fps) {
+    decoder_manager_->setStreamFrameRate(fps);
+}
+
 bool H264Movie::loadFromFile(const std::string& file_path) {
     if (is_loaded_) {
         stop();
@@ -73,53 +68,66 @@ bool H264Movie::loadFromFile(const std::string& file_path) {
         return false;
     }
 
+    return finishLoad();
+}
+
+bool H264Movie::loadFromMemory(const uint8_t* data, size_t size, MemoryOwnership ownership) {
+    if (is_loaded_) {
+        stop();
+    }
+
+    std::unique_ptr<MemorySource> source(new MemorySource());
+    if (!source->open(data, size, ownership)) {
+        setError(H264Error::INVALID_PARAM, "Failed to open memory buffer: " + source->getLastMessage());
+        return false;
+    }
+
+    if (!decoder_manager_->openSource(std::move(source))) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to load movie from memory: " + decoder_manager_->getLastMessage());
+        return false;
+    }
+
+    return finishLoad();
+}
+
+bool H264Movie::loadFromStream(const std::string& file_path, GrowingFileSource::BytesAvailableCallback bytes_available) {
+    if (is_loaded_) {
+        stop();
+    }
+
+    std::unique_ptr<GrowingFileSource> source(new GrowingFileSource());
+    if (!source->open(file_path, bytes_available)) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open stream: " + source->getLastMessage());
+        return false;
+    }
+
+    if (!decoder_manager_->openSource(std::move(source))) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to load stream: " + decoder_manager_->getLastMessage());
+        return false;
+    }
+
+    return finishLoad();
+}
+
+bool H264Movie::finishLoad() {
     // 获取文件信息
     if (!decoder_manager_->getFileInfo(tracks_, duration_)) {
         setError(H264Error::UNSUPPORTED_FORMAT, "Failed to get movie info");
         return false;
     }
 
+    // 解析活动轨道，之后逐帧解码只使用缓存的描述
+    auto demuxer = decoder_manager_->getDemuxer();
+    video_track_ = TrackDescriptor();
+    audio_track_ = TrackDescriptor();
+    if (demuxer) {
+        demuxer->findTrack(MP4TrackType::VIDEO, CodecType::H264, video_track_);
+        demuxer->findTrack(MP4TrackType::AUDIO, CodecType::AAC, audio_track_);
+    }
+
     // 预配置H264解码器的SPS/PPS
-    auto h264_decoder = decoder_manager_->getH264Decoder();
-    auto demuxer = decoder_manager_->getMP4Demuxer();
-
-    if (h264_decoder && demuxer) {
-        // 查找H264视频轨道
-        for (const auto& track : tracks_) {
-            if (track.type == MP4TrackType::VIDEO && track.codec == CodecType::H264) {
-                std::vector<uint8_t> sps_data, pps_data;
-                if (demuxer->extractSPS(track.track_id, sps_data) &&
-                    demuxer->extractPPS(track.track_id, pps_data)) {
-
-                    PLUGIN_H264_LOG( ("Pre-configuring H264 decoder with SPS (size: %zu) and PPS (size: %zu)\n",
-                           sps_data.size(), pps_data.size()) );
-
-                    // 为SPS添加NAL起始码
-                    std::vector<uint8_t> sps_nal;
-                    sps_nal.insert(sps_nal.end(), {0x00, 0x00, 0x00, 0x01});
-                    sps_nal.insert(sps_nal.end(), sps_data.begin(), sps_data.end());
-
-                    // 为PPS添加NAL起始码
-                    std::vector<uint8_t> pps_nal;
-                    pps_nal.insert(pps_nal.end(), {0x00, 0x00, 0x00, 0x01});
-                    pps_nal.insert(pps_nal.end(), pps_data.begin(), pps_data.end());
-
-                    // 发送SPS和PPS到解码器
-                    VideoFrame dummy_frame;
-                    bool sps_result = h264_decoder->decode(sps_nal.data(), sps_nal.size(), dummy_frame);
-                    bool pps_result = h264_decoder->decode(pps_nal.data(), pps_nal.size(), dummy_frame);
-
-                    if (sps_result && pps_result) {
-                        PLUGIN_H264_LOG( ("H264 decoder pre-configuration successful\n") );
-                        sps_pps_sent_ = true;
-                    } else {
-                        PLUGIN_H264_LOG( ("H264 decoder pre-configuration failed: SPS=%s, PPS=%s\n",
-                               sps_result ? "OK" : "FAIL", pps_result ? "OK" : "FAIL") );
-                    }
-                }
-                break; // 只处理第一个H264轨道
-            }
-        }
+    if (video_track_.isValid() && sendParameterSets()) {
+        sps_pps_sent_ = true;
     }
 
     is_loaded_ = true;
@@ -127,6 +135,37 @@ bool H264Movie::loadFromFile(const std::string& file_path) {
     return true;
 }
 
+bool H264Movie::sendParameterSets() {
+    auto h264_decoder = decoder_manager_->getH264Decoder();
+    if (!h264_decoder || !video_track_.isValid()) {
+        return false;
+    }
+
+    const CodecConfig& config = video_track_.config;
+    nal_length_size_ = config.nal_length_size;
+
+    // 参数集加上起始码后送入解码器（裸码流的访问单元中也带有参数集）
+    bool result = !config.parameter_sets.empty();
+    std::vector<uint8_t> nal;
+    VideoFrame dummy_frame;
+    for (const auto& parameter_set : config.parameter_sets) {
+        // SPS中的参考帧数决定解码器DPB的大小，用于内存统计
+        SPSInfo sps;
+        if (SPSParser::parse(parameter_set.data(), parameter_set.size(), sps)) {
+            h264_decoder->setReferenceFrames(sps.max_num_ref_frames);
+        }
+        nal.assign({0x00, 0x00, 0x00, 0x01});
+        nal.insert(nal.end(), parameter_set.begin(), parameter_set.end());
+        if (!h264_decoder->decode(nal.data(), nal.size(), dummy_frame)) {
+            result = false;
+        }
+    }
+
+    PLUGIN_H264_LOG( ("H264 decoder parameter sets (%zu): %s\n",
+           config.parameter_sets.size(), result ? "OK" : "FAIL") );
+    return result;
+}
+
 bool H264Movie::play() {
     if (!is_loaded_) {
         setError(H264Error::DECODER_INIT_FAILED, "Movie not loaded");
@@ -152,6 +191,9 @@ bool H264Movie::pause() {
 bool H264Movie::stop() {
     is_playing_ = false;
 
+    // 先停止解码线程，再关闭文件
+    disableAsyncDecode();
+
     if (is_loaded_ && decoder_manager_) {
         decoder_manager_->closeFile();
     }
@@ -159,6 +201,8 @@ bool H264Movie::stop() {
     is_loaded_ = false;
     duration_ = 0.0;
     tracks_.clear();
+    video_track_ = TrackDescriptor();
+    audio_track_ = TrackDescriptor();
 
     has_new_video_frame_ = false;
     has_new_audio_frame_ = false;
@@ -166,6 +210,15 @@ bool H264Movie::stop() {
     audio_track_finished_ = false;
     sps_pps_sent_ = false;
     aac_configured_ = false;
+    seek_target_ = -1.0;
+    presentation_stats_ = PresentationStats();
+    if (decoder_manager_ && decoder_manager_->getH264Decoder()) {
+        decoder_manager_->getH264Decoder()->setLate(false);
+        decoder_manager_->getH264Decoder()->resetSkipStats();
+    }
+    nal_length_size_ = 4;
+    std::vector<uint8_t>().swap(sample_buffer_);
+    std::vector<uint8_t>().swap(annexb_buffer_);
 
     clearError();
     return true;
@@ -186,6 +239,9 @@ bool H264Movie::replay() {
     // 只停止播放，不关闭文件
     is_playing_ = false;
 
+    // 重置解码器前必须先停止解码线程
+    bool resume_thread = stopDecodeThread();
+
     // 重置所有解码状态，但保持文件加载状态
     has_new_video_frame_ = false;
     has_new_audio_frame_ = false;
@@ -218,7 +274,12 @@ bool H264Movie::replay() {
     }
 
     // 重置到文件开头
-    if (!seekTo(0.0)) {
+    bool seek_result = seekTo(0.0);
+    if (resume_thread) {
+        startDecodeThread();
+    }
+
+    if (!seek_result) {
         setError(H264Error::DECODE_FAILED, "Failed to seek to beginning for replay");
         return false;
     }
@@ -237,7 +298,9 @@ bool H264Movie::replay() {
 }
 
 double H264Movie::getDuration() const {
-    return duration_;
+    // 分片MP4的时长随下载增长
+    auto demuxer = is_loaded_ ? decoder_manager_->getDemuxer() : nullptr;
+    return demuxer ? demuxer->getDuration() : duration_;
 }
 
 double H264Movie::getCurrentTime() const {
@@ -245,7 +308,8 @@ double H264Movie::getCurrentTime() const {
         return 0.0;
     }
 
-    auto demuxer = decoder_manager_->getMP4Demuxer();
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    auto demuxer = decoder_manager_->getDemuxer();
     return demuxer ? demuxer->getCurrentTime() : 0.0;
 }
 
@@ -258,15 +322,15 @@ bool H264Movie::hasNewAudioFrame() const {
 }
 
 bool H264Movie::hasAudioTrack() const {
-    for (const auto& track : tracks_) {
-        if (track.type == MP4TrackType::AUDIO) {
-            return true;
-        }
-    }
-    return false;
+    // 逐帧调用，使用加载时解析好的音频轨道
+    return audio_track_.isValid();
 }
 
 bool H264Movie::isVideoTrackFinished() const {
+    // 异步模式下还要等队列中的帧全部取出
+    if (frame_queue_) {
+        return video_track_finished_ && frame_queue_->size() == 0;
+    }
     return video_track_finished_;
 }
 
@@ -276,7 +340,7 @@ bool H264Movie::isAudioTrackFinished() const {
 
 bool H264Movie::isPlaybackFinished() const {
     // 视频轨道必须完成
-    bool video_done = video_track_finished_;
+    bool video_done = isVideoTrackFinished();
 
     // 如果有音频轨道，音频也必须完成
     bool audio_done = !hasAudioTrack() || audio_track_finished_;
@@ -289,9 +353,9 @@ VideoFrame H264Movie::getCurrentVideoFrame() {
     return current_video_frame_;
 }
 
-AudioFrame H264Movie::getCurrentAudioFrame() {
+AudioFrame H264Movie::takeCurrentAudioFrame() {
     has_new_audio_frame_ = false;
-    return current_audio_frame_;
+    return std::move(current_audio_frame_);
 }
 
 bool H264Movie::decodeNextFrame() {
@@ -316,126 +380,293 @@ bool H264Movie::decodeNextVideoFrame() {
         return false;
     }
 
-    auto demuxer = decoder_manager_->getMP4Demuxer();
-    auto h264_decoder = decoder_manager_->getH264Decoder();
+    // 如果已经有新的视频帧，不需要解码
+    if (has_new_video_frame_) {
+        return true;
+    }
+
+    // 异步模式：直接从队列取下一帧
+    if (frame_queue_) {
+        int timeout_ms = current_video_frame_.isValid() ? -1 : kFirstFrameTimeoutMs;
+        const VideoFrame* frame = frame_queue_->popNext(timeout_ms);
+        if (!frame) {
+            return false;
+        }
+        current_video_frame_ = *frame;
+        has_new_video_frame_ = true;
+
+        // 音频线程在锁内写错误信息；等待队列时不能持锁，否则解码线程无法生产
+        std::lock_guard<std::mutex> lock(decode_mutex_);
+        clearError();
+        return true;
+    }
 
-    if (!demuxer || !h264_decoder) {
+    if (!decoder_manager_->getDemuxer() || !decoder_manager_->getH264Decoder()) {
         setError(H264Error::DECODER_INIT_FAILED, "Video decoder not available");
         return false;
     }
 
-    // 如果已经有新的视频帧，不需要解码
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+    VideoFrame video_frame;
+    if (decodeVideoSample(video_frame)) {
+        current_video_frame_ = video_frame;
+        has_new_video_frame_ = true;
+        clearError();
+        return true;
+    }
+
+    return false;
+}
+
+bool H264Movie::popDueVideoFrame(double due_time) {
+    if (!frame_queue_) {
+        return decodeNextVideoFrame();
+    }
+
     if (has_new_video_frame_) {
         return true;
     }
 
-    // 获取轨道信息
-    auto track_info = demuxer->getTrackInfo();
+    const VideoFrame* frame = frame_queue_->popDue(due_time);
+    if (!frame) {
+        return false;
+    }
+
+    current_video_frame_ = *frame;
+    has_new_video_frame_ = true;
+    return true;
+}
+
+bool H264Movie::presentVideoFrame(double clock_time) {
+    if (!is_loaded_ || !decoder_manager_) {
+        setError(H264Error::DECODER_INIT_FAILED, "Movie not loaded");
+        return false;
+    }
+
+    // 上一次调度出的帧还没有取走
+    if (has_new_video_frame_) {
+        return true;
+    }
 
-    for (size_t i = 0; i < track_info.size(); ++i) {
-        const auto& track = track_info[i];
-        if (track.type == MP4TrackType::VIDEO && track.codec == CodecType::H264) {
+    // 异步模式：解码线程已经提前解好，过期的中间帧在队列中丢弃
+    if (frame_queue_) {
+        unsigned int dropped_before = frame_queue_->getDroppedFrames();
+        bool presented = popDueVideoFrame(clock_time);
+        presentation_stats_.dropped += frame_queue_->getDroppedFrames() - dropped_before;
+
+        // 到期时队列已空说明解码线程跟不上，让它按跳帧策略追赶
+        updateDecoderLate(!presented && frame_queue_->size() == 0 && !video_track_finished_);
+        if (presented) {
+            presentation_stats_.presented++;
+        } else if (current_video_frame_.isValid()) {
+            presentation_stats_.duplicated++;
+        }
+        return presented;
+    }
 
-            // 优化：只在第一次或seek后需要发送SPS/PPS
-            if (!sps_pps_sent_) {
-                std::vector<uint8_t> sps_data, pps_data;
-                if (demuxer->extractSPS(track.track_id, sps_data) &&
-                    demuxer->extractPPS(track.track_id, pps_data)) {
+    auto demuxer = decoder_manager_->getDemuxer();
+    if (!demuxer || !decoder_manager_->getH264Decoder() || !video_track_.isValid()) {
+        setError(H264Error::DECODER_INIT_FAILED, "Video decoder not available");
+        return false;
+    }
 
-                    PLUGIN_H264_LOG( ("Sending SPS (size: %zu) and PPS (size: %zu) to decoder\n", sps_data.size(), pps_data.size()) );
+    std::lock_guard<std::mutex> lock(decode_mutex_);
 
-                    // 为SPS添加NAL起始码
-                    std::vector<uint8_t> sps_nal;
-                    sps_nal.reserve(sps_data.size() + 4);
-                    sps_nal.insert(sps_nal.end(), {0x00, 0x00, 0x00, 0x01});
-                    sps_nal.insert(sps_nal.end(), sps_data.begin(), sps_data.end());
+    // 下一个样本还没到期，继续显示当前帧
+    double sample_time;
+    if (current_video_frame_.isValid() && peekVideoSampleTime(0, sample_time) &&
+        sample_time > clock_time + kSeekToleranceSeconds) {
+        presentation_stats_.duplicated++;
+        return false;
+    }
 
-                    // 为PPS添加NAL起始码
-                    std::vector<uint8_t> pps_nal;
-                    pps_nal.reserve(pps_data.size() + 4);
-                    pps_nal.insert(pps_nal.end(), {0x00, 0x00, 0x00, 0x01});
-                    pps_nal.insert(pps_nal.end(), pps_data.begin(), pps_data.end());
+    // 后一个样本也已到期时，这个样本不会被显示：落后期间由跳帧策略决定是否送入解码器，解码出的帧丢弃
+    auto h264_decoder = decoder_manager_->getH264Decoder();
+    uint64_t skipped_before = h264_decoder->getSkipStats().total();
+    VideoFrame frame;
+    while (peekVideoSampleTime(1, sample_time) && sample_time <= clock_time + kSeekToleranceSeconds) {
+        updateDecoderLate(true);
+        size_t sample_number = demuxer->getNextSampleNumber(video_track_.info.track_id);
+        if (decodeVideoAccessUnit(frame)) {
+            presentation_stats_.dropped++;
+        }
+        if (demuxer->getNextSampleNumber(video_track_.info.track_id) == sample_number) {
+            break; // 读取失败，避免死循环
+        }
+    }
+    updateDecoderLate(false);
 
-                    // 发送SPS和PPS到解码器
-                    VideoFrame dummy_frame;
-                    bool sps_result = h264_decoder->decode(sps_nal.data(), sps_nal.size(), dummy_frame);
-                    bool pps_result = h264_decoder->decode(pps_nal.data(), pps_nal.size(), dummy_frame);
+    bool decoded = decodeVideoSample(frame);
+    presentation_stats_.skipped += h264_decoder->getSkipStats().total() - skipped_before;
+    if (!decoded) {
+        if (current_video_frame_.isValid()) {
+            presentation_stats_.duplicated++;
+        }
+        return false;
+    }
 
-                    PLUGIN_H264_LOG( ("SPS decode result: %s, PPS decode result: %s\n",
-                           sps_result ? "success" : "failed",
-                           pps_result ? "success" : "failed") );
+    current_video_frame_ = frame;
+    has_new_video_frame_ = true;
+    presentation_stats_.presented++;
+    clearError();
+    return true;
+}
 
-                    sps_pps_sent_ = true;
-                }
-            }
+void H264Movie::updateDecoderLate(bool behind) {
+    auto h264_decoder = decoder_manager_ ? decoder_manager_->getH264Decoder() : nullptr;
+    if (h264_decoder) {
+        h264_decoder->setLate(behind || decode_late_);
+    }
+}
 
-            MP4Sample sample;
-            if (demuxer->readNextSample(track.track_id, sample)) {
-                // 优化：预分配缓冲区大小，避免动态扩展
-                std::vector<uint8_t> annexb_frame;
-                annexb_frame.reserve(sample.data.size() + 64); // 预留额外空间给起始码
-                
-                size_t offset = 0;
-                while (offset < sample.data.size()) {
-                    if (offset + 4 > sample.data.size()) break;
-
-                    // 读取NAL单元长度（大端序）
-                    uint32_t nal_length = (sample.data[offset] << 24) |
-                                         (sample.data[offset + 1] << 16) |
-                                         (sample.data[offset + 2] << 8) |
-                                         sample.data[offset + 3];
-
-                    offset += 4;
-
-                    if (nal_length > sample.data.size() - offset) break;
-
-                    // 使用push_back批量添加，比insert更高效
-                    annexb_frame.push_back(0x00);
-                    annexb_frame.push_back(0x00);
-                    annexb_frame.push_back(0x00);
-                    annexb_frame.push_back(0x01);
-                    
-                    // 添加NAL单元数据
-                    annexb_frame.insert(annexb_frame.end(),
-                                       sample.data.begin() + offset,
-                                       sample.data.begin() + offset + nal_length);
-
-                    offset += nal_length;
-                }
+void H264Movie::setDecodeLate(bool late) {
+    decode_late_ = late;
+    updateDecoderLate(false);
+}
 
-                // 检查NAL单元类型
-                uint8_t nal_type = (annexb_frame.size() > 4) ? (annexb_frame[4] & 0x1F) : 0;
-                PLUGIN_H264_LOG( ("NAL unit type: 0x%02X (%s)\n", nal_type,
-                       nal_type == 5 ? "IDR" :
-                       nal_type == 1 ? "P-frame" :
-                       nal_type == 7 ? "SPS" :
-                       nal_type == 8 ? "PPS" : "Other") );
-
-                VideoFrame video_frame;
-                if (h264_decoder->decode(annexb_frame.data(), annexb_frame.size(), video_frame)) {
-                    current_video_frame_ = video_frame;
-
-                    // 正确转换时间戳：统一使用轨道的timescale
-                    if (track.timescale > 0) {
-                        current_video_frame_.timestamp = static_cast<double>(sample.timestamp) / track.timescale;
-                    } else {
-                        // 如果没有timescale信息，假设90kHz（H.264常用）
-                        current_video_frame_.timestamp = static_cast<double>(sample.timestamp) / 90000.0;
-                    }
-
-                    PLUGIN_H264_LOG( ("Video frame timestamp: %u -> %.3fs (timescale: %u)\n",
-                           sample.timestamp, current_video_frame_.timestamp, track.timescale) );
-
-                    has_new_video_frame_ = true;
-                    clearError();
-                    return true;
+bool H264Movie::setDecodeSkipPolicy(DecodeSkipPolicy policy) {
+    if (!decoder_manager_) {
+        setError(H264Error::DECODER_INIT_FAILED, "Decoder manager not available");
+        return false;
+    }
+
+    decoder_manager_->setH264SkipPolicy(policy);
+    clearError();
+    return true;
+}
+
+DecodeSkipPolicy H264Movie::getDecodeSkipPolicy() const {
+    return decoder_manager_ ? decoder_manager_->getH264DecoderConfig().skip_policy : DecodeSkipPolicy::NONE;
+}
+
+DecodeSkipStats H264Movie::getDecodeSkipStats() const {
+    auto h264_decoder = decoder_manager_ ? decoder_manager_->getH264Decoder() : nullptr;
+    return h264_decoder ? h264_decoder->getSkipStats() : DecodeSkipStats();
+}
+
+MemoryUsage H264Movie::getMemoryUsage() const {
+    MemoryUsage usage;
+    {
+        std::lock_guard<std::mutex> lock(decode_mutex_);
+        if (decoder_manager_) {
+            usage = decoder_manager_->getMemoryUsage();
+        }
+    }
+
+    FrameBufferPoolStats pool_stats = FrameBufferPool::shared().getStats();
+    usage.frame_pool = pool_stats.bytes_held + pool_stats.bytes_in_use;
+    return usage;
+}
+
+bool H264Movie::isWaitingForData() const {
+    auto demuxer = is_loaded_ ? decoder_manager_->getDemuxer() : nullptr;
+    return demuxer && demuxer->isWaitingForData();
+}
+
+bool H264Movie::peekVideoSampleTime(size_t ahead, double& seconds) const {
+    auto demuxer = decoder_manager_->getDemuxer();
+    if (!demuxer || !video_track_.isValid()) {
+        return false;
+    }
+
+    const SampleIndex* index = demuxer->getSampleIndex(video_track_.info.track_id);
+    size_t sample = demuxer->getNextSampleNumber(video_track_.info.track_id) + ahead;
+    if (!index || sample >= index->count()) {
+        return false;
+    }
+
+    seconds = video_track_.toSeconds(index->timestamps[sample]);
+    return true;
+}
+
+bool H264Movie::decodeVideoSample(VideoFrame& frame) {
+    while (decodeVideoAccessUnit(frame)) {
+        // 从同步样本到目标时间之间的帧只用于建立参考帧，不显示
+        if (seek_target_ < 0.0 || frame.timestamp + kSeekToleranceSeconds >= seek_target_) {
+            seek_target_ = -1.0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool H264Movie::decodeVideoAccessUnit(VideoFrame& frame) {
+    auto demuxer = decoder_manager_->getDemuxer();
+    auto h264_decoder = decoder_manager_->getH264Decoder();
+
+    if (!demuxer || !h264_decoder || !video_track_.isValid()) {
+        return false;
+    }
+
+    // 优化：只在第一次或seek后需要发送SPS/PPS
+    if (!sps_pps_sent_) {
+        sendParameterSets();
+        sps_pps_sent_ = true;
+    }
+
+    MP4SampleView sample;
+    bool has_sample;
+    {
+        PLUGIN_H264_PERF_SCOPE(&perf_stats_, PerfStage::DEMUX);
+        has_sample = demuxer->readNextSampleInto(video_track_.info.track_id, sample_buffer_, sample);
+    }
+    if (has_sample) {
+        // 4字节长度前缀与起始码等长，原地改写；1/2字节前缀需要转换到另一个缓冲区；
+        // 0表示样本本身就是Annex-B（裸码流），直接送入解码器
+        uint8_t* annexb_frame = sample_buffer_.data();
+        size_t annexb_size = sample.size;
+        if (nal_length_size_ != 0) {
+            PLUGIN_H264_PERF_SCOPE(&perf_stats_, PerfStage::AVCC_CONVERT);
+            if (nal_length_size_ == 4) {
+                if (!NALConverter::rewriteInPlace(annexb_frame, annexb_size)) {
+                    annexb_size = 0;
                 }
             } else {
-                // 无法读取更多视频样本，视频轨道已完成
-                video_track_finished_ = true;
-                PLUGIN_H264_LOG( ("Video track finished - no more samples available\n") );
+                size_t needed = NALConverter::annexBSize(sample.data, sample.size, nal_length_size_);
+                if (annexb_buffer_.size() < needed) {
+                    annexb_buffer_.resize(needed);
+                }
+                annexb_frame = annexb_buffer_.data();
+                annexb_size = needed > 0 ? NALConverter::convert(sample.data, sample.size, nal_length_size_,
+                                                                 annexb_frame, annexb_buffer_.size()) : 0;
             }
         }
+
+        if (annexb_size == 0) {
+            PLUGIN_H264_LOG( ("Malformed AVCC sample (%zu bytes, length size %d), skipped\n",
+                   sample.size, nal_length_size_) );
+            return false;
+        }
+
+        PLUGIN_H264_LOG( ("NAL unit type: 0x%02X\n", (annexb_size > 4) ? (annexb_frame[4] & 0x1F) : 0) );
+
+        // 时间戳随码流传入解码器，重排序/多线程延迟输出时帧仍带着自己的时间戳
+        VideoFrame video_frame;
+        bool decoded;
+        {
+            PLUGIN_H264_PERF_SCOPE(&perf_stats_, PerfStage::H264_DECODE);
+            decoded = h264_decoder->decode(annexb_frame, annexb_size, video_frame, video_track_.toSeconds(sample.timestamp));
+        }
+        if (decoded) {
+            frame = video_frame;
+
+            PLUGIN_H264_LOG( ("Video frame timestamp: %llu -> %.3fs (timescale: %.0f)\n",
+                   (unsigned long long)sample.timestamp, frame.timestamp, video_track_.timescale) );
+
+            return true;
+        }
+    } else if (demuxer->isWaitingForData()) {
+        // 样本数据还没有下载到，轨道并未结束
+        return false;
+    } else if (h264_decoder->flush(frame)) {
+        // 样本已读完，先取出解码器中缓存的帧
+        PLUGIN_H264_LOG( ("Flushed buffered video frame: %.3fs\n", frame.timestamp) );
+        return true;
+    } else {
+        // 无法读取更多视频样本，视频轨道已完成
+        video_track_finished_ = true;
+        PLUGIN_H264_LOG( ("Video track finished - no more samples available\n") );
     }
 
     return false;
@@ -447,7 +678,7 @@ bool H264Movie::decodeNextAudioFrame() {
         return false;
     }
 
-    auto demuxer = decoder_manager_->getMP4Demuxer();
+    auto demuxer = decoder_manager_->getDemuxer();
     auto aac_decoder = decoder_manager_->getAACDecoder();
 
     if (!demuxer || !aac_decoder) {
@@ -460,81 +691,90 @@ bool H264Movie::decodeNextAudioFrame() {
         return true;
     }
 
-    // 获取轨道信息
-    auto track_info = demuxer->getTrackInfo();
-
-    for (size_t i = 0; i < track_info.size(); ++i) {
-        const auto& track = track_info[i];
-        if (track.type == MP4TrackType::AUDIO && track.codec == CodecType::AAC) {
-            // 首先确保AAC解码器已经配置
-            if (!aac_configured_) {
-                // 创建基本的AudioSpecificConfig
-                std::vector<uint8_t> asc_data;
-
-                // 根据轨道信息构建ASC
-                int sample_rate = track.sample_rate;
-                int channels = track.channels;
-
-                // AAC-LC (Audio Object Type = 2)
-                uint8_t audio_object_type = 2;
-
-                // 采样率索引映射
-                uint8_t sampling_freq_index = 4; // 默认44100Hz
-                if (sample_rate == 96000) sampling_freq_index = 0;
-                else if (sample_rate == 88200) sampling_freq_index = 1;
-                else if (sample_rate == 64000) sampling_freq_index = 2;
-                else if (sample_rate == 48000) sampling_freq_index = 3;
-                else if (sample_rate == 44100) sampling_freq_index = 4;
-                else if (sample_rate == 32000) sampling_freq_index = 5;
-                else if (sample_rate == 24000) sampling_freq_index = 6;
-                else if (sample_rate == 22050) sampling_freq_index = 7;
-                else if (sample_rate == 16000) sampling_freq_index = 8;
-                else if (sample_rate == 12000) sampling_freq_index = 9;
-                else if (sample_rate == 11025) sampling_freq_index = 10;
-                else if (sample_rate == 8000) sampling_freq_index = 11;
-
-                // 声道配置
-                uint8_t channel_config = std::min(channels, 7);
-
-                // 构建ASC (2字节)
-                uint16_t asc = (audio_object_type << 11) | (sampling_freq_index << 7) | (channel_config << 3);
-                asc_data.push_back((asc >> 8) & 0xFF);
-                asc_data.push_back(asc & 0xFF);
-
-                if (aac_decoder->configureWithASC(asc_data.data(), asc_data.size())) {
-                    aac_configured_ = true;
-                }
+    std::lock_guard<std::mutex> lock(decode_mutex_);
+
+    if (!audio_track_.isValid()) {
+        return false;
+    }
+    const TrackInfo& track = audio_track_.info;
+
+    // 首先确保AAC解码器已经配置：优先使用容器中的AudioSpecificConfig（保留HE-AAC等扩展信息）
+    const std::vector<uint8_t>& dsi = audio_track_.config.dsi;
+    if (!aac_configured_ && !dsi.empty() && aac_decoder->configureWithASC(dsi.data(), dsi.size())) {
+        aac_configured_ = true;
+    }
+
+    if (!aac_configured_) {
+        // 容器中没有可用的配置时，创建基本的AudioSpecificConfig
+        std::vector<uint8_t> asc_data;
+
+        // 根据轨道信息构建ASC
+        int sample_rate = track.sample_rate;
+        int channels = track.channels;
+
+        // AAC-LC (Audio Object Type = 2)
+        uint8_t audio_object_type = 2;
+
+        // 采样率索引映射
+        uint8_t sampling_freq_index = 4; // 默认44100Hz
+        if (sample_rate == 96000) sampling_freq_index = 0;
+        else if (sample_rate == 88200) sampling_freq_index = 1;
+        else if (sample_rate == 64000) sampling_freq_index = 2;
+        else if (sample_rate == 48000) sampling_freq_index = 3;
+        else if (sample_rate == 44100) sampling_freq_index = 4;
+        else if (sample_rate == 32000) sampling_freq_index = 5;
+        else if (sample_rate == 24000) sampling_freq_index = 6;
+        else if (sample_rate == 22050) sampling_freq_index = 7;
+        else if (sample_rate == 16000) sampling_freq_index = 8;
+        else if (sample_rate == 12000) sampling_freq_index = 9;
+        else if (sample_rate == 11025) sampling_freq_index = 10;
+        else if (sample_rate == 8000) sampling_freq_index = 11;
+
+        // 声道配置
+        uint8_t channel_config = std::min(channels, 7);
+
+        // 构建ASC (2字节)
+        uint16_t asc = (audio_object_type << 11) | (sampling_freq_index << 7) | (channel_config << 3);
+        asc_data.push_back((asc >> 8) & 0xFF);
+        asc_data.push_back(asc & 0xFF);
+
+        if (aac_decoder->configureWithASC(asc_data.data(), asc_data.size())) {
+            aac_configured_ = true;
+        }
+    }
+
+    if (aac_configured_) {
+        MP4SampleView sample;
+        bool has_sample;
+        {
+            PLUGIN_H264_PERF_SCOPE(&perf_stats_, PerfStage::DEMUX);
+            has_sample = demuxer->readNextSample(track.track_id, sample);
+        }
+        if (has_sample) {
+            AudioFrame audio_frame;
+            bool decoded;
+            {
+                PLUGIN_H264_PERF_SCOPE(&perf_stats_, PerfStage::AAC_DECODE);
+                decoded = aac_decoder->decode(sample.data, sample.size, audio_frame);
             }
+            if (decoded) {
+                current_audio_frame_ = std::move(audio_frame);
 
-            if (aac_configured_) {
-                MP4Sample sample;
-                if (demuxer->readNextSample(track.track_id, sample)) {
-                    AudioFrame audio_frame;
-                    if (aac_decoder->decode(sample.data.data(), sample.data.size(), audio_frame)) {
-                        current_audio_frame_ = audio_frame;
-
-                        // 修复音频时间戳：使用与视频相同的timescale逻辑
-                        if (track.timescale > 0) {
-                            current_audio_frame_.timestamp = static_cast<double>(sample.timestamp) / track.timescale;
-                        } else {
-                            // 如果没有timescale信息，使用音频采样率作为时间基准
-                            current_audio_frame_.timestamp = static_cast<double>(sample.timestamp) / (track.sample_rate > 0 ? track.sample_rate : 44100);
-                        }
-
-                        // 音频时间戳已正确设置，用于播放速度控制
-                        PLUGIN_H264_LOG( ("Audio frame timestamp: %u -> %.3fs (timescale: %u, samplerate: %d)\n",
-                               sample.timestamp, current_audio_frame_.timestamp, track.timescale, track.sample_rate) );
-
-                        has_new_audio_frame_ = true;
-                        clearError();
-                        return true;
-                    }
-                } else {
-                    // 无法读取更多音频样本，音频轨道已完成
-                    audio_track_finished_ = true;
-                    PLUGIN_H264_LOG( ("Audio track finished - no more samples available\n") );
-                }
+                // 没有timescale时以采样率为时间基准（见Demuxer::findTrack）
+                current_audio_frame_.timestamp = audio_track_.toSeconds(sample.timestamp);
+
+                // 音频时间戳已正确设置，用于播放速度控制
+                PLUGIN_H264_LOG( ("Audio frame timestamp: %llu -> %.3fs (timescale: %.0f)\n",
+                       (unsigned long long)sample.timestamp, current_audio_frame_.timestamp, audio_track_.timescale) );
+
+                has_new_audio_frame_ = true;
+                clearError();
+                return true;
             }
+        } else if (!demuxer->isWaitingForData()) {
+            // 无法读取更多音频样本，音频轨道已完成
+            audio_track_finished_ = true;
+            PLUGIN_H264_LOG( ("Audio track finished - no more samples available\n") );
         }
     }
 
@@ -547,13 +787,34 @@ bool H264Movie::seekTo(double timestamp) {
         return false;
     }
 
-    auto demuxer = decoder_manager_->getMP4Demuxer();
+    auto demuxer = decoder_manager_->getDemuxer();
     if (!demuxer) {
         setError(H264Error::DECODER_INIT_FAILED, "Demuxer not available");
         return false;
     }
 
-    if (!demuxer->seekToTime(timestamp)) {
+    bool resume_thread = stopDecodeThread();
+
+    bool seek_result;
+    {
+        std::lock_guard<std::mutex> lock(decode_mutex_);
+        // 解复用器退回到目标之前最近的同步样本，之后解码到目标时间的帧才输出
+        seek_result = demuxer->seekToTime(timestamp);
+        if (seek_result) {
+            seek_target_ = std::max(0.0, std::min(timestamp, demuxer->getDuration()));
+
+            // 丢弃解码器中旧位置缓存的帧和参考帧
+            auto h264_decoder = decoder_manager_->getH264Decoder();
+            if (h264_decoder) {
+                h264_decoder->reset();
+            }
+        }
+    }
+
+    if (!seek_result) {
+        if (resume_thread) {
+            startDecodeThread();
+        }
         setError(H264Error::DECODE_FAILED, "Seek failed: " + demuxer->getLastMessage());
         return false;
     }
@@ -570,10 +831,124 @@ bool H264Movie::seekTo(double timestamp) {
     current_video_frame_ = VideoFrame();
     current_audio_frame_ = AudioFrame();
 
+    // seek后视频轨道重新有样本可读，旧位置已解码的帧全部作废
+    video_track_finished_ = false;
+    if (frame_queue_) {
+        frame_queue_->flush();
+    }
+    if (resume_thread) {
+        startDecodeThread();
+    }
+
     PLUGIN_H264_LOG( ("Seek completed to %.3fs, reset frame state\n", timestamp) );
 
     clearError();
     return true;
 }
 
+bool H264Movie::enableAsyncDecode(const FrameQueueConfig& config) {
+    if (!is_loaded_ || !decoder_manager_) {
+        setError(H264Error::DECODER_INIT_FAILED, "Movie not loaded");
+        return false;
+    }
+
+    stopDecodeThread();
+    frame_queue_.reset(new FrameQueue(config));
+
+    // 之后的帧都从帧队列取出，丢弃同步解码留下的帧
+    current_video_frame_ = VideoFrame();
+    has_new_video_frame_ = false;
+
+    startDecodeThread();
+
+    PLUGIN_H264_LOG( ("Async decode enabled: depth=%d, watermarks=%d/%d, blocking=%s\n",
+           frame_queue_->getConfig().depth, frame_queue_->getConfig().high_watermark,
+           frame_queue_->getConfig().low_watermark,
+           frame_queue_->getConfig().blocking_pop ? "true" : "false") );
+
+    clearError();
+    return true;
+}
+
+void H264Movie::disableAsyncDecode() {
+    if (!frame_queue_) {
+        return;
+    }
+
+    stopDecodeThread();
+
+    // 已取出的帧随队列释放
+    frame_queue_.reset();
+    current_video_frame_ = VideoFrame();
+    has_new_video_frame_ = false;
+}
+
+bool H264Movie::isAsyncDecodeEnabled() const {
+    return frame_queue_ != nullptr;
+}
+
+size_t H264Movie::getQueuedVideoFrames() const {
+    return frame_queue_ ? frame_queue_->size() : 0;
+}
+
+void H264Movie::startDecodeThread() {
+    if (!frame_queue_ || decode_thread_.joinable()) {
+        return;
+    }
+
+    decode_thread_stop_ = false;
+    frame_queue_->reopen();
+    decode_thread_ = std::thread(&H264Movie::decodeThreadLoop, this);
+}
+
+bool H264Movie::stopDecodeThread() {
+    if (!decode_thread_.joinable()) {
+        return false;
+    }
+
+    decode_thread_stop_ = true;
+    frame_queue_->close();
+    decode_thread_.join();
+    return true;
+}
+
+void H264Movie::decodeThreadLoop() {
+    while (!decode_thread_stop_) {
+        // 队列达到高水位时在这里等待
+        OwnedVideoFrame* slot = frame_queue_->beginPush();
+        if (!slot) {
+            break;
+        }
+
+        bool produced = false;
+        while (!produced && !decode_thread_stop_ && !video_track_finished_) {
+            VideoFrame frame;
+            bool decoded;
+            {
+                std::lock_guard<std::mutex> lock(decode_mutex_);
+                decoded = decodeVideoSample(frame);
+            }
+
+            // 解码器输出池化帧，放入队列只增加引用计数，可以在锁外进行
+            if (decoded) {
+                slot->copyFrom(frame, frame_queue_->getBufferPool());
+                produced = true;
+            } else if (isWaitingForData()) {
+                // 边下载边播放：等待数据写入
+                std::this_thread::sleep_for(std::chrono::milliseconds(kWaitForDataMs));
+            }
+        }
+
+        frame_queue_->endPush(slot, produced);
+
+        if (!produced) {
+            if (video_track_finished_) {
+                frame_queue_->setEndOfStream();
+                PLUGIN_H264_LOG( ("Decode thread reached end of video track\n") );
+            }
+            break;
+        }
+    }
+}
+
 } // namespace plugin_h264
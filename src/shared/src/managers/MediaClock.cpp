@@ -0,0 +1,137 @@
+#include "../include/managers/MediaClock.h"
+#include <chrono>
+#include <cstring>
+
+namespace plugin_h264 {
+
+MediaClock::MediaClock()
+    : mode_(ClockMode::AUDIO_MASTER)
+    , audio_source_(nullptr)
+    , anchor_media_time_(0.0)
+    , anchor_system_time_(now())
+    , paused_(true)
+    , external_time_(0.0) {
+}
+
+void MediaClock::setMode(ClockMode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (mode == mode_) {
+        return;
+    }
+
+    // 切换时从当前时间继续，避免跳变
+    double current = mode_ == ClockMode::EXTERNAL_MASTER ? external_time_ : getSystemTimeLocked();
+    anchor_media_time_ = current;
+    anchor_system_time_ = now();
+    external_time_ = current;
+    mode_ = mode;
+}
+
+ClockMode MediaClock::getMode() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mode_;
+}
+
+void MediaClock::setAudioSource(const AudioClockSource* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    audio_source_ = source;
+}
+
+void MediaClock::reset(double media_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    anchor_media_time_ = media_time;
+    anchor_system_time_ = now();
+    external_time_ = media_time;
+}
+
+void MediaClock::pause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (paused_) {
+        return;
+    }
+
+    anchor_media_time_ = getSystemTimeLocked();
+    anchor_system_time_ = now();
+    paused_ = true;
+}
+
+void MediaClock::resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!paused_) {
+        return;
+    }
+
+    anchor_system_time_ = now();
+    paused_ = false;
+}
+
+bool MediaClock::isPaused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paused_;
+}
+
+void MediaClock::setExternalTime(double media_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    external_time_ = media_time;
+}
+
+double MediaClock::getTime() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (mode_ == ClockMode::EXTERNAL_MASTER) {
+        return external_time_;
+    }
+
+    if (mode_ == ClockMode::AUDIO_MASTER && audio_source_) {
+        double audible;
+        if (audio_source_->getAudibleTime(audible)) {
+            anchor_media_time_ = audible;
+            anchor_system_time_ = now();
+            return audible;
+        }
+    }
+
+    return getSystemTimeLocked();
+}
+
+double MediaClock::getSystemTimeLocked() const {
+    if (paused_) {
+        return anchor_media_time_;
+    }
+    return anchor_media_time_ + (now() - anchor_system_time_);
+}
+
+double MediaClock::now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool MediaClock::parseMode(const char* name, ClockMode& mode) {
+    if (name == nullptr) {
+        return false;
+    }
+
+    if (strcmp(name, "audio") == 0) {
+        mode = ClockMode::AUDIO_MASTER;
+    } else if (strcmp(name, "video") == 0) {
+        mode = ClockMode::VIDEO_MASTER;
+    } else if (strcmp(name, "external") == 0) {
+        mode = ClockMode::EXTERNAL_MASTER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* MediaClock::getModeName(ClockMode mode) {
+    switch (mode) {
+        case ClockMode::AUDIO_MASTER:
+            return "audio";
+        case ClockMode::VIDEO_MASTER:
+            return "video";
+        case ClockMode::EXTERNAL_MASTER:
+            return "external";
+    }
+    return "audio";
+}
+
+} // namespace plugin_h264
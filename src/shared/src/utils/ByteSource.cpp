@@ -0,0 +1,282 @@
+#include "../include/utils/ByteSource.h"
+#include <algorithm>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace plugin_h264 {
+
+// 检查 [offset, offset + length) 是否在 [0, size) 之内
+static bool rangeValid(int64_t offset, size_t length, int64_t size) {
+    return offset >= 0 && offset <= size && static_cast<uint64_t>(size - offset) >= length;
+}
+
+MappedFileSource::MappedFileSource()
+    : data_(nullptr)
+    , size_(0) {
+}
+
+MappedFileSource::~MappedFileSource() {
+    close();
+}
+
+bool MappedFileSource::open(const std::string& file_path) {
+    close();
+
+#if defined(_WIN32)
+    setError(H264Error::FILE_OPEN_FAILED, "Memory mapping not supported on this platform");
+    return false;
+#else
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        setError(H264Error::FILE_OPEN_FAILED, "Invalid file size: " + file_path);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后文件描述符不再需要
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to map file: " + file_path);
+        return false;
+    }
+
+    // 播放基本是顺序读取
+    madvise(mapping, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    data_ = static_cast<const uint8_t*>(mapping);
+    size_ = st.st_size;
+    clearError();
+    return true;
+#endif
+}
+
+void MappedFileSource::close() {
+#if !defined(_WIN32)
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFileSource::read(int64_t offset, void* buffer, size_t length) {
+    const uint8_t* source = view(offset, length);
+    if (!source) {
+        return false;
+    }
+    memcpy(buffer, source, length);
+    return true;
+}
+
+const uint8_t* MappedFileSource::view(int64_t offset, size_t length) const {
+    if (!data_ || !rangeValid(offset, length, size_)) {
+        return nullptr;
+    }
+    return data_ + offset;
+}
+
+StreamFileSource::StreamFileSource()
+    : size_(0) {
+}
+
+bool StreamFileSource::open(const std::string& file_path) {
+    close();
+
+    file_.open(file_path, std::ios::binary);
+    if (!file_.is_open()) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+        return false;
+    }
+
+    file_.seekg(0, std::ios::end);
+    size_ = file_.tellg();
+    if (size_ <= 0) {
+        setError(H264Error::FILE_OPEN_FAILED, "Invalid file size: " + file_path);
+        close();
+        return false;
+    }
+
+    clearError();
+    return true;
+}
+
+void StreamFileSource::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.clear();
+    size_ = 0;
+}
+
+bool StreamFileSource::read(int64_t offset, void* buffer, size_t length) {
+    if (!file_.is_open() || !rangeValid(offset, length, size_)) {
+        return false;
+    }
+
+    // 上一次读到文件末尾会留下eof标志，先清除
+    file_.clear();
+    file_.seekg(offset, std::ios::beg);
+    if (!file_.good()) {
+        return false;
+    }
+
+    file_.read(static_cast<char*>(buffer), length);
+    return file_.gcount() == static_cast<std::streamsize>(length);
+}
+
+GrowingFileSource::GrowingFileSource()
+    : available_(0)
+    , complete_(false) {
+}
+
+bool GrowingFileSource::open(const std::string& file_path, BytesAvailableCallback bytes_available) {
+    close();
+
+    file_.open(file_path, std::ios::binary);
+    if (!file_.is_open()) {
+        setError(H264Error::FILE_OPEN_FAILED, "Failed to open file: " + file_path);
+        return false;
+    }
+
+    bytes_available_ = bytes_available;
+    complete_ = !bytes_available_;
+    available_ = complete_ ? fileSize() : 0;
+    refresh();
+
+    clearError();
+    return true;
+}
+
+void GrowingFileSource::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.clear();
+    bytes_available_ = nullptr;
+    available_ = 0;
+    complete_ = false;
+}
+
+int64_t GrowingFileSource::fileSize() {
+    // 文件仍在写入，每次都向系统查询当前长度
+    file_.clear();
+    file_.seekg(0, std::ios::end);
+    int64_t size = file_.tellg();
+    return size > 0 ? size : 0;
+}
+
+bool GrowingFileSource::refresh() {
+    if (complete_ || !file_.is_open()) {
+        return false;
+    }
+
+    bool complete = false;
+    int64_t available = bytes_available_(complete);
+
+    // 回调报告的长度不能超过磁盘上实际写入的部分
+    int64_t on_disk = fileSize();
+    if (available < 0 || available > on_disk || complete) {
+        available = on_disk;
+    }
+
+    int64_t previous = available_;
+    bool changed = available > previous || complete;
+    available_ = std::max(previous, available);
+    complete_ = complete;
+    return changed;
+}
+
+bool GrowingFileSource::read(int64_t offset, void* buffer, size_t length) {
+    if (!file_.is_open() || !rangeValid(offset, length, available_)) {
+        return false;
+    }
+
+    file_.clear();
+    file_.seekg(offset, std::ios::beg);
+    if (!file_.good()) {
+        return false;
+    }
+
+    file_.read(static_cast<char*>(buffer), length);
+    return file_.gcount() == static_cast<std::streamsize>(length);
+}
+
+MemorySource::MemorySource()
+    : data_(nullptr)
+    , size_(0) {
+}
+
+bool MemorySource::open(const uint8_t* data, size_t size, MemoryOwnership ownership) {
+    close();
+
+    if (data == nullptr || size == 0) {
+        setError(H264Error::INVALID_PARAM, "Invalid memory buffer");
+        return false;
+    }
+
+    if (ownership == MemoryOwnership::COPY) {
+        copy_.assign(data, data + size);
+        data = copy_.data();
+    }
+
+    data_ = data;
+    size_ = static_cast<int64_t>(size);
+    clearError();
+    return true;
+}
+
+void MemorySource::close() {
+    copy_.clear();
+    copy_.shrink_to_fit();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MemorySource::read(int64_t offset, void* buffer, size_t length) {
+    const uint8_t* source = view(offset, length);
+    if (!source) {
+        return false;
+    }
+    memcpy(buffer, source, length);
+    return true;
+}
+
+const uint8_t* MemorySource::view(int64_t offset, size_t length) const {
+    if (!data_ || !rangeValid(offset, length, size_)) {
+        return nullptr;
+    }
+    return data_ + offset;
+}
+
+std::unique_ptr<ByteSource> openFileSource(const std::string& file_path, bool allow_mmap) {
+    if (allow_mmap) {
+        std::unique_ptr<MappedFileSource> mapped(new MappedFileSource());
+        if (mapped->open(file_path)) {
+            return std::unique_ptr<ByteSource>(std::move(mapped));
+        }
+        PLUGIN_H264_LOG( ("mmap unavailable (%s), falling back to ifstream\n", mapped->getLastMessage().c_str()) );
+    }
+
+    std::unique_ptr<StreamFileSource> stream(new StreamFileSource());
+    if (stream->open(file_path)) {
+        return std::unique_ptr<ByteSource>(std::move(stream));
+    }
+    return nullptr;
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,494 @@
+#include "../include/utils/ColorConverter.h"
+#include "../include/utils/WorkerPool.h"
+#include <atomic>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PLUGIN_H264_CC_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PLUGIN_H264_CC_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PLUGIN_H264_CC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PLUGIN_H264_CC_TARGET(isa)
+#endif
+
+namespace plugin_h264 {
+
+namespace {
+
+// 定点系数：色度先左移8位，与 (系数 * 2048) 做高16位乘法，结果带3位小数
+// R = Y + 1.402 V, G = Y - 0.344136 U - 0.714136 V, B = Y + 1.772 U
+const int kVtoR = 2871;
+const int kUtoG = 705;
+const int kVtoG = 1463;
+const int kUtoB = 3629;
+const int kRoundBias = 4;
+
+// 每次处理一对亮度行（共享同一行色度），返回已处理的像素数
+typedef int (*RowPairKernel)(const uint8_t* y0, const uint8_t* y1,
+                             const uint8_t* u, const uint8_t* v,
+                             uint8_t* dst0, uint8_t* dst1, int width);
+
+inline int mulhi(int a, int b) {
+    return (a * b) >> 16;
+}
+
+inline uint8_t clampToByte(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+inline void storePixel(uint8_t* dst, int y, int r_term, int g_term, int b_term) {
+    int y_fixed = (y << 3) + kRoundBias;
+    dst[0] = clampToByte((y_fixed + r_term) >> 3);
+    dst[1] = clampToByte((y_fixed - g_term) >> 3);
+    dst[2] = clampToByte((y_fixed + b_term) >> 3);
+    dst[3] = 255;
+}
+
+// 标量定点实现，与SIMD实现逐位一致，用于尾部像素和无SIMD平台
+void convertRowPairScalar(const uint8_t* y0, const uint8_t* y1,
+                          const uint8_t* u, const uint8_t* v,
+                          uint8_t* dst0, uint8_t* dst1, int x_begin, int width) {
+    for (int x = x_begin; x < width; ++x) {
+        int c = x >> 1;
+        int u_shifted = (u[c] - 128) * 256;
+        int v_shifted = (v[c] - 128) * 256;
+
+        int r_term = mulhi(v_shifted, kVtoR);
+        int g_term = mulhi(u_shifted, kUtoG) + mulhi(v_shifted, kVtoG);
+        int b_term = mulhi(u_shifted, kUtoB);
+
+        storePixel(dst0 + x * 4, y0[x], r_term, g_term, b_term);
+        storePixel(dst1 + x * 4, y1[x], r_term, g_term, b_term);
+    }
+}
+
+int convertRowPairNone(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                       uint8_t*, uint8_t*, int) {
+    return 0;
+}
+
+#if defined(PLUGIN_H264_CC_X86)
+
+PLUGIN_H264_CC_TARGET("sse2")
+inline void storeRGBA16SSE2(uint8_t* dst, __m128i r, __m128i g, __m128i b) {
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+    __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+    __m128i ba_lo = _mm_unpacklo_epi8(b, alpha);
+    __m128i ba_hi = _mm_unpackhi_epi8(b, alpha);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),      _mm_unpacklo_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+}
+
+PLUGIN_H264_CC_TARGET("sse2")
+inline void convertRow16SSE2(const uint8_t* y_row, uint8_t* dst,
+                             __m128i r_lo, __m128i r_hi,
+                             __m128i g_lo, __m128i g_hi,
+                             __m128i b_lo, __m128i b_hi) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(kRoundBias);
+
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_row));
+    __m128i y_lo = _mm_add_epi16(_mm_slli_epi16(_mm_unpacklo_epi8(y, zero), 3), bias);
+    __m128i y_hi = _mm_add_epi16(_mm_slli_epi16(_mm_unpackhi_epi8(y, zero), 3), bias);
+
+    __m128i r = _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(y_lo, r_lo), 3),
+                                 _mm_srai_epi16(_mm_add_epi16(y_hi, r_hi), 3));
+    __m128i g = _mm_packus_epi16(_mm_srai_epi16(_mm_sub_epi16(y_lo, g_lo), 3),
+                                 _mm_srai_epi16(_mm_sub_epi16(y_hi, g_hi), 3));
+    __m128i b = _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(y_lo, b_lo), 3),
+                                 _mm_srai_epi16(_mm_add_epi16(y_hi, b_hi), 3));
+
+    storeRGBA16SSE2(dst, r, g, b);
+}
+
+PLUGIN_H264_CC_TARGET("sse2")
+int convertRowPairSSE2(const uint8_t* y0, const uint8_t* y1,
+                       const uint8_t* u, const uint8_t* v,
+                       uint8_t* dst0, uint8_t* dst1, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset = _mm_set1_epi16(128);
+    const __m128i v_to_r = _mm_set1_epi16(kVtoR);
+    const __m128i u_to_g = _mm_set1_epi16(kUtoG);
+    const __m128i v_to_g = _mm_set1_epi16(kVtoG);
+    const __m128i u_to_b = _mm_set1_epi16(kUtoB);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        int c = x >> 1;
+        __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + c));
+        __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + c));
+        __m128i u16 = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), offset), 8);
+        __m128i v16 = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), offset), 8);
+
+        __m128i r_term = _mm_mulhi_epi16(v16, v_to_r);
+        __m128i g_term = _mm_add_epi16(_mm_mulhi_epi16(u16, u_to_g), _mm_mulhi_epi16(v16, v_to_g));
+        __m128i b_term = _mm_mulhi_epi16(u16, u_to_b);
+
+        // 每个色度样本对应水平两个像素
+        __m128i r_lo = _mm_unpacklo_epi16(r_term, r_term);
+        __m128i r_hi = _mm_unpackhi_epi16(r_term, r_term);
+        __m128i g_lo = _mm_unpacklo_epi16(g_term, g_term);
+        __m128i g_hi = _mm_unpackhi_epi16(g_term, g_term);
+        __m128i b_lo = _mm_unpacklo_epi16(b_term, b_term);
+        __m128i b_hi = _mm_unpackhi_epi16(b_term, b_term);
+
+        convertRow16SSE2(y0 + x, dst0 + x * 4, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi);
+        convertRow16SSE2(y1 + x, dst1 + x * 4, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi);
+    }
+    return x;
+}
+
+PLUGIN_H264_CC_TARGET("avx2")
+inline void convertRow32AVX2(const uint8_t* y_row, uint8_t* dst,
+                             __m256i r_lo, __m256i r_hi,
+                             __m256i g_lo, __m256i g_hi,
+                             __m256i b_lo, __m256i b_hi) {
+    const __m256i bias = _mm256_set1_epi16(kRoundBias);
+    const __m256i alpha = _mm256_set1_epi8(static_cast<char>(0xFF));
+
+    __m256i y_lo = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y_row)));
+    __m256i y_hi = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y_row + 16)));
+    y_lo = _mm256_add_epi16(_mm256_slli_epi16(y_lo, 3), bias);
+    y_hi = _mm256_add_epi16(_mm256_slli_epi16(y_hi, 3), bias);
+
+    // packus按128位通道交错，permute4x64恢复像素顺序
+    __m256i r = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_srai_epi16(_mm256_add_epi16(y_lo, r_lo), 3),
+                            _mm256_srai_epi16(_mm256_add_epi16(y_hi, r_hi), 3)), 0xD8);
+    __m256i g = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_srai_epi16(_mm256_sub_epi16(y_lo, g_lo), 3),
+                            _mm256_srai_epi16(_mm256_sub_epi16(y_hi, g_hi), 3)), 0xD8);
+    __m256i b = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_srai_epi16(_mm256_add_epi16(y_lo, b_lo), 3),
+                            _mm256_srai_epi16(_mm256_add_epi16(y_hi, b_hi), 3)), 0xD8);
+
+    __m256i rg_lo = _mm256_unpacklo_epi8(r, g);
+    __m256i rg_hi = _mm256_unpackhi_epi8(r, g);
+    __m256i ba_lo = _mm256_unpacklo_epi8(b, alpha);
+    __m256i ba_hi = _mm256_unpackhi_epi8(b, alpha);
+
+    __m256i p0 = _mm256_unpacklo_epi16(rg_lo, ba_lo);  // 像素 0-3 | 16-19
+    __m256i p1 = _mm256_unpackhi_epi16(rg_lo, ba_lo);  // 像素 4-7 | 20-23
+    __m256i p2 = _mm256_unpacklo_epi16(rg_hi, ba_hi);  // 像素 8-11 | 24-27
+    __m256i p3 = _mm256_unpackhi_epi16(rg_hi, ba_hi);  // 像素 12-15 | 28-31
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),      _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+PLUGIN_H264_CC_TARGET("avx2")
+int convertRowPairAVX2(const uint8_t* y0, const uint8_t* y1,
+                       const uint8_t* u, const uint8_t* v,
+                       uint8_t* dst0, uint8_t* dst1, int width) {
+    const __m256i offset = _mm256_set1_epi16(128);
+    const __m256i v_to_r = _mm256_set1_epi16(kVtoR);
+    const __m256i u_to_g = _mm256_set1_epi16(kUtoG);
+    const __m256i v_to_g = _mm256_set1_epi16(kVtoG);
+    const __m256i u_to_b = _mm256_set1_epi16(kUtoB);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        int c = x >> 1;
+        __m256i u16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + c)));
+        __m256i v16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + c)));
+        u16 = _mm256_slli_epi16(_mm256_sub_epi16(u16, offset), 8);
+        v16 = _mm256_slli_epi16(_mm256_sub_epi16(v16, offset), 8);
+
+        __m256i r_term = _mm256_mulhi_epi16(v16, v_to_r);
+        __m256i g_term = _mm256_add_epi16(_mm256_mulhi_epi16(u16, u_to_g), _mm256_mulhi_epi16(v16, v_to_g));
+        __m256i b_term = _mm256_mulhi_epi16(u16, u_to_b);
+
+        // unpack按通道复制色度，再跨通道重排为像素 0-15 / 16-31
+        __m256i r_a = _mm256_unpacklo_epi16(r_term, r_term);
+        __m256i r_b = _mm256_unpackhi_epi16(r_term, r_term);
+        __m256i g_a = _mm256_unpacklo_epi16(g_term, g_term);
+        __m256i g_b = _mm256_unpackhi_epi16(g_term, g_term);
+        __m256i b_a = _mm256_unpacklo_epi16(b_term, b_term);
+        __m256i b_b = _mm256_unpackhi_epi16(b_term, b_term);
+
+        __m256i r_lo = _mm256_permute2x128_si256(r_a, r_b, 0x20);
+        __m256i r_hi = _mm256_permute2x128_si256(r_a, r_b, 0x31);
+        __m256i g_lo = _mm256_permute2x128_si256(g_a, g_b, 0x20);
+        __m256i g_hi = _mm256_permute2x128_si256(g_a, g_b, 0x31);
+        __m256i b_lo = _mm256_permute2x128_si256(b_a, b_b, 0x20);
+        __m256i b_hi = _mm256_permute2x128_si256(b_a, b_b, 0x31);
+
+        convertRow32AVX2(y0 + x, dst0 + x * 4, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi);
+        convertRow32AVX2(y1 + x, dst1 + x * 4, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi);
+    }
+
+    // 剩余不足32像素的部分交给SSE2
+    if (x + 16 <= width) {
+        x += convertRowPairSSE2(y0 + x, y1 + x, u + (x >> 1), v + (x >> 1),
+                                dst0 + x * 4, dst1 + x * 4, width - x);
+    }
+    return x;
+}
+
+bool cpuSupportsSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuSupportsAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PLUGIN_H264_CC_X86
+
+#if defined(PLUGIN_H264_CC_NEON)
+
+inline int16x8_t mulhiNEON(int16x8_t a, int16x4_t b) {
+    int32x4_t lo = vmull_s16(vget_low_s16(a), b);
+    int32x4_t hi = vmull_s16(vget_high_s16(a), b);
+    return vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16));
+}
+
+inline void convertRow16NEON(const uint8_t* y_row, uint8_t* dst,
+                             int16x8x2_t r_term, int16x8x2_t g_term, int16x8x2_t b_term) {
+    const int16x8_t bias = vdupq_n_s16(kRoundBias);
+
+    uint8x16_t y = vld1q_u8(y_row);
+    int16x8_t y_lo = vaddq_s16(vshlq_n_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y))), 3), bias);
+    int16x8_t y_hi = vaddq_s16(vshlq_n_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y))), 3), bias);
+
+    uint8x16x4_t rgba;
+    rgba.val[0] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vaddq_s16(y_lo, r_term.val[0]), 3)),
+                              vqmovun_s16(vshrq_n_s16(vaddq_s16(y_hi, r_term.val[1]), 3)));
+    rgba.val[1] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vsubq_s16(y_lo, g_term.val[0]), 3)),
+                              vqmovun_s16(vshrq_n_s16(vsubq_s16(y_hi, g_term.val[1]), 3)));
+    rgba.val[2] = vcombine_u8(vqmovun_s16(vshrq_n_s16(vaddq_s16(y_lo, b_term.val[0]), 3)),
+                              vqmovun_s16(vshrq_n_s16(vaddq_s16(y_hi, b_term.val[1]), 3)));
+    rgba.val[3] = vdupq_n_u8(255);
+    vst4q_u8(dst, rgba);
+}
+
+int convertRowPairNEON(const uint8_t* y0, const uint8_t* y1,
+                       const uint8_t* u, const uint8_t* v,
+                       uint8_t* dst0, uint8_t* dst1, int width) {
+    const int16x8_t offset = vdupq_n_s16(128);
+    const int16x4_t v_to_r = vdup_n_s16(kVtoR);
+    const int16x4_t u_to_g = vdup_n_s16(kUtoG);
+    const int16x4_t v_to_g = vdup_n_s16(kVtoG);
+    const int16x4_t u_to_b = vdup_n_s16(kUtoB);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        int c = x >> 1;
+        int16x8_t u16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + c))), offset), 8);
+        int16x8_t v16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + c))), offset), 8);
+
+        int16x8_t r_term = mulhiNEON(v16, v_to_r);
+        int16x8_t g_term = vaddq_s16(mulhiNEON(u16, u_to_g), mulhiNEON(v16, v_to_g));
+        int16x8_t b_term = mulhiNEON(u16, u_to_b);
+
+        // 每个色度样本对应水平两个像素
+        int16x8x2_t r_dup = vzipq_s16(r_term, r_term);
+        int16x8x2_t g_dup = vzipq_s16(g_term, g_term);
+        int16x8x2_t b_dup = vzipq_s16(b_term, b_term);
+
+        convertRow16NEON(y0 + x, dst0 + x * 4, r_dup, g_dup, b_dup);
+        convertRow16NEON(y1 + x, dst1 + x * 4, r_dup, g_dup, b_dup);
+    }
+    return x;
+}
+
+#endif // PLUGIN_H264_CC_NEON
+
+RowPairKernel kernelFor(ColorConverter::Backend backend) {
+    switch (backend) {
+#if defined(PLUGIN_H264_CC_X86)
+        case ColorConverter::Backend::SSE2: return convertRowPairSSE2;
+        case ColorConverter::Backend::AVX2: return convertRowPairAVX2;
+#endif
+#if defined(PLUGIN_H264_CC_NEON)
+        case ColorConverter::Backend::NEON: return convertRowPairNEON;
+#endif
+        default: return convertRowPairNone;
+    }
+}
+
+std::atomic<int>& activeBackendStorage() {
+    static std::atomic<int> backend(static_cast<int>(ColorConverter::detectBackend()));
+    return backend;
+}
+
+void convertRows(const VideoFrame& frame, uint8_t* rgba, int rgba_stride,
+                 int row_begin, int row_end, RowPairKernel kernel) {
+    const int width = frame.width;
+
+    for (int row = row_begin; row < row_end; row += 2) {
+        bool has_pair = row + 1 < row_end;
+        const uint8_t* y0 = frame.y_plane + static_cast<size_t>(row) * frame.y_stride;
+        const uint8_t* y1 = has_pair ? y0 + frame.y_stride : y0;
+        const uint8_t* u = frame.u_plane + static_cast<size_t>(row >> 1) * frame.uv_stride;
+        const uint8_t* v = frame.v_plane + static_cast<size_t>(row >> 1) * frame.uv_stride;
+        uint8_t* dst0 = rgba + static_cast<size_t>(row) * rgba_stride;
+        uint8_t* dst1 = has_pair ? dst0 + rgba_stride : dst0;
+
+        int done = kernel(y0, y1, u, v, dst0, dst1, width);
+        if (done < width) {
+            convertRowPairScalar(y0, y1, u, v, dst0, dst1, done, width);
+        }
+    }
+}
+
+} // namespace
+
+ColorConverter::Backend ColorConverter::detectBackend() {
+#if defined(PLUGIN_H264_CC_X86)
+    if (cpuSupportsAVX2()) {
+        return Backend::AVX2;
+    }
+    if (cpuSupportsSSE2()) {
+        return Backend::SSE2;
+    }
+#endif
+#if defined(PLUGIN_H264_CC_NEON)
+    return Backend::NEON;
+#endif
+    return Backend::SCALAR;
+}
+
+ColorConverter::Backend ColorConverter::activeBackend() {
+    return static_cast<Backend>(activeBackendStorage().load(std::memory_order_relaxed));
+}
+
+bool ColorConverter::setBackend(Backend backend) {
+    if (!isBackendSupported(backend)) {
+        return false;
+    }
+    activeBackendStorage().store(static_cast<int>(backend), std::memory_order_relaxed);
+    return true;
+}
+
+bool ColorConverter::isBackendSupported(Backend backend) {
+    switch (backend) {
+        case Backend::SCALAR:
+            return true;
+#if defined(PLUGIN_H264_CC_X86)
+        case Backend::SSE2:
+            return cpuSupportsSSE2();
+        case Backend::AVX2:
+            return cpuSupportsAVX2();
+#endif
+#if defined(PLUGIN_H264_CC_NEON)
+        case Backend::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* ColorConverter::backendName(Backend backend) {
+    switch (backend) {
+        case Backend::SCALAR: return "scalar";
+        case Backend::SSE2: return "sse2";
+        case Backend::AVX2: return "avx2";
+        case Backend::NEON: return "neon";
+        default: return "unknown";
+    }
+}
+
+void ColorConverter::convertYUV420ToRGBA(const VideoFrame& frame, uint8_t* rgba, int rgba_stride) {
+    if (!frame.isValid() || rgba == nullptr) {
+        return;
+    }
+    convertRows(frame, rgba, rgba_stride, 0, frame.height, kernelFor(activeBackend()));
+}
+
+void ColorConverter::convertYUV420ToRGBA(const VideoFrame& frame, uint8_t* rgba, int rgba_stride,
+                                         WorkerPool* pool) {
+    if (!frame.isValid() || rgba == nullptr) {
+        return;
+    }
+
+    int threads = pool ? pool->getThreadCount() : 1;
+    if (threads <= 1 || frame.width * frame.height < kParallelMinPixels) {
+        convertYUV420ToRGBA(frame, rgba, rgba_stride);
+        return;
+    }
+
+    // 条带高度向上取偶数，保证每个条带从色度行边界开始
+    int stripe_rows = ((frame.height + threads - 1) / threads + 1) & ~1;
+    int stripes = (frame.height + stripe_rows - 1) / stripe_rows;
+    RowPairKernel kernel = kernelFor(activeBackend());
+
+    pool->run(stripes, [&](int stripe) {
+        int row_begin = stripe * stripe_rows;
+        int row_end = std::min(frame.height, row_begin + stripe_rows);
+        convertRows(frame, rgba, rgba_stride, row_begin, row_end, kernel);
+    });
+}
+
+void ColorConverter::convertYUV420ToRGBAReference(const VideoFrame& frame, uint8_t* rgba, int rgba_stride) {
+    if (!frame.isValid() || rgba == nullptr) {
+        return;
+    }
+
+    for (int y = 0; y < frame.height; y++) {
+        for (int x = 0; x < frame.width; x++) {
+            int y_index = y * frame.y_stride + x;
+            int uv_index = (y / 2) * frame.uv_stride + (x / 2);
+
+            int Y = frame.y_plane[y_index];
+            int U = frame.u_plane[uv_index] - 128;
+            int V = frame.v_plane[uv_index] - 128;
+
+            // BT.601标准YUV到RGB转换
+            int R = Y + (1.402f * V);
+            int G = Y - (0.344136f * U) - (0.714136f * V);
+            int B = Y + (1.772f * U);
+
+            uint8_t* dst = rgba + y * rgba_stride + x * 4;
+            dst[0] = static_cast<uint8_t>(std::max(0, std::min(255, R)));
+            dst[1] = static_cast<uint8_t>(std::max(0, std::min(255, G)));
+            dst[2] = static_cast<uint8_t>(std::max(0, std::min(255, B)));
+            dst[3] = 255;
+        }
+    }
+}
+
+} // namespace plugin_h264
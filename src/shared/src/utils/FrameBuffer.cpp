@@ -0,0 +1,445 @@
+#include "../include/utils/FrameBuffer.h"
+#include <cstring>
+
+namespace plugin_h264 {
+
+namespace {
+
+// 大小级别：不超过4KB为第0级，之后每次翻倍之间分4级（1.25/1.5/1.75/2倍）
+// 超过最大级别的缓冲区不进入池
+const int kMinClassShift = 12;
+const int kMaxClassShift = 31;
+const int kClassCount = 1 + (kMaxClassShift - kMinClassShift) * 4;
+const size_t kSlotsPerClass = 8;
+const int kThreadCacheSize = 2;
+
+size_t alignUp(size_t value) {
+    return (value + FrameBuffer::kAlignment - 1) & ~(FrameBuffer::kAlignment - 1);
+}
+
+size_t classSize(int size_class) {
+    if (size_class == 0) {
+        return size_t(1) << kMinClassShift;
+    }
+    int shift = kMinClassShift + (size_class - 1) / 4;
+    int quarter = (size_class - 1) % 4;
+    return (size_t(1) << shift) + (size_t(quarter + 1) << (shift - 2));
+}
+
+int findSizeClass(size_t size) {
+    if (size <= (size_t(1) << kMinClassShift)) {
+        return 0;
+    }
+    size_t n = size - 1;
+    int shift = kMinClassShift;
+    while ((n >> (shift + 1)) != 0) {
+        ++shift;
+    }
+    if (shift >= kMaxClassShift) {
+        return -1;
+    }
+    int quarter = static_cast<int>((n >> (shift - 2)) & 3);
+    return 1 + (shift - kMinClassShift) * 4 + quarter;
+}
+
+} // namespace
+
+const size_t FrameBuffer::kAlignment;
+const size_t FrameBufferPool::kDefaultMaxFreeBytes;
+
+struct FrameBuffer::Block {
+    std::atomic<int> refs;
+    std::unique_ptr<uint8_t[]> storage;   // 多分配kAlignment-1字节用于对齐
+    uint8_t* data;
+    size_t capacity;
+    int size_class;                       // -1表示不进入池
+    uint8_t* planes[3];
+    int strides[3];
+    int width;
+    int height;
+    std::shared_ptr<PoolState> pool;      // 使用中或在线程缓存中时保持池的状态有效
+
+    Block() : refs(0), data(nullptr), capacity(0), size_class(-1), planes(), strides(), width(0), height(0) {}
+};
+
+struct FrameBuffer::PoolState {
+    std::atomic<Block*> slots[kClassCount][kSlotsPerClass];
+    std::atomic<size_t> max_free_bytes;
+    std::atomic<size_t> held_bytes;
+    std::atomic<size_t> free_blocks;
+    std::atomic<size_t> allocated_bytes;
+    std::atomic<size_t> high_water;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<bool> closed;
+
+    explicit PoolState(size_t max_free)
+        : max_free_bytes(max_free), held_bytes(0), free_blocks(0), allocated_bytes(0),
+          high_water(0), hits(0), misses(0), closed(false) {
+        for (int size_class = 0; size_class < kClassCount; ++size_class) {
+            for (size_t i = 0; i < kSlotsPerClass; ++i) {
+                slots[size_class][i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 池和所有使用中的缓冲区都已释放
+    ~PoolState() { drain(); }
+
+    // 空闲块计入上限，超出时返回false
+    bool reserve(size_t bytes) {
+        size_t held = held_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (held > max_free_bytes.load(std::memory_order_relaxed)) {
+            held_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            return false;
+        }
+        free_blocks.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unreserve(size_t bytes) {
+        held_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        free_blocks.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void allocated(size_t bytes) {
+        size_t total = allocated_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = high_water.load(std::memory_order_relaxed);
+        while (total > peak && !high_water.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+        }
+    }
+
+    void destroy(Block* block) {
+        allocated_bytes.fetch_sub(block->capacity, std::memory_order_relaxed);
+        delete block;
+    }
+
+    Block* pop(int size_class) {
+        for (size_t i = 0; i < kSlotsPerClass; ++i) {
+            if (slots[size_class][i].load(std::memory_order_relaxed) != nullptr) {
+                Block* block = slots[size_class][i].exchange(nullptr, std::memory_order_acquire);
+                if (block) {
+                    return block;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    bool push(Block* block) {
+        for (size_t i = 0; i < kSlotsPerClass; ++i) {
+            Block* expected = nullptr;
+            if (slots[block->size_class][i].compare_exchange_strong(expected, block, std::memory_order_release,
+                                                                    std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 从最大的级别开始释放共享空闲表中的块，直到空闲字节不超过limit
+    void trim(size_t limit) {
+        for (int size_class = kClassCount - 1; size_class >= 0; --size_class) {
+            for (size_t i = 0; i < kSlotsPerClass; ++i) {
+                if (held_bytes.load(std::memory_order_relaxed) <= limit) {
+                    return;
+                }
+                Block* block = slots[size_class][i].exchange(nullptr, std::memory_order_acquire);
+                if (block) {
+                    unreserve(block->capacity);
+                    destroy(block);
+                }
+            }
+        }
+    }
+
+    void drain() {
+        for (int size_class = 0; size_class < kClassCount; ++size_class) {
+            for (size_t i = 0; i < kSlotsPerClass; ++i) {
+                Block* block = slots[size_class][i].exchange(nullptr, std::memory_order_acquire);
+                if (block) {
+                    unreserve(block->capacity);
+                    destroy(block);
+                }
+            }
+        }
+    }
+};
+
+// 每个线程最近释放的少量空闲块，块在缓存中时持有池状态的引用
+struct FrameBuffer::ThreadCache {
+    Block* blocks[kThreadCacheSize];
+
+    ThreadCache() : blocks() {}
+
+    // 线程退出：交回共享空闲表，放不下时回收
+    ~ThreadCache() {
+        for (int i = 0; i < kThreadCacheSize; ++i) {
+            if (blocks[i]) {
+                evict(i, true);
+            }
+        }
+    }
+
+    Block* take(const PoolState* pool, int size_class) {
+        Block* found = nullptr;
+        for (int i = 0; i < kThreadCacheSize; ++i) {
+            Block* block = blocks[i];
+            if (!block) {
+                continue;
+            }
+            if (block->pool->closed.load(std::memory_order_relaxed)) {
+                evict(i, false);
+            } else if (!found && block->pool.get() == pool && block->size_class == size_class) {
+                found = block;
+                blocks[i] = nullptr;
+            }
+        }
+        return found;
+    }
+
+    bool put(Block* block, std::shared_ptr<PoolState>& pool) {
+        for (int i = 0; i < kThreadCacheSize; ++i) {
+            if (blocks[i] && blocks[i]->pool->closed.load(std::memory_order_relaxed)) {
+                evict(i, false);
+            }
+            if (!blocks[i]) {
+                block->pool = std::move(pool);
+                blocks[i] = block;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 回收缓存中属于pool的块
+    void release(const PoolState* pool) {
+        for (int i = 0; i < kThreadCacheSize; ++i) {
+            if (blocks[i] && blocks[i]->pool.get() == pool) {
+                evict(i, false);
+            }
+        }
+    }
+
+    void evict(int index, bool keep) {
+        Block* block = blocks[index];
+        blocks[index] = nullptr;
+        std::shared_ptr<PoolState> pool = std::move(block->pool);
+        if (keep && !pool->closed.load(std::memory_order_relaxed) && pool->push(block)) {
+            return;
+        }
+        pool->unreserve(block->capacity);
+        pool->destroy(block);
+    }
+};
+
+FrameBuffer::ThreadCache& FrameBuffer::threadCache() {
+    static thread_local ThreadCache cache;
+    return cache;
+}
+
+FrameBuffer::FrameBuffer(const FrameBuffer& other) : block_(other.block_) {
+    if (block_) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameBuffer& FrameBuffer::operator=(const FrameBuffer& other) {
+    if (block_ != other.block_) {
+        release();
+        block_ = other.block_;
+        if (block_) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return *this;
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+uint8_t* FrameBuffer::plane(int index) const {
+    return block_ && index >= 0 && index < 3 ? block_->planes[index] : nullptr;
+}
+
+int FrameBuffer::stride(int index) const {
+    return block_ && index >= 0 && index < 3 ? block_->strides[index] : 0;
+}
+
+int FrameBuffer::width() const {
+    return block_ ? block_->width : 0;
+}
+
+int FrameBuffer::height() const {
+    return block_ ? block_->height : 0;
+}
+
+size_t FrameBuffer::capacity() const {
+    return block_ ? block_->capacity : 0;
+}
+
+int FrameBuffer::useCount() const {
+    return block_ ? block_->refs.load(std::memory_order_relaxed) : 0;
+}
+
+void FrameBuffer::copyFrom(const uint8_t* y, const uint8_t* u, const uint8_t* v, int y_stride, int uv_stride) {
+    if (!block_) {
+        return;
+    }
+
+    const int width = block_->width;
+    const int height = block_->height;
+    const int uv_width = block_->strides[1];
+    const int uv_height = (height + 1) / 2;
+
+    for (int row = 0; row < height; ++row) {
+        memcpy(block_->planes[0] + static_cast<size_t>(row) * width,
+               y + static_cast<size_t>(row) * y_stride, width);
+    }
+    for (int row = 0; row < uv_height; ++row) {
+        memcpy(block_->planes[1] + static_cast<size_t>(row) * uv_width,
+               u + static_cast<size_t>(row) * uv_stride, uv_width);
+        memcpy(block_->planes[2] + static_cast<size_t>(row) * uv_width,
+               v + static_cast<size_t>(row) * uv_stride, uv_width);
+    }
+}
+
+void FrameBuffer::release() {
+    Block* block = block_;
+    block_ = nullptr;
+    if (!block || block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // 最后一个引用：池已销毁、不进入池或超过字节上限时回收
+    std::shared_ptr<PoolState> pool = std::move(block->pool);
+    if (block->size_class < 0 || pool->closed.load(std::memory_order_relaxed) || !pool->reserve(block->capacity)) {
+        pool->destroy(block);
+        return;
+    }
+
+    // 先放进本线程的缓存，满了再放回共享空闲表
+    if (threadCache().put(block, pool)) {
+        return;
+    }
+    if (!pool->push(block)) {
+        pool->unreserve(block->capacity);
+        pool->destroy(block);
+    }
+}
+
+FrameBufferPool::FrameBufferPool(size_t max_free_bytes)
+    : state_(std::make_shared<FrameBuffer::PoolState>(max_free_bytes)) {
+}
+
+FrameBufferPool::~FrameBufferPool() {
+    state_->closed.store(true, std::memory_order_relaxed);
+    clear();
+}
+
+FrameBufferPool& FrameBufferPool::shared() {
+    // 不析构：线程退出时线程缓存还要把块交回这里
+    static FrameBufferPool* pool = new FrameBufferPool();
+    return *pool;
+}
+
+FrameBuffer FrameBufferPool::acquire(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return FrameBuffer();
+    }
+
+    const size_t uv_width = (static_cast<size_t>(width) + 1) / 2;
+    const size_t uv_height = (static_cast<size_t>(height) + 1) / 2;
+    const size_t y_size = static_cast<size_t>(width) * height;
+    const size_t uv_size = uv_width * uv_height;
+    const size_t u_offset = alignUp(y_size);
+    const size_t v_offset = alignUp(u_offset + uv_size);
+    const size_t total = v_offset + uv_size;
+
+    const int size_class = findSizeClass(total);
+    FrameBuffer::Block* block = nullptr;
+    if (size_class >= 0) {
+        block = FrameBuffer::threadCache().take(state_.get(), size_class);
+        if (!block) {
+            block = state_->pop(size_class);
+        }
+    }
+
+    if (block) {
+        state_->unreserve(block->capacity);
+        state_->hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::unique_ptr<FrameBuffer::Block> created(new FrameBuffer::Block());
+        created->capacity = size_class >= 0 ? classSize(size_class) : total;
+        created->size_class = size_class;
+        created->storage.reset(new uint8_t[created->capacity + FrameBuffer::kAlignment - 1]);
+        uintptr_t address = reinterpret_cast<uintptr_t>(created->storage.get());
+        created->data = created->storage.get() + (alignUp(address) - address);
+        block = created.release();
+        state_->allocated(block->capacity);
+        state_->misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    block->planes[0] = block->data;
+    block->planes[1] = block->data + u_offset;
+    block->planes[2] = block->data + v_offset;
+    block->strides[0] = width;
+    block->strides[1] = static_cast<int>(uv_width);
+    block->strides[2] = static_cast<int>(uv_width);
+    block->width = width;
+    block->height = height;
+    block->pool = state_;
+    block->refs.store(1, std::memory_order_relaxed);
+    return FrameBuffer(block);
+}
+
+void FrameBufferPool::setMaxFreeBytes(size_t bytes) {
+    state_->max_free_bytes.store(bytes, std::memory_order_relaxed);
+    if (state_->held_bytes.load(std::memory_order_relaxed) > bytes) {
+        FrameBuffer::threadCache().release(state_.get());
+        state_->trim(bytes);
+    }
+}
+
+size_t FrameBufferPool::getMaxFreeBytes() const {
+    return state_->max_free_bytes.load(std::memory_order_relaxed);
+}
+
+void FrameBufferPool::clear() {
+    FrameBuffer::threadCache().release(state_.get());
+    state_->drain();
+}
+
+size_t FrameBufferPool::getFreeCount() const {
+    return state_->free_blocks.load(std::memory_order_relaxed);
+}
+
+size_t FrameBufferPool::getMemoryUsage() const {
+    return state_->held_bytes.load(std::memory_order_relaxed);
+}
+
+FrameBufferPoolStats FrameBufferPool::getStats() const {
+    FrameBufferPoolStats stats;
+    stats.hits = state_->hits.load(std::memory_order_relaxed);
+    stats.misses = state_->misses.load(std::memory_order_relaxed);
+    stats.bytes_held = state_->held_bytes.load(std::memory_order_relaxed);
+    size_t allocated = state_->allocated_bytes.load(std::memory_order_relaxed);
+    stats.bytes_in_use = allocated > stats.bytes_held ? allocated - stats.bytes_held : 0;
+    stats.high_water = state_->high_water.load(std::memory_order_relaxed);
+    stats.max_free_bytes = state_->max_free_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FrameBufferPool::resetStats() {
+    state_->hits.store(0, std::memory_order_relaxed);
+    state_->misses.store(0, std::memory_order_relaxed);
+    state_->high_water.store(state_->allocated_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,196 @@
+#include "../include/utils/NALConverter.h"
+#include <cstring>
+
+namespace plugin_h264 {
+
+namespace {
+const uint8_t kStartCode[NALConverter::kStartCodeSize] = {0x00, 0x00, 0x00, 0x01};
+}
+
+int NALConverter::parseLengthSize(const uint8_t* avcc, size_t size) {
+    // configurationVersion(1) profile(1) compat(1) level(1) 6bit保留+lengthSizeMinusOne(2bit)
+    if (avcc == nullptr || size < 5 || avcc[0] != 1) {
+        return 0;
+    }
+
+    int length_size = (avcc[4] & 0x03) + 1;
+    return length_size == 3 ? 0 : length_size;
+}
+
+bool NALConverter::readLength(const uint8_t* data, int length_size, uint32_t& length) {
+    switch (length_size) {
+        case 1:
+            length = data[0];
+            return true;
+        case 2:
+            length = (static_cast<uint32_t>(data[0]) << 8) | data[1];
+            return true;
+        case 4:
+            length = (static_cast<uint32_t>(data[0]) << 24) |
+                     (static_cast<uint32_t>(data[1]) << 16) |
+                     (static_cast<uint32_t>(data[2]) << 8) |
+                     data[3];
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool NALConverter::rewriteInPlace(uint8_t* data, size_t size) {
+    if (data == nullptr || size == 0) {
+        return false;
+    }
+
+    size_t offset = 0;
+    while (offset < size) {
+        uint32_t nal_length;
+        if (size - offset < 4 || !readLength(data + offset, 4, nal_length)) {
+            return false;
+        }
+        if (nal_length > size - offset - 4) {
+            return false;
+        }
+
+        memcpy(data + offset, kStartCode, kStartCodeSize);
+        offset += 4 + nal_length;
+    }
+
+    return true;
+}
+
+size_t NALConverter::annexBSize(const uint8_t* data, size_t size, int length_size) {
+    if (data == nullptr || size == 0) {
+        return 0;
+    }
+
+    size_t total = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        uint32_t nal_length;
+        if (size - offset < static_cast<size_t>(length_size) ||
+            !readLength(data + offset, length_size, nal_length)) {
+            return 0;
+        }
+        offset += length_size;
+        if (nal_length > size - offset) {
+            return 0;
+        }
+
+        total += kStartCodeSize + nal_length;
+        offset += nal_length;
+    }
+
+    return total;
+}
+
+size_t NALConverter::convert(const uint8_t* data, size_t size, int length_size,
+                             uint8_t* dst, size_t capacity) {
+    if (data == nullptr || dst == nullptr || size == 0) {
+        return 0;
+    }
+
+    size_t written = 0;
+    size_t offset = 0;
+    while (offset < size) {
+        uint32_t nal_length;
+        if (size - offset < static_cast<size_t>(length_size) ||
+            !readLength(data + offset, length_size, nal_length)) {
+            return 0;
+        }
+        offset += length_size;
+        if (nal_length > size - offset) {
+            return 0;
+        }
+        if (capacity - written < kStartCodeSize + static_cast<size_t>(nal_length)) {
+            return 0;
+        }
+
+        memcpy(dst + written, kStartCode, kStartCodeSize);
+        written += kStartCodeSize;
+        memcpy(dst + written, data + offset, nal_length);
+        written += nal_length;
+        offset += nal_length;
+    }
+
+    return written;
+}
+
+bool NALConverter::isReferenceSample(const uint8_t* data, size_t size, int length_size) {
+    if (data == nullptr) {
+        return true;
+    }
+
+    bool has_slice = false;
+    size_t offset = 0;
+    while (offset < size) {
+        uint32_t nal_length;
+        if (size - offset < static_cast<size_t>(length_size) || !readLength(data + offset, length_size, nal_length)) {
+            return true;
+        }
+        offset += length_size;
+        if (nal_length == 0 || nal_length > size - offset) {
+            return true;
+        }
+
+        // NAL头：forbidden_zero_bit(1) nal_ref_idc(2) nal_unit_type(5)
+        uint8_t header = data[offset];
+        int nal_type = header & 0x1F;
+        if (nal_type >= 1 && nal_type <= 5) {
+            if ((header & 0x60) != 0) {
+                return true;
+            }
+            has_slice = true;
+        }
+        offset += nal_length;
+    }
+
+    return !has_slice;
+}
+
+SliceInfo NALConverter::inspectAnnexB(const uint8_t* data, size_t size) {
+    SliceInfo info;
+    if (data == nullptr) {
+        return info;
+    }
+
+    // 00 00 01 之后是NAL头，4字节起始码的前导0同样匹配
+    size_t i = findStartCode(data, size);
+    while (i + 3 < size) {
+        uint8_t header = data[i + 3];
+        int nal_type = header & 0x1F;
+        if (nal_type >= 1 && nal_type <= 5) {
+            info.has_slice = true;
+            info.is_reference = info.is_reference || (header & 0x60) != 0;
+            info.is_idr = info.is_idr || nal_type == 5;
+        }
+        i += 4 + findStartCode(data + i + 4, size - i - 4);
+    }
+
+    return info;
+}
+
+size_t NALConverter::findStartCode(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < 3) {
+        return size;
+    }
+
+    // 从第3个字节开始找0x01，它前面的两个字节都为0时即为起始码
+    const uint8_t* begin = data;
+    const uint8_t* end = data + size;
+    const uint8_t* p = data + 2;
+    while (p < end) {
+        p = static_cast<const uint8_t*>(memchr(p, 0x01, end - p));
+        if (p == nullptr) {
+            return size;
+        }
+        if (p[-1] == 0 && p[-2] == 0) {
+            return static_cast<size_t>(p - 2 - begin);
+        }
+        // 0x01不能作为下一个起始码的前导0，下一个候选至少在p + 3
+        p += 3;
+    }
+
+    return size;
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,155 @@
+#include "../include/utils/PCMBuffer.h"
+
+namespace plugin_h264 {
+
+struct PCMBuffer::PoolState {
+    std::mutex mutex;
+    std::vector<Block*> free_blocks;
+    size_t max_free;
+    bool closed;
+
+    explicit PoolState(size_t max_free_blocks) : max_free(max_free_blocks), closed(false) {}
+};
+
+struct PCMBuffer::Block {
+    std::atomic<int> refs;
+    std::unique_ptr<int16_t[]> samples;
+    size_t capacity;
+    size_t size;
+    std::shared_ptr<PoolState> pool;   // 数据块存在期间保持池的状态有效
+
+    Block() : refs(0), capacity(0), size(0) {}
+};
+
+PCMBuffer::PCMBuffer(const PCMBuffer& other) : block_(other.block_) {
+    if (block_) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PCMBuffer& PCMBuffer::operator=(const PCMBuffer& other) {
+    if (block_ != other.block_) {
+        release();
+        block_ = other.block_;
+        if (block_) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return *this;
+}
+
+PCMBuffer& PCMBuffer::operator=(PCMBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+int16_t* PCMBuffer::data() {
+    return block_ ? block_->samples.get() : nullptr;
+}
+
+const int16_t* PCMBuffer::data() const {
+    return block_ ? block_->samples.get() : nullptr;
+}
+
+size_t PCMBuffer::size() const {
+    return block_ ? block_->size : 0;
+}
+
+size_t PCMBuffer::capacity() const {
+    return block_ ? block_->capacity : 0;
+}
+
+void PCMBuffer::setSize(size_t size) {
+    if (block_) {
+        block_->size = size < block_->capacity ? size : block_->capacity;
+    }
+}
+
+void PCMBuffer::release() {
+    Block* block = block_;
+    block_ = nullptr;
+    if (!block || block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // 最后一个引用：放回池中，池已销毁或已满时回收
+    std::shared_ptr<PoolState> pool = std::move(block->pool);
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (!pool->closed && pool->free_blocks.size() < pool->max_free) {
+            block->pool = pool;
+            pool->free_blocks.push_back(block);
+            return;
+        }
+    }
+    delete block;
+}
+
+PCMBufferPool::PCMBufferPool(size_t max_free)
+    : state_(std::make_shared<PCMBuffer::PoolState>(max_free)) {
+}
+
+PCMBufferPool::~PCMBufferPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->closed = true;
+    }
+    clear();
+}
+
+PCMBuffer PCMBufferPool::acquire(size_t capacity) {
+    PCMBuffer::Block* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->free_blocks.empty()) {
+            block = state_->free_blocks.back();
+            state_->free_blocks.pop_back();
+        }
+    }
+
+    if (!block) {
+        block = new PCMBuffer::Block();
+        block->pool = state_;
+    }
+
+    // 同一解码器的帧大小基本不变，容量只在第一次或格式变化时增长
+    if (block->capacity < capacity) {
+        block->samples.reset(new int16_t[capacity]);
+        block->capacity = capacity;
+    }
+    block->size = capacity;
+    block->refs.store(1, std::memory_order_relaxed);
+    return PCMBuffer(block);
+}
+
+void PCMBufferPool::clear() {
+    std::vector<PCMBuffer::Block*> blocks;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        blocks.swap(state_->free_blocks);
+    }
+    // 数据块持有池状态的引用，在锁外删除
+    for (PCMBuffer::Block* block : blocks) {
+        delete block;
+    }
+}
+
+size_t PCMBufferPool::getFreeCount() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free_blocks.size();
+}
+
+size_t PCMBufferPool::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    size_t bytes = 0;
+    for (const PCMBuffer::Block* block : state_->free_blocks) {
+        bytes += sizeof(PCMBuffer::Block) + block->capacity * sizeof(int16_t);
+    }
+    return bytes;
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,67 @@
+#include "../include/utils/PCMRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace plugin_h264 {
+
+PCMRingBuffer::PCMRingBuffer(size_t min_capacity, MemoryCounter* counter)
+    : buffer_(TrackingAllocator<int16_t>(counter))
+    , write_pos_(0)
+    , read_pos_(0) {
+    size_t capacity = 1;
+    while (capacity < min_capacity) {
+        capacity <<= 1;
+    }
+    buffer_.resize(capacity);
+    mask_ = capacity - 1;
+}
+
+size_t PCMRingBuffer::write(const int16_t* samples, size_t count) {
+    const size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    const size_t read_pos = read_pos_.load(std::memory_order_acquire);
+    count = std::min(count, buffer_.size() - (write_pos - read_pos));
+    if (count == 0) {
+        return 0;
+    }
+
+    // 最多分两段写入（跨越缓冲区末尾时回绕）
+    const size_t offset = write_pos & mask_;
+    const size_t first = std::min(count, buffer_.size() - offset);
+    memcpy(buffer_.data() + offset, samples, first * sizeof(int16_t));
+    memcpy(buffer_.data(), samples + first, (count - first) * sizeof(int16_t));
+
+    write_pos_.store(write_pos + count, std::memory_order_release);
+    return count;
+}
+
+size_t PCMRingBuffer::read(int16_t* samples, size_t count) {
+    const size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+    const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+    count = std::min(count, write_pos - read_pos);
+    if (count == 0) {
+        return 0;
+    }
+
+    const size_t offset = read_pos & mask_;
+    const size_t first = std::min(count, buffer_.size() - offset);
+    memcpy(samples, buffer_.data() + offset, first * sizeof(int16_t));
+    memcpy(samples + first, buffer_.data(), (count - first) * sizeof(int16_t));
+
+    read_pos_.store(read_pos + count, std::memory_order_release);
+    return count;
+}
+
+size_t PCMRingBuffer::available() const {
+    return write_pos_.load(std::memory_order_acquire) - read_pos_.load(std::memory_order_acquire);
+}
+
+size_t PCMRingBuffer::space() const {
+    return buffer_.size() - available();
+}
+
+void PCMRingBuffer::reset() {
+    write_pos_.store(0, std::memory_order_relaxed);
+    read_pos_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,115 @@
+#include "../include/utils/PerfStats.h"
+
+namespace plugin_h264 {
+
+const int PerfStageStats::kBucketCount;
+
+PerfStageStats::PerfStageStats() : count(0), total_ns(0), max_ns(0) {
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+double PerfStageStats::getMeanMs() const {
+    return count > 0 ? static_cast<double>(total_ns) / count / 1e6 : 0.0;
+}
+
+double PerfStageStats::getPercentileMs(double quantile) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    double target = quantile * static_cast<double>(count);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount - 1; ++i) {
+        seen += buckets[i];
+        if (buckets[i] > 0 && static_cast<double>(seen) >= target) {
+            double upper_ms = static_cast<double>(1ULL << i) / 1e3;
+            double max_ms = static_cast<double>(max_ns) / 1e6;
+            return upper_ms < max_ms ? upper_ms : max_ms;
+        }
+    }
+    return static_cast<double>(max_ns) / 1e6;
+}
+
+int PerfStats::getBucketIndex(uint64_t nanoseconds) {
+    uint64_t microseconds = nanoseconds / 1000;
+    int index = 0;
+    while (microseconds > 0 && index < PerfStageStats::kBucketCount - 1) {
+        microseconds >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+const char* PerfStats::getStageName(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::DEMUX:        return "demux";
+        case PerfStage::AVCC_CONVERT: return "avccConvert";
+        case PerfStage::H264_DECODE:  return "h264Decode";
+        case PerfStage::AAC_DECODE:   return "aacDecode";
+        case PerfStage::YUV_TO_RGBA:  return "yuvToRGBA";
+        case PerfStage::AUDIO_REFILL: return "audioRefill";
+        default:                      return "unknown";
+    }
+}
+
+#if PLUGIN_H264_ENABLE_PERF_STATS
+
+PerfStats::PerfStats() {
+    reset();
+}
+
+void PerfStats::record(PerfStage stage, uint64_t nanoseconds) {
+    StageCounters& counters = stages_[static_cast<int>(stage)];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+    counters.buckets[getBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max_ns = counters.max_ns.load(std::memory_order_relaxed);
+    while (nanoseconds > max_ns &&
+           !counters.max_ns.compare_exchange_weak(max_ns, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+PerfStageStats PerfStats::getStageStats(PerfStage stage) const {
+    const StageCounters& counters = stages_[static_cast<int>(stage)];
+    PerfStageStats stats;
+    stats.count = counters.count.load(std::memory_order_relaxed);
+    stats.total_ns = counters.total_ns.load(std::memory_order_relaxed);
+    stats.max_ns = counters.max_ns.load(std::memory_order_relaxed);
+    for (int i = 0; i < PerfStageStats::kBucketCount; ++i) {
+        stats.buckets[i] = counters.buckets[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void PerfStats::reset() {
+    for (auto& counters : stages_) {
+        counters.count.store(0, std::memory_order_relaxed);
+        counters.total_ns.store(0, std::memory_order_relaxed);
+        counters.max_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : counters.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+PerfStats::PerfStats() {
+}
+
+void PerfStats::record(PerfStage, uint64_t) {
+}
+
+PerfStageStats PerfStats::getStageStats(PerfStage) const {
+    return PerfStageStats();
+}
+
+void PerfStats::reset() {
+}
+
+#endif // PLUGIN_H264_ENABLE_PERF_STATS
+
+} // namespace plugin_h264
@@ -0,0 +1,233 @@
+#include "../include/utils/SPSParser.h"
+#include <algorithm>
+
+namespace plugin_h264 {
+
+namespace {
+
+const int kNALTypeSPS = 7;
+
+// RBSP位读取器，跳过 00 00 03 中的防竞争字节；越界后读取都返回0并置位overrun
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size)
+        : data_(data), size_(size), byte_(0), bit_(0), zeros_(0), current_(0), overrun_(false) {}
+
+    uint32_t readBit() {
+        if (bit_ == 0 && !advance()) {
+            overrun_ = true;
+            return 0;
+        }
+        --bit_;
+        return (current_ >> bit_) & 1;
+    }
+
+    uint32_t readBits(int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; ++i) {
+            value = (value << 1) | readBit();
+        }
+        return value;
+    }
+
+    // ue(v) 指数哥伦布码
+    uint32_t readUE() {
+        int leading_zeros = 0;
+        while (readBit() == 0) {
+            if (overrun_ || ++leading_zeros > 31) {
+                overrun_ = true;
+                return 0;
+            }
+        }
+        return leading_zeros == 0 ? 0 : (1u << leading_zeros) - 1 + readBits(leading_zeros);
+    }
+
+    int32_t readSE() {
+        uint32_t code = readUE();
+        return (code & 1) ? static_cast<int32_t>((code + 1) / 2) : -static_cast<int32_t>(code / 2);
+    }
+
+    bool overrun() const { return overrun_; }
+
+private:
+    bool advance() {
+        if (byte_ >= size_) {
+            return false;
+        }
+        if (zeros_ >= 2 && data_[byte_] == 0x03) {
+            zeros_ = 0;
+            if (++byte_ >= size_) {
+                return false;
+            }
+        }
+        current_ = data_[byte_++];
+        zeros_ = current_ == 0 ? zeros_ + 1 : 0;
+        bit_ = 8;
+        return true;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t byte_;
+    int bit_;
+    int zeros_;
+    uint8_t current_;
+    bool overrun_;
+};
+
+void skipScalingList(BitReader& reader, int size) {
+    int last_scale = 8;
+    int next_scale = 8;
+    for (int i = 0; i < size && next_scale != 0; ++i) {
+        next_scale = (last_scale + reader.readSE() + 256) % 256;
+        if (next_scale != 0) {
+            last_scale = next_scale;
+        }
+    }
+}
+
+// 带色度格式字段的High系列profile
+bool hasChromaFormat(int profile_idc) {
+    switch (profile_idc) {
+        case 100: case 110: case 122: case 244: case 44:
+        case 83: case 86: case 118: case 128: case 138: case 139: case 134: case 135:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+double SPSInfo::getFrameRate() const {
+    if (!timing_info_present || num_units_in_tick == 0 || time_scale == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(time_scale) / (2.0 * num_units_in_tick);
+}
+
+bool SPSParser::parse(const uint8_t* nal, size_t size, SPSInfo& info) {
+    if (nal == nullptr || size < 4 || (nal[0] & 0x1F) != kNALTypeSPS) {
+        return false;
+    }
+
+    BitReader reader(nal + 1, size - 1);
+    SPSInfo sps;
+    sps.profile_idc = static_cast<int>(reader.readBits(8));
+    reader.readBits(8);  // constraint_set标志
+    sps.level_idc = static_cast<int>(reader.readBits(8));
+    reader.readUE();     // seq_parameter_set_id
+
+    uint32_t chroma_format_idc = 1;
+    bool separate_colour_plane = false;
+    if (hasChromaFormat(sps.profile_idc)) {
+        chroma_format_idc = reader.readUE();
+        if (chroma_format_idc == 3) {
+            separate_colour_plane = reader.readBit() != 0;
+        }
+        reader.readUE();   // bit_depth_luma_minus8
+        reader.readUE();   // bit_depth_chroma_minus8
+        reader.readBit();  // qpprime_y_zero_transform_bypass_flag
+        if (reader.readBit()) {
+            // seq_scaling_matrix_present_flag
+            int lists = chroma_format_idc != 3 ? 8 : 12;
+            for (int i = 0; i < lists; ++i) {
+                if (reader.readBit()) {
+                    skipScalingList(reader, i < 6 ? 16 : 64);
+                }
+            }
+        }
+    }
+
+    reader.readUE();  // log2_max_frame_num_minus4
+    uint32_t pic_order_cnt_type = reader.readUE();
+    if (pic_order_cnt_type == 0) {
+        reader.readUE();  // log2_max_pic_order_cnt_lsb_minus4
+    } else if (pic_order_cnt_type == 1) {
+        reader.readBit();  // delta_pic_order_always_zero_flag
+        reader.readSE();   // offset_for_non_ref_pic
+        reader.readSE();   // offset_for_top_to_bottom_field
+        uint32_t cycle = reader.readUE();
+        if (cycle > 255) {
+            return false;
+        }
+        for (uint32_t i = 0; i < cycle; ++i) {
+            reader.readSE();
+        }
+    }
+
+    uint32_t max_num_ref_frames = reader.readUE();
+    reader.readBit();  // gaps_in_frame_num_value_allowed_flag
+    uint32_t width_in_mbs = reader.readUE() + 1;
+    uint32_t height_in_map_units = reader.readUE() + 1;
+    bool frame_mbs_only = reader.readBit() != 0;
+    if (!frame_mbs_only) {
+        reader.readBit();  // mb_adaptive_frame_field_flag
+    }
+    reader.readBit();  // direct_8x8_inference_flag
+
+    uint32_t crop_left = 0, crop_right = 0, crop_top = 0, crop_bottom = 0;
+    if (reader.readBit()) {
+        crop_left = reader.readUE();
+        crop_right = reader.readUE();
+        crop_top = reader.readUE();
+        crop_bottom = reader.readUE();
+    }
+
+    // 裁剪单位取决于色度采样格式（7.4.2.1.1）
+    uint32_t frame_height_factor = frame_mbs_only ? 1 : 2;
+    uint32_t crop_unit_x = 1;
+    uint32_t crop_unit_y = frame_height_factor;
+    if (chroma_format_idc != 0 && !separate_colour_plane) {
+        crop_unit_x = chroma_format_idc == 3 ? 1 : 2;
+        crop_unit_y = (chroma_format_idc == 1 ? 2 : 1) * frame_height_factor;
+    }
+
+    int64_t width = static_cast<int64_t>(width_in_mbs) * 16 -
+                    static_cast<int64_t>(crop_unit_x) * (crop_left + crop_right);
+    int64_t height = static_cast<int64_t>(height_in_map_units) * 16 * frame_height_factor -
+                     static_cast<int64_t>(crop_unit_y) * (crop_top + crop_bottom);
+    if (reader.overrun() || width <= 0 || height <= 0 || width > 16384 || height > 16384) {
+        return false;
+    }
+    sps.width = static_cast<int>(width);
+    sps.height = static_cast<int>(height);
+    sps.max_num_ref_frames = static_cast<int>(std::min<uint32_t>(max_num_ref_frames, 16));
+
+    // VUI：只读到timing_info为止
+    if (reader.readBit()) {
+        if (reader.readBit()) {
+            // aspect_ratio_info_present_flag
+            if (reader.readBits(8) == 255) {
+                reader.readBits(16);  // sar_width
+                reader.readBits(16);  // sar_height
+            }
+        }
+        if (reader.readBit()) {
+            reader.readBit();  // overscan_appropriate_flag
+        }
+        if (reader.readBit()) {
+            // video_signal_type_present_flag
+            reader.readBits(3);
+            reader.readBit();
+            if (reader.readBit()) {
+                reader.readBits(24);  // colour_primaries, transfer_characteristics, matrix_coefficients
+            }
+        }
+        if (reader.readBit()) {
+            reader.readUE();  // chroma_sample_loc_type_top_field
+            reader.readUE();  // chroma_sample_loc_type_bottom_field
+        }
+        if (reader.readBit()) {
+            sps.num_units_in_tick = reader.readBits(32);
+            sps.time_scale = reader.readBits(32);
+            sps.fixed_frame_rate = reader.readBit() != 0;
+            sps.timing_info_present = !reader.overrun();
+        }
+    }
+
+    info = sps;
+    return true;
+}
+
+} // namespace plugin_h264
@@ -0,0 +1,109 @@
+#include "../include/utils/WorkerPool.h"
+#include <algorithm>
+
+namespace plugin_h264 {
+
+WorkerPool::WorkerPool(int thread_count)
+    : task_(nullptr)
+    , task_count_(0)
+    , next_task_(0)
+    , busy_workers_(0)
+    , generation_(0)
+    , stopping_(false) {
+    int worker_count = std::max(0, thread_count - 1);
+    workers_.reserve(worker_count);
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int WorkerPool::resolveThreadCount(int requested) {
+    if (requested > 0) {
+        return std::min(requested, 16);
+    }
+    // 自动：留一个核心给渲染/Lua线程，最多4个线程
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores <= 1) {
+        return 1;
+    }
+    return static_cast<int>(std::min(cores - 1, 4u));
+}
+
+void WorkerPool::run(int task_count, const std::function<void(int)>& task) {
+    if (task_count <= 0) {
+        return;
+    }
+
+    if (workers_.empty() || task_count == 1) {
+        for (int i = 0; i < task_count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        task_count_ = task_count;
+        next_task_.store(0, std::memory_order_relaxed);
+        busy_workers_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    work_cv_.notify_all();
+
+    // 调用线程也参与执行
+    drainTasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkerPool::drainTasks() {
+    for (;;) {
+        int index = next_task_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= task_count_) {
+            break;
+        }
+        (*task_)(index);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    unsigned long seen_generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        drainTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
+
+} // namespace plugin_h264
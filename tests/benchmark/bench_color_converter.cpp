@@ -0,0 +1,80 @@
+// YUV420 -> RGBA 转换微基准测试
+// 输出每种实现在常见分辨率下的吞吐量（Mpixels/s）
+
+#include "utils/ColorConverter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+double measureMpixels(const VideoFrame& frame, std::vector<uint8_t>& rgba, bool reference, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        if (reference) {
+            ColorConverter::convertYUV420ToRGBAReference(frame, rgba.data(), frame.width * 4);
+        } else {
+            ColorConverter::convertYUV420ToRGBA(frame, rgba.data(), frame.width * 4);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double pixels = static_cast<double>(frame.width) * frame.height * iterations;
+    return pixels / seconds / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    const int sizes[][2] = { {1280, 720}, {1920, 1080}, {3840, 2160} };
+    const ColorConverter::Backend backends[] = {
+        ColorConverter::Backend::SCALAR, ColorConverter::Backend::SSE2,
+        ColorConverter::Backend::AVX2, ColorConverter::Backend::NEON
+    };
+
+    printf("Detected backend: %s\n", ColorConverter::backendName(ColorConverter::detectBackend()));
+    printf("%-12s %-10s %12s\n", "resolution", "backend", "Mpixels/s");
+
+    for (const auto& size : sizes) {
+        int width = size[0];
+        int height = size[1];
+        // 模拟解码器输出的stride填充
+        int y_stride = width + 64;
+        int uv_stride = width / 2 + 32;
+
+        std::vector<uint8_t> y(y_stride * height), u(uv_stride * height / 2), v(uv_stride * height / 2);
+        for (size_t i = 0; i < y.size(); ++i) y[i] = static_cast<uint8_t>(i * 7);
+        for (size_t i = 0; i < u.size(); ++i) { u[i] = static_cast<uint8_t>(i * 3); v[i] = static_cast<uint8_t>(i * 5); }
+
+        VideoFrame frame;
+        frame.y_plane = y.data();
+        frame.u_plane = u.data();
+        frame.v_plane = v.data();
+        frame.width = width;
+        frame.height = height;
+        frame.y_stride = y_stride;
+        frame.uv_stride = uv_stride;
+
+        std::vector<uint8_t> rgba(width * height * 4);
+        char resolution[32];
+        snprintf(resolution, sizeof(resolution), "%dx%d", width, height);
+
+        printf("%-12s %-10s %12.1f\n", resolution, "reference",
+               measureMpixels(frame, rgba, true, iterations / 5 + 1));
+
+        for (auto backend : backends) {
+            if (!ColorConverter::setBackend(backend)) {
+                continue;
+            }
+            printf("%-12s %-10s %12.1f\n", resolution, ColorConverter::backendName(backend),
+                   measureMpixels(frame, rgba, false, iterations));
+        }
+    }
+
+    ColorConverter::setBackend(ColorConverter::detectBackend());
+    return 0;
+}
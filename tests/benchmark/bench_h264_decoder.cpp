@@ -0,0 +1,134 @@
+// H.264 解码吞吐量基准测试
+// 用法：bench_h264_decoder <clip.mp4> [clip2.mp4 ...]
+// 样本预先读入内存，只统计解码时间，输出 1/2/4 个 OpenH264 线程下的 fps
+
+#include "decoders/H264Decoder.h"
+#include "decoders/MP4Demuxer.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 读取第一个H264视频轨道的全部样本并转换为Annex-B
+bool loadClip(const char* path, std::vector<std::vector<uint8_t>>& access_units,
+              std::vector<double>& timestamps, TrackInfo& video_track) {
+    MP4Demuxer demuxer;
+    if (!demuxer.open(path)) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, demuxer.getLastMessage().c_str());
+        return false;
+    }
+
+    bool found = false;
+    for (const auto& track : demuxer.getTrackInfo()) {
+        if (track.type == MP4TrackType::VIDEO && track.codec == CodecType::H264) {
+            video_track = track;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        fprintf(stderr, "No H264 track in %s\n", path);
+        return false;
+    }
+
+    const uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01};
+    std::vector<uint8_t> sps, pps;
+    if (demuxer.extractSPS(video_track.track_id, sps) && demuxer.extractPPS(video_track.track_id, pps)) {
+        std::vector<uint8_t> parameter_sets(start_code, start_code + 4);
+        parameter_sets.insert(parameter_sets.end(), sps.begin(), sps.end());
+        parameter_sets.insert(parameter_sets.end(), start_code, start_code + 4);
+        parameter_sets.insert(parameter_sets.end(), pps.begin(), pps.end());
+        access_units.push_back(parameter_sets);
+        timestamps.push_back(0.0);
+    }
+
+    double timescale = video_track.timescale > 0 ? video_track.timescale : 90000.0;
+    MP4Sample sample;
+    while (demuxer.readNextSample(video_track.track_id, sample)) {
+        std::vector<uint8_t> annexb;
+        annexb.reserve(sample.data.size() + 16);
+        size_t offset = 0;
+        while (offset + 4 <= sample.data.size()) {
+            uint32_t nal_length = (sample.data[offset] << 24) | (sample.data[offset + 1] << 16) |
+                                  (sample.data[offset + 2] << 8) | sample.data[offset + 3];
+            offset += 4;
+            if (nal_length > sample.data.size() - offset) break;
+            annexb.insert(annexb.end(), start_code, start_code + 4);
+            annexb.insert(annexb.end(), sample.data.begin() + offset, sample.data.begin() + offset + nal_length);
+            offset += nal_length;
+        }
+        access_units.push_back(annexb);
+        timestamps.push_back(sample.timestamp / timescale);
+    }
+    return true;
+}
+
+// 返回解码输出的帧数，顺带检查输出时间戳是否单调递增（重排序正确）
+int decodeAll(const std::vector<std::vector<uint8_t>>& access_units, const std::vector<double>& timestamps,
+              int thread_count, double& seconds, bool& ordered) {
+    H264DecoderConfig config;
+    config.thread_count = thread_count;
+    H264Decoder decoder;
+    if (!decoder.initialize(config)) {
+        fprintf(stderr, "Decoder init failed: %s\n", decoder.getLastMessage().c_str());
+        return 0;
+    }
+
+    int frames = 0;
+    double last_timestamp = -1.0;
+    ordered = true;
+    VideoFrame frame;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < access_units.size(); ++i) {
+        if (decoder.decode(access_units[i].data(), access_units[i].size(), frame, timestamps[i])) {
+            ordered = ordered && frame.timestamp > last_timestamp;
+            last_timestamp = frame.timestamp;
+            ++frames;
+        }
+    }
+    while (decoder.flush(frame)) {
+        ordered = ordered && frame.timestamp > last_timestamp;
+        last_timestamp = frame.timestamp;
+        ++frames;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <clip.mp4> [clip2.mp4 ...]\n", argv[0]);
+        return 1;
+    }
+
+    const int thread_counts[] = {1, 2, 4};
+    printf("%-32s %-12s %8s %8s %10s %8s\n", "clip", "resolution", "threads", "frames", "fps", "ordered");
+
+    for (int i = 1; i < argc; ++i) {
+        std::vector<std::vector<uint8_t>> access_units;
+        std::vector<double> timestamps;
+        TrackInfo track;
+        if (!loadClip(argv[i], access_units, timestamps, track)) {
+            continue;
+        }
+
+        char resolution[32];
+        snprintf(resolution, sizeof(resolution), "%ux%u", track.width, track.height);
+
+        for (int threads : thread_counts) {
+            double seconds = 0.0;
+            bool ordered = false;
+            int frames = decodeAll(access_units, timestamps, threads, seconds, ordered);
+            printf("%-32s %-12s %8d %8d %10.1f %8s\n", argv[i], resolution, threads, frames,
+                   seconds > 0.0 ? frames / seconds : 0.0, ordered ? "yes" : "NO");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+// MP4 seek 延迟基准测试
+// 用法：bench_mp4_seek [seeks]
+// 用minimp4在内存中封装 1/10/60 分钟的30fps轨道，比较原来逐样本调用
+// MP4D_frame_offset 的线性查找与样本索引二分查找的单次seek耗时
+
+#include "decoders/MP4Demuxer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+const unsigned kTimescale = 30000;
+const int kFrameDuration = 1000;  // 30fps
+
+int writeCallback(int64_t offset, const void* buffer, size_t size, void* token) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(token);
+    if (out->size() < offset + size) {
+        out->resize(offset + size);
+    }
+    memcpy(out->data() + offset, buffer, size);
+    return 0;
+}
+
+int readCallback(int64_t offset, void* buffer, size_t size, void* token) {
+    const std::vector<uint8_t>* data = static_cast<const std::vector<uint8_t>*>(token);
+    if (offset < 0 || static_cast<uint64_t>(offset) + size > data->size()) {
+        return 1;
+    }
+    memcpy(buffer, data->data() + offset, size);
+    return 0;
+}
+
+// 样本内容无关紧要，只需要真实的stts/stsc/stco表
+std::vector<uint8_t> buildFile(int samples) {
+    std::vector<uint8_t> file;
+    MP4E_mux_t* mux = MP4E_open(0, 0, &file, writeCallback);
+
+    MP4E_track_t track;
+    memset(&track, 0, sizeof(track));
+    track.track_media_kind = e_audio;
+    track.object_type_indication = MP4_OBJECT_TYPE_AUDIO_ISO_IEC_14496_3;
+    track.time_scale = kTimescale;
+    track.default_duration = kFrameDuration;
+    track.u.a.channelcount = 2;
+    int track_id = MP4E_add_track(mux, &track);
+
+    std::vector<uint8_t> payload(64, 0x5A);
+    for (int i = 0; i < samples; ++i) {
+        MP4E_put_sample(mux, track_id, payload.data(), static_cast<int>(payload.size()),
+                        kFrameDuration, MP4E_SAMPLE_RANDOM_ACCESS);
+    }
+
+    MP4E_close(mux);
+    return file;
+}
+
+// 原 seekToTime 的查找方式
+unsigned int linearSeek(const MP4D_demux_t* mp4, double seconds) {
+    uint64_t target = static_cast<uint64_t>(seconds * kTimescale);
+    unsigned int index = 0;
+    unsigned int frame_bytes, timestamp, duration;
+    while (index < mp4->track[0].sample_count) {
+        MP4D_frame_offset(mp4, 0, index, &frame_bytes, &timestamp, &duration);
+        if (frame_bytes == 0 || timestamp >= target) {
+            break;
+        }
+        index++;
+    }
+    return index;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seeks = argc > 1 ? atoi(argv[1]) : 200;
+    if (seeks <= 0) {
+        seeks = 200;
+    }
+
+    const int minutes[] = {1, 10, 60};
+    printf("%8s %10s %12s %14s %14s %10s\n", "minutes", "samples", "open(ms)", "linear(us)", "indexed(us)", "speedup");
+
+    for (int length : minutes) {
+        int samples = length * 60 * 30;
+        std::vector<uint8_t> file = buildFile(samples);
+        double duration = static_cast<double>(samples) * kFrameDuration / kTimescale;
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<double> dist(0.0, duration);
+        std::vector<double> targets(seeks);
+        for (double& target : targets) {
+            target = dist(rng);
+        }
+
+        // 索引查找，open时间包含建立样本表
+        MP4Demuxer demuxer;
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<MemorySource> source(new MemorySource());
+        source->open(file.data(), file.size(), MemoryOwnership::BORROW);
+        if (!demuxer.open(std::move(source))) {
+            fprintf(stderr, "Failed to open %d minute file: %s\n", length, demuxer.getLastMessage().c_str());
+            continue;
+        }
+        double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (double target : targets) {
+            demuxer.seekToTime(target);
+        }
+        double indexed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / seeks;
+
+        // 线性查找
+        MP4D_demux_t mp4;
+        memset(&mp4, 0, sizeof(mp4));
+        if (MP4D_open(&mp4, readCallback, &file, static_cast<int64_t>(file.size())) != 1) {
+            fprintf(stderr, "MP4D_open failed\n");
+            continue;
+        }
+        volatile unsigned int sink = 0;
+        start = std::chrono::steady_clock::now();
+        for (double target : targets) {
+            sink = sink + linearSeek(&mp4, target);
+        }
+        double linear_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / seeks;
+        MP4D_close(&mp4);
+
+        printf("%8d %10d %12.2f %14.2f %14.3f %9.0fx\n", length, samples, open_ms, linear_us, indexed_us,
+               indexed_us > 0.0 ? linear_us / indexed_us : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+// 逐帧轨道查找开销基准测试
+// 用法：bench_track_lookup [passes]
+// 用minimp4在内存中封装一个视频轨道和一个音频轨道，逐帧读取视频样本，
+// 比较原来每帧复制 getTrackInfo() 并遍历查找轨道与加载时缓存 TrackDescriptor 的耗时
+
+#include "decoders/MP4Demuxer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+const unsigned kTimescale = 30000;
+const int kFrameDuration = 1000;  // 30fps
+const int kFrames = 60 * 30;      // 1分钟
+
+int writeCallback(int64_t offset, const void* buffer, size_t size, void* token) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(token);
+    if (out->size() < offset + size) {
+        out->resize(offset + size);
+    }
+    memcpy(out->data() + offset, buffer, size);
+    return 0;
+}
+
+// 样本内容无关紧要，只需要能被识别为H264/AAC的轨道
+std::vector<uint8_t> buildFile() {
+    std::vector<uint8_t> file;
+    MP4E_mux_t* mux = MP4E_open(0, 0, &file, writeCallback);
+
+    MP4E_track_t video;
+    memset(&video, 0, sizeof(video));
+    video.track_media_kind = e_video;
+    video.object_type_indication = MP4_OBJECT_TYPE_AVC;
+    video.time_scale = kTimescale;
+    video.default_duration = kFrameDuration;
+    video.u.v.width = 1280;
+    video.u.v.height = 720;
+    int video_id = MP4E_add_track(mux, &video);
+
+    const uint8_t sps[] = {0x67, 0x42, 0xC0, 0x1F, 0xDA, 0x01, 0x40, 0x16, 0xE8};
+    const uint8_t pps[] = {0x68, 0xCE, 0x3C, 0x80};
+    MP4E_set_sps(mux, video_id, sps, sizeof(sps));
+    MP4E_set_pps(mux, video_id, pps, sizeof(pps));
+
+    MP4E_track_t audio;
+    memset(&audio, 0, sizeof(audio));
+    audio.track_media_kind = e_audio;
+    audio.object_type_indication = MP4_OBJECT_TYPE_AUDIO_ISO_IEC_14496_3;
+    audio.time_scale = 48000;
+    audio.default_duration = 1024;
+    audio.u.a.channelcount = 2;
+    int audio_id = MP4E_add_track(mux, &audio);
+
+    const uint8_t asc[] = {0x11, 0x90};
+    MP4E_set_dsi(mux, audio_id, asc, sizeof(asc));
+
+    std::vector<uint8_t> frame(2048, 0x5A);
+    std::vector<uint8_t> packet(256, 0x21);
+    for (int i = 0; i < kFrames; ++i) {
+        MP4E_put_sample(mux, video_id, frame.data(), static_cast<int>(frame.size()),
+                        kFrameDuration, i % 30 == 0 ? MP4E_SAMPLE_RANDOM_ACCESS : MP4E_SAMPLE_DEFAULT);
+        MP4E_put_sample(mux, audio_id, packet.data(), static_cast<int>(packet.size()),
+                        1024, MP4E_SAMPLE_RANDOM_ACCESS);
+    }
+
+    MP4E_close(mux);
+    return file;
+}
+
+// 原 decodeVideoAccessUnit 的查找方式：每帧复制轨道列表并遍历
+bool readWithLookup(Demuxer& demuxer, MP4SampleView& sample) {
+    auto track_info = demuxer.getTrackInfo();
+    for (size_t i = 0; i < track_info.size(); ++i) {
+        const auto& track = track_info[i];
+        if (track.type == MP4TrackType::VIDEO && track.codec == CodecType::H264) {
+            return demuxer.readNextSample(track.track_id, sample);
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int passes = argc > 1 ? atoi(argv[1]) : 50;
+    if (passes <= 0) {
+        passes = 50;
+    }
+
+    std::vector<uint8_t> file = buildFile();
+    std::unique_ptr<MemorySource> source(new MemorySource());
+    source->open(file.data(), file.size(), MemoryOwnership::BORROW);
+
+    MP4Demuxer demuxer;
+    if (!demuxer.open(std::move(source))) {
+        fprintf(stderr, "Failed to open file: %s\n", demuxer.getLastMessage().c_str());
+        return 1;
+    }
+
+    TrackDescriptor video;
+    if (!demuxer.findTrack(MP4TrackType::VIDEO, CodecType::H264, video)) {
+        fprintf(stderr, "No H264 track\n");
+        return 1;
+    }
+
+    MP4SampleView sample;
+    volatile size_t sink = 0;
+    size_t frames = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        demuxer.seekToTime(0.0);
+        while (readWithLookup(demuxer, sample)) {
+            sink = sink + sample.size;
+            ++frames;
+        }
+    }
+    double lookup_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    frames = 0;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        demuxer.seekToTime(0.0);
+        while (demuxer.readNextSample(video.info.track_id, sample)) {
+            sink = sink + sample.size;
+            ++frames;
+        }
+    }
+    double cached_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    printf("%10s %16s %16s %14s\n", "frames", "lookup(ns/frm)", "cached(ns/frm)", "saved(ns/frm)");
+    printf("%10zu %16.1f %16.1f %14.1f\n", frames, lookup_ns, cached_ns, lookup_ns - cached_ns);
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include <gtest/gtest.h>
+#include "decoders/AnnexBDemuxer.h"
+#include "decoders/DemuxerFactory.h"
+#include "utils/SPSParser.h"
+#include <cstring>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 内存字节源，view_enabled 为false时模拟不支持零拷贝的后端，complete 为false时模拟下载中的文件
+class TestSource : public ByteSource {
+public:
+    TestSource(const std::vector<uint8_t>& data, bool view_enabled, bool complete = true)
+        : data_(data), view_enabled_(view_enabled), complete_(complete) {}
+
+    int64_t size() const override { return static_cast<int64_t>(data_.size()); }
+
+    bool read(int64_t offset, void* buffer, size_t length) override {
+        if (offset < 0 || static_cast<uint64_t>(offset) + length > data_.size()) {
+            return false;
+        }
+        memcpy(buffer, data_.data() + offset, length);
+        return true;
+    }
+
+    const uint8_t* view(int64_t offset, size_t length) const override {
+        if (!view_enabled_ || offset < 0 || static_cast<uint64_t>(offset) + length > data_.size()) {
+            return nullptr;
+        }
+        return data_.data() + offset;
+    }
+
+    bool isComplete() const override { return complete_; }
+
+private:
+    std::vector<uint8_t> data_;
+    bool view_enabled_;
+    bool complete_;
+};
+
+// 按位写RBSP，输出时插入防竞争字节
+class BitWriter {
+public:
+    BitWriter() : bits_(0) {}
+
+    void u(int count, uint32_t value) {
+        for (int i = count - 1; i >= 0; --i) {
+            if (bits_ % 8 == 0) {
+                rbsp_.push_back(0);
+            }
+            rbsp_.back() |= ((value >> i) & 1) << (7 - bits_ % 8);
+            ++bits_;
+        }
+    }
+
+    void ue(uint32_t value) {
+        uint32_t code = value + 1;
+        int length = 0;
+        while ((code >> length) > 1) {
+            ++length;
+        }
+        u(length, 0);
+        u(length + 1, code);
+    }
+
+    // rbsp_trailing_bits 后加上NAL头并插入防竞争字节
+    std::vector<uint8_t> nal(uint8_t header) {
+        u(1, 1);
+        while (bits_ % 8 != 0) {
+            u(1, 0);
+        }
+
+        std::vector<uint8_t> out(1, header);
+        int zeros = 0;
+        for (uint8_t byte : rbsp_) {
+            if (zeros >= 2 && byte <= 3) {
+                out.push_back(0x03);
+                zeros = 0;
+            }
+            out.push_back(byte);
+            zeros = byte == 0 ? zeros + 1 : 0;
+        }
+        return out;
+    }
+
+private:
+    std::vector<uint8_t> rbsp_;
+    int bits_;
+};
+
+// High profile 1920x1080（68行宏块，底部裁剪8行），VUI中 time_scale / (2 * num_units_in_tick) 为帧率
+std::vector<uint8_t> buildSPS(uint32_t num_units_in_tick, uint32_t time_scale) {
+    BitWriter w;
+    w.u(8, 100);  // profile_idc
+    w.u(8, 0);
+    w.u(8, 40);   // level_idc
+    w.ue(0);      // seq_parameter_set_id
+    w.ue(1);      // chroma_format_idc 4:2:0
+    w.ue(0);
+    w.ue(0);
+    w.u(1, 0);
+    w.u(1, 0);    // seq_scaling_matrix_present_flag
+    w.ue(0);      // log2_max_frame_num_minus4
+    w.ue(0);      // pic_order_cnt_type
+    w.ue(2);
+    w.ue(4);      // max_num_ref_frames
+    w.u(1, 0);
+    w.ue(119);    // pic_width_in_mbs_minus1
+    w.ue(67);     // pic_height_in_map_units_minus1
+    w.u(1, 1);    // frame_mbs_only_flag
+    w.u(1, 1);
+    w.u(1, 1);    // frame_cropping_flag
+    w.ue(0);
+    w.ue(0);
+    w.ue(0);
+    w.ue(4);      // frame_crop_bottom_offset，4:2:0 单位为2行
+    w.u(1, time_scale != 0);  // vui_parameters_present_flag
+    if (time_scale != 0) {
+        w.u(1, 0);
+        w.u(1, 0);
+        w.u(1, 0);
+        w.u(1, 0);
+        w.u(1, 1);  // timing_info_present_flag
+        w.u(32, num_units_in_tick);
+        w.u(32, time_scale);
+        w.u(1, 1);
+    }
+    return w.nal(0x67);
+}
+
+void appendNAL(std::vector<uint8_t>& stream, const std::vector<uint8_t>& nal, bool long_start_code = true) {
+    if (long_start_code) {
+        stream.push_back(0x00);
+    }
+    stream.insert(stream.end(), {0x00, 0x00, 0x01});
+    stream.insert(stream.end(), nal.begin(), nal.end());
+}
+
+// 片NAL：第二个字节的最高位为1表示 first_mb_in_slice == 0
+std::vector<uint8_t> slice(uint8_t header, bool first_in_picture, size_t size = 16) {
+    std::vector<uint8_t> nal(size, 0xAB);
+    nal[0] = header;
+    nal[1] = first_in_picture ? 0x88 : 0x40;
+    return nal;
+}
+
+const std::vector<uint8_t> kPPS = {0x68, 0xEE, 0x3C, 0x80};
+
+} // namespace
+
+TEST(SPSParserTest, ReadsCroppedSizeAndTiming) {
+    // num_units_in_tick = 1 编码为 00 00 00 01，需要防竞争字节
+    std::vector<uint8_t> sps = buildSPS(1, 60);
+    bool has_emulation_prevention = false;
+    for (size_t i = 2; i < sps.size(); ++i) {
+        has_emulation_prevention = has_emulation_prevention || (sps[i - 2] == 0 && sps[i - 1] == 0 && sps[i] == 3);
+    }
+    ASSERT_TRUE(has_emulation_prevention);
+
+    SPSInfo info;
+    ASSERT_TRUE(SPSParser::parse(sps.data(), sps.size(), info));
+    EXPECT_EQ(info.profile_idc, 100);
+    EXPECT_EQ(info.level_idc, 40);
+    EXPECT_EQ(info.width, 1920);
+    EXPECT_EQ(info.height, 1080);
+    EXPECT_EQ(info.max_num_ref_frames, 4);
+    EXPECT_TRUE(info.timing_info_present);
+    EXPECT_DOUBLE_EQ(info.getFrameRate(), 30.0);
+
+    SPSInfo no_vui;
+    std::vector<uint8_t> plain = buildSPS(0, 0);
+    ASSERT_TRUE(SPSParser::parse(plain.data(), plain.size(), no_vui));
+    EXPECT_FALSE(no_vui.timing_info_present);
+    EXPECT_DOUBLE_EQ(no_vui.getFrameRate(), 0.0);
+
+    // 截断或不是SPS
+    EXPECT_FALSE(SPSParser::parse(sps.data(), 6, info));
+    EXPECT_FALSE(SPSParser::parse(kPPS.data(), kPPS.size(), info));
+}
+
+TEST(AnnexBDemuxerTest, SplitsAccessUnitsAndSynthesizesTimestamps) {
+    std::vector<uint8_t> sps = buildSPS(1, 60);
+    std::vector<uint8_t> stream;
+    std::vector<size_t> starts;
+
+    // 0: SPS PPS IDR(两个片)
+    starts.push_back(stream.size());
+    appendNAL(stream, sps);
+    appendNAL(stream, kPPS);
+    appendNAL(stream, slice(0x65, true));
+    appendNAL(stream, slice(0x65, false), false);
+    // 1: P   2: 非参考P（3字节起始码）
+    starts.push_back(stream.size());
+    appendNAL(stream, slice(0x41, true));
+    starts.push_back(stream.size());
+    appendNAL(stream, slice(0x01, true), false);
+    // 3: AUD SEI IDR   4: P
+    starts.push_back(stream.size());
+    appendNAL(stream, {0x09, 0xF0});
+    appendNAL(stream, {0x06, 0x05, 0x01, 0x80});
+    appendNAL(stream, slice(0x65, true));
+    starts.push_back(stream.size());
+    appendNAL(stream, slice(0x41, true));
+    // 结尾没有片的SEI不构成访问单元
+    size_t end = stream.size();
+    appendNAL(stream, {0x06, 0x05, 0x01, 0x80});
+
+    AnnexBDemuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(stream, true))));
+
+    std::vector<TrackInfo> tracks = demuxer.getTrackInfo();
+    ASSERT_EQ(tracks.size(), 1u);
+    EXPECT_EQ(tracks[0].codec, CodecType::H264);
+    EXPECT_EQ(tracks[0].width, 1920u);
+    EXPECT_EQ(tracks[0].height, 1080u);
+    EXPECT_DOUBLE_EQ(demuxer.getFrameRate(), 30.0);
+    EXPECT_NEAR(demuxer.getDuration(), 5 / 30.0, 1e-9);
+
+    CodecConfig config;
+    ASSERT_TRUE(demuxer.getCodecConfig(0, config));
+    EXPECT_EQ(config.codec, CodecType::H264);
+    EXPECT_EQ(config.nal_length_size, 0);
+    EXPECT_TRUE(config.dsi.empty());
+    ASSERT_EQ(config.parameter_sets.size(), 2u);
+    EXPECT_EQ(config.parameter_sets[0], sps);
+    EXPECT_EQ(config.parameter_sets[1], kPPS);
+    EXPECT_FALSE(demuxer.getCodecConfig(1, config));
+
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->count(), 5u);
+    EXPECT_EQ(index->sync_samples, TrackedVector<uint32_t>({0, 3}));
+
+    starts.push_back(end);
+    MP4SampleView view;
+    for (size_t i = 0; i < 5; ++i) {
+        ASSERT_TRUE(demuxer.readNextSample(0, view));
+        ASSERT_EQ(view.size, starts[i + 1] - starts[i]);
+        EXPECT_EQ(0, memcmp(view.data, stream.data() + starts[i], view.size));
+        EXPECT_EQ(view.timestamp, i * 3000u);
+        EXPECT_EQ(view.duration, 3000u);
+        EXPECT_EQ(view.is_keyframe, i == 0 || i == 3);
+    }
+    EXPECT_FALSE(demuxer.readNextSample(0, view));
+    EXPECT_FALSE(demuxer.readNextSample(1, view));
+
+    // 0.12s 落在样本4（0.133s）之前，退回到IDR样本3
+    ASSERT_TRUE(demuxer.seekToTime(0.12));
+    EXPECT_EQ(demuxer.getNextSampleNumber(0), 3u);
+
+    std::vector<uint8_t> buffer;
+    ASSERT_TRUE(demuxer.readNextSampleInto(0, buffer, view));
+    EXPECT_EQ(view.data, buffer.data());
+    EXPECT_EQ(0, memcmp(buffer.data(), stream.data() + starts[3], view.size));
+}
+
+TEST(AnnexBDemuxerTest, ConfiguredFrameRateOverridesVUI) {
+    std::vector<uint8_t> stream;
+    appendNAL(stream, buildSPS(0, 0));
+    appendNAL(stream, kPPS);
+    for (int i = 0; i < 3; ++i) {
+        appendNAL(stream, slice(i == 0 ? 0x65 : 0x41, true));
+    }
+
+    AnnexBDemuxer defaults;
+    ASSERT_TRUE(defaults.open(std::unique_ptr<ByteSource>(new TestSource(stream, true))));
+    EXPECT_DOUBLE_EQ(defaults.getFrameRate(), AnnexBDemuxer::kDefaultFrameRate);
+
+    // 29.97fps：时间戳按帧序号取整，不累积误差
+    AnnexBDemuxer ntsc;
+    ntsc.setFrameRate(30000.0 / 1001.0);
+    ASSERT_TRUE(ntsc.open(std::unique_ptr<ByteSource>(new TestSource(stream, true))));
+    const SampleIndex* index = ntsc.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->timestamps, TrackedVector<uint64_t>({0, 3003, 6006}));
+
+    std::vector<uint8_t> garbage(64, 0xFF);
+    AnnexBDemuxer invalid;
+    EXPECT_FALSE(invalid.open(std::unique_ptr<ByteSource>(new TestSource(garbage, true))));
+}
+
+TEST(AnnexBDemuxerTest, ChunkedScanMatchesMappedScan) {
+    // 第二个访问单元的4字节起始码跨越1MB扫描块的边界
+    std::vector<uint8_t> stream;
+    appendNAL(stream, buildSPS(1, 50));
+    appendNAL(stream, kPPS);
+    size_t boundary = 1 << 20;
+    appendNAL(stream, slice(0x65, true, boundary - 1 - stream.size() - 4));
+    ASSERT_EQ(stream.size(), boundary - 1);
+    appendNAL(stream, slice(0x41, true, 300000));
+    appendNAL(stream, slice(0x41, true));
+
+    AnnexBDemuxer mapped;
+    AnnexBDemuxer chunked;
+    ASSERT_TRUE(mapped.open(std::unique_ptr<ByteSource>(new TestSource(stream, true))));
+    ASSERT_TRUE(chunked.open(std::unique_ptr<ByteSource>(new TestSource(stream, false))));
+
+    const SampleIndex* a = mapped.getSampleIndex(0);
+    const SampleIndex* b = chunked.getSampleIndex(0);
+    ASSERT_EQ(a->count(), 3u);
+    EXPECT_EQ(a->offsets, b->offsets);
+    EXPECT_EQ(a->sizes, b->sizes);
+    EXPECT_EQ(a->offsets[1], boundary - 1);
+    EXPECT_DOUBLE_EQ(chunked.getFrameRate(), 25.0);
+}
+
+TEST(AnnexBDemuxerTest, FindTrackResolvesDescriptor) {
+    std::vector<uint8_t> sps = buildSPS(1, 60);
+    std::vector<uint8_t> stream;
+    appendNAL(stream, sps);
+    appendNAL(stream, kPPS);
+    appendNAL(stream, slice(0x65, true));
+    appendNAL(stream, slice(0x41, true));
+
+    AnnexBDemuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(stream, true))));
+
+    TrackDescriptor video;
+    ASSERT_TRUE(demuxer.findTrack(MP4TrackType::VIDEO, CodecType::H264, video));
+    EXPECT_TRUE(video.isValid());
+    EXPECT_EQ(video.info.track_id, 0);
+    EXPECT_DOUBLE_EQ(video.timescale, AnnexBDemuxer::kTimescale);
+    EXPECT_NEAR(video.toSeconds(3000), 1 / 30.0, 1e-9);
+    ASSERT_EQ(video.config.parameter_sets.size(), 2u);
+    EXPECT_EQ(video.config.parameter_sets[0], sps);
+
+    TrackDescriptor audio;
+    EXPECT_FALSE(demuxer.findTrack(MP4TrackType::AUDIO, CodecType::AAC, audio));
+    EXPECT_FALSE(audio.isValid());
+
+    // 样本索引的内存由分配器记账，关闭后全部释放
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(demuxer.getIndexMemoryUsage(), index->getMemoryUsage());
+    EXPECT_GT(demuxer.getIndexMemoryUsage(), 0u);
+    demuxer.close();
+    EXPECT_EQ(demuxer.getIndexMemoryUsage(), 0u);
+}
+
+TEST(DemuxerFactoryTest, SniffsContainerFromContent) {
+    const uint8_t ftyp[] = {0x00, 0x00, 0x00, 0x18, 'f', 't', 'y', 'p', 'i', 's', 'o', 'm'};
+    const uint8_t moof[] = {0x00, 0x00, 0x01, 0x40, 'm', 'o', 'o', 'f'};
+    const uint8_t large_mdat[] = {0x00, 0x00, 0x00, 0x01, 'm', 'd', 'a', 't'};
+    EXPECT_EQ(DemuxerFactory::sniff(ftyp, sizeof(ftyp)), ContainerFormat::MP4);
+    // box大小以 00 00 01 开头，不能被当作起始码
+    EXPECT_EQ(DemuxerFactory::sniff(moof, sizeof(moof)), ContainerFormat::MP4);
+    EXPECT_EQ(DemuxerFactory::sniff(large_mdat, sizeof(large_mdat)), ContainerFormat::MP4);
+
+    const uint8_t short_start[] = {0x00, 0x00, 0x01, 0x67, 0x42};
+    const uint8_t long_start[] = {0x00, 0x00, 0x00, 0x01, 0x09, 0xF0};
+    EXPECT_EQ(DemuxerFactory::sniff(short_start, sizeof(short_start)), ContainerFormat::ANNEXB);
+    EXPECT_EQ(DemuxerFactory::sniff(long_start, sizeof(long_start)), ContainerFormat::ANNEXB);
+
+    // forbidden_zero_bit 置位、NAL类型为0、box头不完整都无法识别
+    const uint8_t forbidden[] = {0x00, 0x00, 0x01, 0xE7};
+    const uint8_t zero_type[] = {0x00, 0x00, 0x01, 0x60};
+    const uint8_t bad_box[] = {0x00, 0x00, 0x00, 0x04, 'f', 't', 'y', 'p'};
+    EXPECT_EQ(DemuxerFactory::sniff(forbidden, sizeof(forbidden)), ContainerFormat::UNKNOWN);
+    EXPECT_EQ(DemuxerFactory::sniff(zero_type, sizeof(zero_type)), ContainerFormat::UNKNOWN);
+    EXPECT_EQ(DemuxerFactory::sniff(bad_box, sizeof(bad_box)), ContainerFormat::UNKNOWN);
+    EXPECT_EQ(DemuxerFactory::sniff(nullptr, 0), ContainerFormat::UNKNOWN);
+}
+
+TEST(DemuxerFactoryTest, OpensAnnexBStreamWithOptions) {
+    std::vector<uint8_t> stream;
+    appendNAL(stream, buildSPS(0, 0));
+    appendNAL(stream, kPPS);
+    appendNAL(stream, slice(0x65, true));
+    appendNAL(stream, slice(0x41, true));
+
+    DemuxerOptions options;
+    options.frame_rate = 50.0;
+    std::string error;
+    std::unique_ptr<Demuxer> demuxer =
+        DemuxerFactory::open(std::unique_ptr<ByteSource>(new TestSource(stream, true)), options, error);
+    ASSERT_NE(demuxer, nullptr) << error;
+    EXPECT_NEAR(demuxer->getDuration(), 2 / 50.0, 1e-9);
+
+    CodecConfig config;
+    ASSERT_TRUE(demuxer->getCodecConfig(0, config));
+    EXPECT_EQ(config.nal_length_size, 0);
+
+    // 裸码流需要完整文件才能建立索引
+    demuxer = DemuxerFactory::open(std::unique_ptr<ByteSource>(new TestSource(stream, true, false)), options, error);
+    EXPECT_EQ(demuxer, nullptr);
+    EXPECT_FALSE(error.empty());
+
+    std::vector<uint8_t> garbage(64, 0xFF);
+    demuxer = DemuxerFactory::open(std::unique_ptr<ByteSource>(new TestSource(garbage, true)), options, error);
+    EXPECT_EQ(demuxer, nullptr);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "utils/ByteSource.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace plugin_h264;
+
+class ByteSourceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "plugin_h264_byte_source.bin";
+        data_.resize(4096);
+        for (size_t i = 0; i < data_.size(); ++i) {
+            data_[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+        std::ofstream out(path_, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data_.data()), data_.size());
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    std::string path_;
+    std::vector<uint8_t> data_;
+};
+
+TEST_F(ByteSourceTest, MappedAndStreamReadSameBytes) {
+    auto mapped = openFileSource(path_, true);
+    auto stream = openFileSource(path_, false);
+    ASSERT_NE(mapped, nullptr);
+    ASSERT_NE(stream, nullptr);
+    EXPECT_EQ(mapped->size(), static_cast<int64_t>(data_.size()));
+    EXPECT_EQ(stream->size(), static_cast<int64_t>(data_.size()));
+
+    // 读到文件末尾后再向前读，ifstream后端需要清除eof
+    std::vector<uint8_t> a(100), b(100);
+    ASSERT_TRUE(stream->read(data_.size() - 100, b.data(), b.size()));
+    ASSERT_TRUE(mapped->read(1000, a.data(), a.size()));
+    ASSERT_TRUE(stream->read(1000, b.data(), b.size()));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(0, memcmp(a.data(), data_.data() + 1000, a.size()));
+}
+
+TEST_F(ByteSourceTest, RejectsOutOfRangeReads) {
+    auto stream = openFileSource(path_, false);
+    ASSERT_NE(stream, nullptr);
+
+    uint8_t byte = 0;
+    EXPECT_FALSE(stream->read(-1, &byte, 1));
+    EXPECT_FALSE(stream->read(data_.size(), &byte, 1));
+    EXPECT_FALSE(stream->read(data_.size() - 1, &byte, 2));
+    EXPECT_EQ(stream->view(0, 1), nullptr);  // ifstream后端不支持零拷贝
+}
+
+#if !defined(_WIN32)
+TEST_F(ByteSourceTest, MappedViewIsZeroCopy) {
+    MappedFileSource source;
+    ASSERT_TRUE(source.open(path_));
+
+    const uint8_t* view = source.view(16, 32);
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(0, memcmp(view, data_.data() + 16, 32));
+    EXPECT_EQ(source.view(0, 0) + 16, view);
+    EXPECT_EQ(source.view(data_.size() - 4, 8), nullptr);
+
+    source.close();
+    EXPECT_EQ(source.view(0, 0), nullptr);
+}
+#endif
+
+TEST(ByteSourceOpenTest, MissingFileReturnsNull) {
+    EXPECT_EQ(openFileSource("/nonexistent/plugin_h264.mp4"), nullptr);
+}
+
+TEST_F(ByteSourceTest, GrowingSourceFollowsBytesAvailable) {
+    int64_t reported = 1000;
+    bool done = false;
+    GrowingFileSource source;
+    ASSERT_TRUE(source.open(path_, [&](bool& complete) {
+        complete = done;
+        return reported;
+    }));
+    EXPECT_EQ(source.size(), 1000);
+    EXPECT_FALSE(source.isComplete());
+
+    // 还没有报告的部分不可读
+    uint8_t byte = 0;
+    EXPECT_FALSE(source.read(1000, &byte, 1));
+    ASSERT_TRUE(source.read(999, &byte, 1));
+    EXPECT_EQ(byte, data_[999]);
+
+    // 回调报告的长度不会超过磁盘上的文件
+    reported = 1 << 20;
+    EXPECT_TRUE(source.refresh());
+    EXPECT_EQ(source.size(), static_cast<int64_t>(data_.size()));
+    EXPECT_FALSE(source.refresh());
+
+    done = true;
+    EXPECT_TRUE(source.refresh());
+    EXPECT_TRUE(source.isComplete());
+    EXPECT_FALSE(source.refresh());
+}
+
+TEST_F(ByteSourceTest, GrowingSourceSeesAppendedData) {
+    GrowingFileSource source;
+    ASSERT_TRUE(source.open(path_, [](bool&) { return int64_t(-1); }));
+    EXPECT_EQ(source.size(), static_cast<int64_t>(data_.size()));
+
+    {
+        std::ofstream out(path_, std::ios::binary | std::ios::app);
+        uint8_t tail[16] = {0xAB};
+        out.write(reinterpret_cast<const char*>(tail), sizeof(tail));
+    }
+
+    EXPECT_TRUE(source.refresh());
+    EXPECT_EQ(source.size(), static_cast<int64_t>(data_.size() + 16));
+    uint8_t byte = 0;
+    ASSERT_TRUE(source.read(data_.size(), &byte, 1));
+    EXPECT_EQ(byte, 0xAB);
+}
+
+TEST_F(ByteSourceTest, GrowingSourceWithoutCallbackIsComplete) {
+    GrowingFileSource source;
+    ASSERT_TRUE(source.open(path_, nullptr));
+    EXPECT_TRUE(source.isComplete());
+    EXPECT_EQ(source.size(), static_cast<int64_t>(data_.size()));
+}
+
+TEST(MemorySourceTest, BorrowedBufferIsNotCopied) {
+    std::vector<uint8_t> data(256);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i);
+    }
+
+    MemorySource source;
+    ASSERT_TRUE(source.open(data.data(), data.size(), MemoryOwnership::BORROW));
+    EXPECT_EQ(source.size(), static_cast<int64_t>(data.size()));
+    EXPECT_TRUE(source.isComplete());
+    EXPECT_EQ(source.view(10, 20), data.data() + 10);
+    EXPECT_EQ(source.view(250, 8), nullptr);
+
+    uint8_t bytes[4] = {};
+    ASSERT_TRUE(source.read(252, bytes, sizeof(bytes)));
+    EXPECT_EQ(bytes[3], 255);
+    EXPECT_FALSE(source.read(253, bytes, sizeof(bytes)));
+
+    source.close();
+    EXPECT_EQ(source.size(), 0);
+    EXPECT_EQ(source.view(0, 1), nullptr);
+}
+
+TEST(MemorySourceTest, CopiedBufferOutlivesCaller) {
+    std::vector<uint8_t> data(64, 0x5A);
+
+    MemorySource source;
+    ASSERT_TRUE(source.open(data.data(), data.size(), MemoryOwnership::COPY));
+    const uint8_t* view = source.view(0, data.size());
+    ASSERT_NE(view, nullptr);
+    EXPECT_NE(view, data.data());
+
+    // 调用方修改或释放自己的缓冲区不影响字节源
+    std::fill(data.begin(), data.end(), 0);
+    data.clear();
+    data.shrink_to_fit();
+    EXPECT_EQ(view[63], 0x5A);
+
+    EXPECT_FALSE(source.open(nullptr, 16, MemoryOwnership::BORROW));
+    EXPECT_EQ(source.size(), 0);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "utils/ColorConverter.h"
+#include "utils/WorkerPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 带stride填充的测试帧
+struct TestFrame {
+    std::vector<uint8_t> y, u, v;
+    VideoFrame frame;
+
+    TestFrame(int width, int height, int y_pad, int uv_pad, unsigned int seed) {
+        int y_stride = width + y_pad;
+        int uv_stride = (width + 1) / 2 + uv_pad;
+        int uv_height = (height + 1) / 2;
+        y.resize(y_stride * height);
+        u.resize(uv_stride * uv_height);
+        v.resize(uv_stride * uv_height);
+
+        srand(seed);
+        for (auto& b : y) b = static_cast<uint8_t>(rand() & 0xFF);
+        for (auto& b : u) b = static_cast<uint8_t>(rand() & 0xFF);
+        for (auto& b : v) b = static_cast<uint8_t>(rand() & 0xFF);
+
+        frame.y_plane = y.data();
+        frame.u_plane = u.data();
+        frame.v_plane = v.data();
+        frame.width = width;
+        frame.height = height;
+        frame.y_stride = y_stride;
+        frame.uv_stride = uv_stride;
+    }
+};
+
+std::vector<ColorConverter::Backend> supportedBackends() {
+    std::vector<ColorConverter::Backend> result;
+    const ColorConverter::Backend all[] = {
+        ColorConverter::Backend::SCALAR, ColorConverter::Backend::SSE2,
+        ColorConverter::Backend::AVX2, ColorConverter::Backend::NEON
+    };
+    for (auto backend : all) {
+        if (ColorConverter::isBackendSupported(backend)) {
+            result.push_back(backend);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+class ColorConverterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        saved_backend_ = ColorConverter::activeBackend();
+    }
+
+    void TearDown() override {
+        ColorConverter::setBackend(saved_backend_);
+    }
+
+    ColorConverter::Backend saved_backend_;
+};
+
+TEST_F(ColorConverterTest, ScalarBackendAlwaysSupported) {
+    EXPECT_TRUE(ColorConverter::isBackendSupported(ColorConverter::Backend::SCALAR));
+    EXPECT_TRUE(ColorConverter::isBackendSupported(ColorConverter::detectBackend()));
+}
+
+TEST_F(ColorConverterTest, MatchesReferenceWithinRounding) {
+    // 定点实现与原浮点实现之间只允许舍入误差
+    const int sizes[][2] = { {64, 32}, {1920, 8}, {33, 17}, {17, 3}, {1, 1} };
+    for (auto backend : supportedBackends()) {
+        ASSERT_TRUE(ColorConverter::setBackend(backend));
+        for (const auto& size : sizes) {
+            TestFrame input(size[0], size[1], 13, 7, 42);
+            std::vector<uint8_t> expected(size[0] * size[1] * 4);
+            std::vector<uint8_t> actual(size[0] * size[1] * 4);
+
+            ColorConverter::convertYUV420ToRGBAReference(input.frame, expected.data(), size[0] * 4);
+            ColorConverter::convertYUV420ToRGBA(input.frame, actual.data(), size[0] * 4);
+
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_LE(std::abs(expected[i] - actual[i]), 1)
+                    << ColorConverter::backendName(backend) << " " << size[0] << "x" << size[1]
+                    << " byte " << i;
+            }
+        }
+    }
+}
+
+TEST_F(ColorConverterTest, SimdBackendsMatchScalarExactly) {
+    TestFrame input(1000, 30, 24, 12, 7);
+    std::vector<uint8_t> scalar(1000 * 30 * 4);
+    ASSERT_TRUE(ColorConverter::setBackend(ColorConverter::Backend::SCALAR));
+    ColorConverter::convertYUV420ToRGBA(input.frame, scalar.data(), 1000 * 4);
+
+    for (auto backend : supportedBackends()) {
+        std::vector<uint8_t> simd(scalar.size());
+        ASSERT_TRUE(ColorConverter::setBackend(backend));
+        ColorConverter::convertYUV420ToRGBA(input.frame, simd.data(), 1000 * 4);
+        EXPECT_EQ(scalar, simd) << ColorConverter::backendName(backend);
+    }
+}
+
+TEST_F(ColorConverterTest, HonorsOutputStride) {
+    // 输出stride大于width*4时不能写入行尾填充区域
+    TestFrame input(48, 6, 0, 0, 3);
+    const int rgba_stride = 48 * 4 + 32;
+    std::vector<uint8_t> rgba(rgba_stride * 6, 0xAB);
+    ColorConverter::convertYUV420ToRGBA(input.frame, rgba.data(), rgba_stride);
+
+    for (int row = 0; row < 6; ++row) {
+        for (int i = 48 * 4; i < rgba_stride; ++i) {
+            ASSERT_EQ(rgba[row * rgba_stride + i], 0xAB);
+        }
+        EXPECT_EQ(rgba[row * rgba_stride + 3], 255);
+    }
+}
+
+TEST_F(ColorConverterTest, ParallelStripesMatchSingleThread) {
+    // 奇数高度，条带边界必须落在色度行对上
+    TestFrame input(800, 601, 16, 8, 11);
+    std::vector<uint8_t> single(800 * 601 * 4);
+    std::vector<uint8_t> parallel(single.size());
+    ColorConverter::convertYUV420ToRGBA(input.frame, single.data(), 800 * 4);
+
+    WorkerPool pool(3);
+    ColorConverter::convertYUV420ToRGBA(input.frame, parallel.data(), 800 * 4, &pool);
+    EXPECT_EQ(single, parallel);
+
+    // 重复调用复用常驻线程
+    std::fill(parallel.begin(), parallel.end(), 0);
+    ColorConverter::convertYUV420ToRGBA(input.frame, parallel.data(), 800 * 4, &pool);
+    EXPECT_EQ(single, parallel);
+}
+
+TEST_F(ColorConverterTest, InvalidFrameIsIgnored) {
+    VideoFrame frame;
+    uint8_t rgba[4] = {1, 2, 3, 4};
+    ColorConverter::convertYUV420ToRGBA(frame, rgba, 4);
+    EXPECT_EQ(rgba[0], 1);
+    EXPECT_EQ(rgba[3], 4);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "utils/FrameBuffer.h"
+#include "utils/Common.h"
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace plugin_h264;
+
+TEST(FrameBufferTest, PlanesAreAlignedAndCompact) {
+    FrameBufferPool pool;
+    FrameBuffer buffer = pool.acquire(33, 17);
+    ASSERT_FALSE(buffer.empty());
+
+    EXPECT_EQ(buffer.width(), 33);
+    EXPECT_EQ(buffer.height(), 17);
+    EXPECT_EQ(buffer.stride(0), 33);
+    EXPECT_EQ(buffer.stride(1), 17);
+    EXPECT_EQ(buffer.stride(2), 17);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.plane(i)) % FrameBuffer::kAlignment, 0u);
+    }
+    EXPECT_GE(buffer.plane(1), buffer.plane(0) + 33 * 17);
+    EXPECT_GE(buffer.plane(2), buffer.plane(1) + 17 * 9);
+    EXPECT_LE(static_cast<size_t>(buffer.plane(2) + 17 * 9 - buffer.plane(0)), buffer.capacity());
+
+    EXPECT_TRUE(pool.acquire(0, 16).empty());
+}
+
+TEST(FrameBufferTest, CopyFromPacksStridedPlanes) {
+    const int width = 8;
+    const int height = 4;
+    std::vector<uint8_t> y(24 * height), u(12 * 2), v(12 * 2);
+    for (size_t i = 0; i < y.size(); ++i) {
+        y[i] = static_cast<uint8_t>(i);
+    }
+    u.assign(u.size(), 7);
+    v.assign(v.size(), 9);
+
+    FrameBufferPool pool;
+    FrameBuffer buffer = pool.acquire(width, height);
+    buffer.copyFrom(y.data(), u.data(), v.data(), 24, 12);
+
+    EXPECT_EQ(buffer.plane(0)[width], 24);
+    EXPECT_EQ(buffer.plane(0)[width * height - 1], 24 * 3 + 7);
+    EXPECT_EQ(buffer.plane(1)[width / 2 * 2 - 1], 7);
+    EXPECT_EQ(buffer.plane(2)[0], 9);
+}
+
+TEST(FrameBufferTest, ReleasedBlocksReturnToTheirBucket) {
+    FrameBufferPool pool;
+    const uint8_t* first_plane = nullptr;
+    {
+        FrameBuffer buffer = pool.acquire(1280, 720);
+        first_plane = buffer.plane(0);
+        FrameBuffer copy = buffer;
+        EXPECT_EQ(buffer.useCount(), 2);
+    }
+    EXPECT_EQ(pool.getFreeCount(), 1u);
+    EXPECT_GT(pool.getMemoryUsage(), 1280u * 720u * 3 / 2);
+
+    // 不同分辨率的帧使用自己的桶，不会挤掉已有的空闲块
+    FrameBuffer small = pool.acquire(320, 240);
+    EXPECT_EQ(pool.getFreeCount(), 1u);
+
+    FrameBuffer again = pool.acquire(1280, 720);
+    EXPECT_EQ(again.plane(0), first_plane);
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+
+    small.reset();
+    again.reset();
+    EXPECT_EQ(pool.getFreeCount(), 2u);
+    pool.clear();
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+    EXPECT_EQ(pool.getMemoryUsage(), 0u);
+}
+
+TEST(FrameBufferTest, SizeClassesBoundWaste) {
+    FrameBufferPool pool;
+    const int sizes[][2] = {{16, 16}, {64, 64}, {320, 240}, {640, 360}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (const auto& size : sizes) {
+        FrameBuffer buffer = pool.acquire(size[0], size[1]);
+        size_t used = static_cast<size_t>(buffer.plane(2) - buffer.plane(0)) + buffer.stride(2) * ((size[1] + 1) / 2);
+        EXPECT_GE(buffer.capacity(), used);
+        if (used > 4096) {
+            EXPECT_LE(buffer.capacity(), used + used / 4);
+        }
+    }
+}
+
+TEST(FrameBufferTest, FreeBytesAreCappedAndBuffersOutliveThePool) {
+    FrameBuffer survivor;
+    {
+        FrameBufferPool probe;
+        const size_t block_size = probe.acquire(64, 64).capacity();
+
+        FrameBufferPool pool(block_size * 2);
+        std::vector<FrameBuffer> buffers;
+        for (int i = 0; i < 4; ++i) {
+            buffers.push_back(pool.acquire(64, 64));
+        }
+        buffers.clear();
+        EXPECT_EQ(pool.getFreeCount(), 2u);
+        EXPECT_EQ(pool.getMemoryUsage(), block_size * 2);
+
+        survivor = pool.acquire(64, 64);
+        survivor.plane(0)[0] = 5;
+    }
+    // 池已销毁，缓冲区仍然有效，释放时直接回收
+    EXPECT_EQ(survivor.plane(0)[0], 5);
+    survivor.reset();
+}
+
+TEST(FrameBufferTest, StatsTrackHitsMissesAndHighWater) {
+    FrameBufferPool pool;
+    {
+        FrameBuffer a = pool.acquire(320, 240);
+        FrameBuffer b = pool.acquire(320, 240);
+        FrameBufferPoolStats stats = pool.getStats();
+        EXPECT_EQ(stats.misses, 2u);
+        EXPECT_EQ(stats.bytes_in_use, a.capacity() * 2);
+        EXPECT_EQ(stats.high_water, a.capacity() * 2);
+    }
+
+    FrameBuffer c = pool.acquire(320, 240);
+    FrameBufferPoolStats stats = pool.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.bytes_held, c.capacity());
+    EXPECT_EQ(stats.bytes_in_use, c.capacity());
+    EXPECT_EQ(stats.max_free_bytes, FrameBufferPool::kDefaultMaxFreeBytes);
+
+    // 降低上限立即释放超出的空闲块
+    pool.setMaxFreeBytes(0);
+    EXPECT_EQ(pool.getStats().bytes_held, 0u);
+    c.reset();
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+
+    pool.resetStats();
+    stats = pool.getStats();
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 0u);
+    EXPECT_EQ(stats.high_water, 0u);
+}
+
+TEST(FrameBufferTest, VideoFrameCopiesShareTheBuffer) {
+    FrameBufferPool pool;
+    VideoFrame frame;
+    frame.width = 16;
+    frame.height = 16;
+    frame.zero_copy_mode = true;
+    EXPECT_FALSE(frame.isOwned());
+
+    frame.setBuffer(pool.acquire(16, 16));
+    EXPECT_TRUE(frame.isOwned());
+    EXPECT_TRUE(frame.isValid());
+    EXPECT_FALSE(frame.zero_copy_mode);
+    EXPECT_EQ(frame.y_plane, frame.buffer.plane(0));
+    EXPECT_EQ(frame.uv_stride, 8);
+
+    VideoFrame copy = frame;
+    EXPECT_EQ(frame.buffer.useCount(), 2);
+    frame = VideoFrame();
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+    copy = VideoFrame();
+    EXPECT_EQ(pool.getFreeCount(), 1u);
+}
+
+TEST(FrameBufferTest, ConcurrentAcquireAndRelease) {
+    FrameBufferPool pool;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t] {
+            for (int i = 0; i < 2000; ++i) {
+                FrameBuffer buffer = pool.acquire(64 + (i % 3) * 64, 64);
+                buffer.plane(0)[0] = static_cast<uint8_t>(t);
+                FrameBuffer shared = buffer;
+                buffer.reset();
+                EXPECT_EQ(shared.plane(0)[0], static_cast<uint8_t>(t));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    FrameBufferPoolStats stats = pool.getStats();
+    EXPECT_EQ(stats.hits + stats.misses, 4u * 2000u);
+    EXPECT_EQ(stats.bytes_in_use, 0u);
+    EXPECT_LE(stats.bytes_held, stats.high_water);
+}
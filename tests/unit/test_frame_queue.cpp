@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "managers/FrameQueue.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 带stride填充的解码器输出模拟
+struct StridedFrame {
+    std::vector<uint8_t> y, u, v;
+    VideoFrame frame;
+
+    StridedFrame(int width, int height, uint8_t value) {
+        int y_stride = width + 16;
+        int uv_stride = (width + 1) / 2 + 8;
+        y.assign(y_stride * height, value);
+        u.assign(uv_stride * ((height + 1) / 2), value + 1);
+        v.assign(uv_stride * ((height + 1) / 2), value + 2);
+
+        frame.y_plane = y.data();
+        frame.u_plane = u.data();
+        frame.v_plane = v.data();
+        frame.width = width;
+        frame.height = height;
+        frame.y_stride = y_stride;
+        frame.uv_stride = uv_stride;
+        frame.zero_copy_mode = true;
+    }
+};
+
+void pushFrame(FrameQueue& queue, double timestamp) {
+    StridedFrame source(8, 4, 10);
+    source.frame.timestamp = timestamp;
+    OwnedVideoFrame* slot = queue.beginPush();
+    ASSERT_NE(slot, nullptr);
+    slot->copyFrom(source.frame, queue.getBufferPool());
+    queue.endPush(slot, true);
+}
+
+} // namespace
+
+TEST(FrameQueueTest, CopyFromProducesCompactOwnedFrame) {
+    StridedFrame source(33, 17, 50);
+    source.frame.timestamp = 1.5;
+
+    FrameBufferPool pool;
+    OwnedVideoFrame owned;
+    owned.copyFrom(source.frame, pool);
+
+    // 复制后与源缓冲区无关
+    source.y.assign(source.y.size(), 0);
+    source.u.assign(source.u.size(), 0);
+
+    EXPECT_EQ(owned.frame.width, 33);
+    EXPECT_EQ(owned.frame.height, 17);
+    EXPECT_EQ(owned.frame.y_stride, 33);
+    EXPECT_EQ(owned.frame.uv_stride, 17);
+    EXPECT_FALSE(owned.frame.zero_copy_mode);
+    EXPECT_TRUE(owned.frame.isOwned());
+    EXPECT_DOUBLE_EQ(owned.frame.timestamp, 1.5);
+    EXPECT_EQ(owned.frame.y_plane[33 * 17 - 1], 50);
+    EXPECT_EQ(owned.frame.u_plane[17 * 9 - 1], 51);
+    EXPECT_EQ(owned.frame.v_plane[0], 52);
+}
+
+TEST(FrameQueueTest, CopyFromSharesPooledFrames) {
+    FrameBufferPool pool;
+    StridedFrame source(16, 8, 20);
+    OwnedVideoFrame first;
+    first.copyFrom(source.frame, pool);
+
+    // 已经池化的帧不再复制，只增加引用
+    OwnedVideoFrame second;
+    second.copyFrom(first.frame, pool);
+    EXPECT_EQ(second.frame.y_plane, first.frame.y_plane);
+    EXPECT_EQ(first.frame.buffer.useCount(), 2);
+}
+
+TEST(FrameQueueTest, PoppedFrameOutlivesRecycledSlot) {
+    FrameQueueConfig config;
+    config.depth = 1;
+    FrameQueue queue(config);
+    pushFrame(queue, 0.0);
+
+    // 消费者保留的副本在槽位回收后仍然有效，最后一个副本释放时缓冲区回到池中
+    VideoFrame kept = *queue.popNext();
+    pushFrame(queue, 0.04);
+    ASSERT_NE(queue.popNext(), nullptr);
+    queue.flush();
+    pushFrame(queue, 0.08);
+    ASSERT_NE(queue.popNext(), nullptr);
+
+    EXPECT_TRUE(kept.isOwned());
+    EXPECT_EQ(kept.y_plane[0], 10);
+    EXPECT_EQ(kept.buffer.useCount(), 1);
+
+    size_t free_before = queue.getBufferPool().getFreeCount();
+    kept = VideoFrame();
+    EXPECT_EQ(queue.getBufferPool().getFreeCount(), free_before + 1);
+}
+
+TEST(FrameQueueTest, PopDueReturnsLatestDueFrameAndDropsStale) {
+    FrameQueue queue(FrameQueueConfig{});
+    pushFrame(queue, 0.00);
+    pushFrame(queue, 0.04);
+    pushFrame(queue, 0.08);
+
+    // 队首帧未到期
+    EXPECT_EQ(queue.popDue(-0.01), nullptr);
+    EXPECT_EQ(queue.size(), 3u);
+
+    const VideoFrame* frame = queue.popDue(0.05);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_DOUBLE_EQ(frame->timestamp, 0.04);
+    EXPECT_EQ(queue.getDroppedFrames(), 1u);
+    EXPECT_EQ(queue.size(), 1u);
+
+    frame = queue.popNext();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_DOUBLE_EQ(frame->timestamp, 0.08);
+    EXPECT_EQ(queue.popNext(), nullptr);
+}
+
+TEST(FrameQueueTest, ProducerPausesAtHighWatermarkUntilLow) {
+    FrameQueueConfig config;
+    config.depth = 4;
+    config.high_watermark = 4;
+    config.low_watermark = 1;
+    FrameQueue queue(config);
+
+    std::atomic<int> pushed(0);
+    std::thread producer([&] {
+        for (int i = 0; i < 6; ++i) {
+            pushFrame(queue, i * 0.04);
+            ++pushed;
+        }
+    });
+
+    while (pushed < 4) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pushed.load(), 4);
+
+    // 降到低水位之前生产者不恢复
+    queue.popNext();
+    queue.popNext();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pushed.load(), 4);
+
+    queue.popNext();
+    producer.join();
+    EXPECT_EQ(pushed.load(), 6);
+    EXPECT_EQ(queue.size(), 3u);
+}
+
+TEST(FrameQueueTest, BlockingPopWaitsForProducer) {
+    FrameQueueConfig config;
+    config.blocking_pop = true;
+    config.pop_timeout_ms = 1000;
+    FrameQueue queue(config);
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pushFrame(queue, 0.0);
+    });
+
+    const VideoFrame* frame = queue.popNext();
+    producer.join();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_DOUBLE_EQ(frame->timestamp, 0.0);
+}
+
+TEST(FrameQueueTest, CloseUnblocksProducerAndFlushClearsEndOfStream) {
+    FrameQueueConfig config;
+    config.depth = 1;
+    FrameQueue queue(config);
+    pushFrame(queue, 0.0);
+
+    std::thread producer([&] {
+        EXPECT_EQ(queue.beginPush(), nullptr);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.close();
+    producer.join();
+
+    queue.reopen();
+    queue.setEndOfStream();
+    EXPECT_FALSE(queue.isEndOfStream());
+    queue.flush();
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_FALSE(queue.isEndOfStream());
+}
@@ -24,6 +24,13 @@ TEST_F(H264DecoderTest, InitializationSuccess) {
     EXPECT_FALSE(decoder_->hasError());
 }
 
+TEST_F(H264DecoderTest, PooledOutputByDefault) {
+    // 默认输出池化帧，帧离开解码器后仍然有效
+    EXPECT_TRUE(decoder_->isCompactFormatRequired());
+    decoder_->setCompactFormatRequired(false);
+    EXPECT_FALSE(decoder_->isCompactFormatRequired());
+}
+
 TEST_F(H264DecoderTest, DestroyWithoutInitialize) {
     // 测试未初始化情况下的析构
     decoder_->destroy();
@@ -88,13 +95,15 @@ TEST_F(H264DecoderTest, GetDecoderInfoAfterInitialization) {
 }
 
 TEST_F(H264DecoderTest, MemoryUsageTracking) {
-    // 测试内存使用量跟踪
-    size_t usage_before = decoder_->getMemoryUsage();
-    
+    // 测试内存使用量跟踪：DPB按SPS参考帧数和实际分辨率计算，解码出第一帧之前为0
+    EXPECT_EQ(decoder_->getDPBMemoryUsage(), 0u);
+    EXPECT_EQ(decoder_->getMemoryUsage(), sizeof(H264Decoder));
+
     ASSERT_TRUE(decoder_->initialize());
-    
-    size_t usage_after = decoder_->getMemoryUsage();
-    EXPECT_GT(usage_after, usage_before); // 初始化后应该使用更多内存
+    decoder_->setReferenceFrames(4);
+    EXPECT_EQ(decoder_->getReferenceFrames(), 4);
+    EXPECT_EQ(decoder_->getDPBMemoryUsage(), 0u);
+    EXPECT_EQ(decoder_->getMemoryUsage(), sizeof(H264Decoder) + decoder_->getDPBMemoryUsage());
 }
 
 TEST_F(H264DecoderTest, ResetFunctionality) {
@@ -148,4 +157,93 @@ TEST_F(H264DecoderTest, ThreadSafety) {
     
     // 清理（析构函数会自动调用destroy）
     decoders.clear();
-}
\ No newline at end of file
+}
+
+TEST_F(H264DecoderTest, InitializeWithConfig) {
+    // 多线程解码配置，reset后应保持不变
+    H264DecoderConfig config;
+    config.thread_count = 2;
+    config.error_concealment = ERROR_CON_FRAME_COPY;
+    EXPECT_TRUE(decoder_->initialize(config));
+    EXPECT_EQ(decoder_->getConfig().error_concealment, ERROR_CON_FRAME_COPY);
+
+    decoder_->reset();
+    EXPECT_EQ(decoder_->getConfig().error_concealment, ERROR_CON_FRAME_COPY);
+    EXPECT_EQ(decoder_->getConfig().bitstream_type, VIDEO_BITSTREAM_AVC);
+}
+
+TEST_F(H264DecoderTest, FlushWithoutInput) {
+    // 没有输入时flush不应输出帧
+    VideoFrame frame;
+    EXPECT_FALSE(decoder_->flush(frame));
+
+    ASSERT_TRUE(decoder_->initialize());
+    EXPECT_FALSE(decoder_->flush(frame));
+}
+
+TEST_F(H264DecoderTest, SkipPolicyDropsNonReferenceSlicesWhenLate) {
+    ASSERT_TRUE(decoder_->initialize());
+    EXPECT_EQ(decoder_->getSkipPolicy(), DecodeSkipPolicy::NON_REFERENCE);
+
+    // nal_ref_idc == 0 的P片
+    uint8_t non_ref[] = {0x00, 0x00, 0x00, 0x01, 0x01, 0x9A, 0x10, 0x20};
+    VideoFrame frame;
+
+    // 不落后时照常送入解码器
+    decoder_->decode(non_ref, sizeof(non_ref), frame);
+    EXPECT_EQ(decoder_->getSkipStats().total(), 0u);
+
+    decoder_->setLate(true);
+    EXPECT_FALSE(decoder_->decode(non_ref, sizeof(non_ref), frame));
+    EXPECT_FALSE(decoder_->hasError());
+    EXPECT_EQ(decoder_->getSkipStats().non_reference, 1u);
+
+    // 参数集和参考片不跳过
+    uint8_t sps[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1E};
+    uint8_t ref[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x9A, 0x10, 0x20};
+    decoder_->decode(sps, sizeof(sps), frame);
+    decoder_->decode(ref, sizeof(ref), frame);
+    EXPECT_EQ(decoder_->getSkipStats().total(), 1u);
+
+    decoder_->setSkipPolicy(DecodeSkipPolicy::NONE);
+    decoder_->decode(non_ref, sizeof(non_ref), frame);
+    EXPECT_EQ(decoder_->getSkipStats().total(), 1u);
+
+    decoder_->resetSkipStats();
+    EXPECT_EQ(decoder_->getSkipStats().total(), 0u);
+}
+
+TEST_F(H264DecoderTest, SkipUntilIDRWaitsForNextIDR) {
+    H264DecoderConfig config;
+    config.skip_policy = DecodeSkipPolicy::UNTIL_IDR;
+    ASSERT_TRUE(decoder_->initialize(config));
+
+    uint8_t ref[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x9A, 0x10, 0x20};
+    uint8_t idr[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x00};
+    VideoFrame frame;
+
+    decoder_->setLate(true);
+    EXPECT_FALSE(decoder_->decode(ref, sizeof(ref), frame));
+    EXPECT_FALSE(decoder_->hasError());
+
+    // 参考链已断开，不再落后也继续跳过
+    decoder_->setLate(false);
+    EXPECT_FALSE(decoder_->decode(ref, sizeof(ref), frame));
+    EXPECT_EQ(decoder_->getSkipStats().until_idr, 2u);
+
+    // IDR 送入解码器后恢复
+    decoder_->decode(idr, sizeof(idr), frame);
+    decoder_->decode(ref, sizeof(ref), frame);
+    EXPECT_EQ(decoder_->getSkipStats().until_idr, 2u);
+}
+
+TEST_F(H264DecoderTest, ParsesSkipPolicyNames) {
+    DecodeSkipPolicy policy = DecodeSkipPolicy::NONE;
+    EXPECT_TRUE(H264Decoder::parseSkipPolicy("idr", policy));
+    EXPECT_EQ(policy, DecodeSkipPolicy::UNTIL_IDR);
+    EXPECT_TRUE(H264Decoder::parseSkipPolicy("nonref", policy));
+    EXPECT_EQ(policy, DecodeSkipPolicy::NON_REFERENCE);
+    EXPECT_FALSE(H264Decoder::parseSkipPolicy("all", policy));
+    EXPECT_FALSE(H264Decoder::parseSkipPolicy(nullptr, policy));
+    EXPECT_STREQ(H264Decoder::getSkipPolicyName(DecodeSkipPolicy::NONE), "none");
+}
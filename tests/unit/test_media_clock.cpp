@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "managers/MediaClock.h"
+#include <chrono>
+#include <thread>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 可控的音频时钟源
+class FakeAudioSource : public AudioClockSource {
+public:
+    FakeAudioSource() : playing(false), time(0.0) {}
+
+    bool getAudibleTime(double& seconds) const override {
+        if (!playing) {
+            return false;
+        }
+        seconds = time;
+        return true;
+    }
+
+    bool playing;
+    double time;
+};
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+} // namespace
+
+TEST(MediaClockTest, StartsPausedAtZero) {
+    MediaClock clock;
+    EXPECT_TRUE(clock.isPaused());
+    EXPECT_EQ(clock.getMode(), ClockMode::AUDIO_MASTER);
+
+    sleepMs(20);
+    EXPECT_DOUBLE_EQ(clock.getTime(), 0.0);
+}
+
+TEST(MediaClockTest, VideoMasterFollowsSystemTime) {
+    MediaClock clock;
+    clock.setMode(ClockMode::VIDEO_MASTER);
+    clock.reset(5.0);
+    clock.resume();
+
+    sleepMs(50);
+    double running = clock.getTime();
+    EXPECT_GE(running, 5.04);
+    EXPECT_LT(running, 5.5);
+
+    // 暂停后时间冻结
+    clock.pause();
+    double paused = clock.getTime();
+    sleepMs(30);
+    EXPECT_DOUBLE_EQ(clock.getTime(), paused);
+}
+
+TEST(MediaClockTest, AudioMasterUsesAudibleTimeAndFallsBack) {
+    FakeAudioSource audio;
+    MediaClock clock;
+    clock.setAudioSource(&audio);
+    clock.resume();
+
+    audio.playing = true;
+    audio.time = 12.5;
+    EXPECT_DOUBLE_EQ(clock.getTime(), 12.5);
+
+    // 音频中断后从最后的音频位置按系统时间继续
+    audio.playing = false;
+    sleepMs(30);
+    double fallback = clock.getTime();
+    EXPECT_GE(fallback, 12.52);
+    EXPECT_LT(fallback, 13.0);
+
+    // 视频主时钟忽略音频
+    audio.playing = true;
+    audio.time = 100.0;
+    clock.setMode(ClockMode::VIDEO_MASTER);
+    EXPECT_LT(clock.getTime(), 13.0);
+
+    clock.setAudioSource(nullptr);
+    clock.setMode(ClockMode::AUDIO_MASTER);
+    EXPECT_LT(clock.getTime(), 13.0);
+}
+
+TEST(MediaClockTest, ExternalMasterIsSetByCaller) {
+    MediaClock clock;
+    clock.resume();
+    clock.setMode(ClockMode::EXTERNAL_MASTER);
+
+    clock.setExternalTime(3.25);
+    sleepMs(20);
+    EXPECT_DOUBLE_EQ(clock.getTime(), 3.25);
+
+    // seek 同样重置外部时间
+    clock.reset(1.0);
+    EXPECT_DOUBLE_EQ(clock.getTime(), 1.0);
+
+    // 切回系统时间时从外部时间继续
+    clock.setExternalTime(7.0);
+    clock.setMode(ClockMode::VIDEO_MASTER);
+    double time = clock.getTime();
+    EXPECT_GE(time, 7.0);
+    EXPECT_LT(time, 7.5);
+}
+
+TEST(MediaClockTest, ParsesModeNames) {
+    ClockMode mode = ClockMode::AUDIO_MASTER;
+    EXPECT_TRUE(MediaClock::parseMode("video", mode));
+    EXPECT_EQ(mode, ClockMode::VIDEO_MASTER);
+    EXPECT_TRUE(MediaClock::parseMode("external", mode));
+    EXPECT_EQ(mode, ClockMode::EXTERNAL_MASTER);
+    EXPECT_FALSE(MediaClock::parseMode("wallclock", mode));
+    EXPECT_FALSE(MediaClock::parseMode(nullptr, mode));
+    EXPECT_EQ(mode, ClockMode::EXTERNAL_MASTER);
+
+    EXPECT_STREQ(MediaClock::getModeName(ClockMode::AUDIO_MASTER), "audio");
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "utils/MemoryTracker.h"
+#include "utils/PCMRingBuffer.h"
+#include "decoders/Demuxer.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace plugin_h264;
+
+TEST(MemoryTrackerTest, CounterTracksBytesAndPeak) {
+    MemoryCounter counter;
+    counter.add(100);
+    counter.add(50);
+    counter.sub(120);
+    EXPECT_EQ(counter.getBytes(), 30u);
+    EXPECT_EQ(counter.getPeak(), 150u);
+}
+
+TEST(MemoryTrackerTest, TrackedVectorCountsCapacity) {
+    MemoryCounter counter;
+    {
+        TrackedVector<uint32_t> values{TrackingAllocator<uint32_t>(&counter)};
+        values.reserve(64);
+        EXPECT_EQ(counter.getBytes(), 64 * sizeof(uint32_t));
+
+        // 扩容时新旧缓冲区短暂并存，峰值包含两者
+        values.resize(200);
+        EXPECT_EQ(counter.getBytes(), values.capacity() * sizeof(uint32_t));
+        EXPECT_GE(counter.getPeak(), (64 + 200) * sizeof(uint32_t));
+
+        values.clear();
+        values.shrink_to_fit();
+        EXPECT_EQ(counter.getBytes(), 0u);
+    }
+    EXPECT_EQ(counter.getBytes(), 0u);
+
+    // 默认分配器不计数
+    TrackedVector<uint8_t> untracked(1024);
+    EXPECT_EQ(untracked.get_allocator().getCounter(), nullptr);
+}
+
+TEST(MemoryTrackerTest, SampleIndexChargesItsCounter) {
+    MemoryCounter counter;
+    SampleIndex index(&counter);
+    index.offsets.resize(10);
+    index.sizes.resize(10);
+    index.timestamps.resize(10);
+    index.durations.resize(10);
+    index.sync_samples = {0, 5};
+    EXPECT_EQ(counter.getBytes(), index.getMemoryUsage());
+
+    // 复制沿用同一个计数器
+    SampleIndex copy = index;
+    EXPECT_EQ(counter.getBytes(), index.getMemoryUsage() * 2);
+
+    copy.clear();
+    index.clear();
+    EXPECT_EQ(counter.getBytes(), 0u);
+}
+
+TEST(MemoryTrackerTest, RingBufferChargesItsCounter) {
+    MemoryCounter counter;
+    {
+        PCMRingBuffer ring(1000, &counter);
+        EXPECT_EQ(counter.getBytes(), ring.capacity() * sizeof(int16_t));
+    }
+    EXPECT_EQ(counter.getBytes(), 0u);
+}
+
+TEST(MemoryTrackerTest, ConcurrentAllocations) {
+    MemoryCounter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < 1000; ++i) {
+                TrackedVector<uint8_t> buffer{TrackingAllocator<uint8_t>(&counter)};
+                buffer.resize(64 + i % 7);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter.getBytes(), 0u);
+    EXPECT_GT(counter.getPeak(), 0u);
+}
+
+TEST(MemoryTrackerTest, UsageTotalSumsCategories) {
+    MemoryUsage usage;
+    EXPECT_EQ(usage.total(), 0u);
+    usage.decoder_dpb = 1;
+    usage.frame_pool = 2;
+    usage.texture_buffers = 4;
+    usage.demuxer_index = 8;
+    usage.audio_queues = 16;
+    EXPECT_EQ(usage.total(), 31u);
+}
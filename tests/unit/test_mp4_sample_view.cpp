@@ -0,0 +1,526 @@
+#include <gtest/gtest.h>
+#include "decoders/MP4Demuxer.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// 统计测试进程中的堆分配次数
+static std::atomic<size_t> g_allocations(0);
+
+void* operator new(std::size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace plugin_h264;
+
+namespace {
+
+const int kSampleCount = 60;
+const unsigned kTimescale = 1000;
+const int kSampleDuration = 20;
+
+// 样本大小循环变化，每个字节填充样本序号
+size_t sampleSize(int index) {
+    return 200 + (index % 7) * 150;
+}
+
+// 内存字节源，allow_view为false时模拟不支持零拷贝的后端
+class TestSource : public ByteSource {
+public:
+    TestSource(const std::vector<uint8_t>& data, bool allow_view)
+        : data_(data), allow_view_(allow_view) {}
+
+    int64_t size() const override { return static_cast<int64_t>(data_.size()); }
+
+    bool read(int64_t offset, void* buffer, size_t length) override {
+        if (offset < 0 || static_cast<uint64_t>(offset) + length > data_.size()) {
+            return false;
+        }
+        memcpy(buffer, data_.data() + offset, length);
+        return true;
+    }
+
+    const uint8_t* view(int64_t offset, size_t length) const override {
+        if (!allow_view_ || offset < 0 || static_cast<uint64_t>(offset) + length > data_.size()) {
+            return nullptr;
+        }
+        return data_.data() + offset;
+    }
+
+private:
+    const std::vector<uint8_t>& data_;
+    bool allow_view_;
+};
+
+// 边下载边写入的内存字节源，available之后的数据还没有到达
+class GrowingMemorySource : public ByteSource {
+public:
+    GrowingMemorySource(const std::vector<uint8_t>& data, int64_t available)
+        : data_(data), available_(available), reported_(available), complete_(false), reported_complete_(false) {}
+
+    // 模拟下载进度，下一次refresh时生效
+    void setAvailable(int64_t available, bool complete) {
+        reported_ = available;
+        reported_complete_ = complete;
+    }
+
+    int64_t size() const override { return available_; }
+
+    bool read(int64_t offset, void* buffer, size_t length) override {
+        if (offset < 0 || offset + static_cast<int64_t>(length) > available_) {
+            return false;
+        }
+        memcpy(buffer, data_.data() + offset, length);
+        return true;
+    }
+
+    bool refresh() override {
+        bool changed = reported_ > available_ || reported_complete_ != complete_;
+        available_ = reported_;
+        complete_ = reported_complete_;
+        return changed;
+    }
+
+    bool isComplete() const override { return complete_; }
+
+private:
+    const std::vector<uint8_t>& data_;
+    int64_t available_;
+    int64_t reported_;
+    bool complete_;
+    bool reported_complete_;
+};
+
+int writeCallback(int64_t offset, const void* buffer, size_t size, void* token) {
+    std::vector<uint8_t>* out = static_cast<std::vector<uint8_t>*>(token);
+    if (out->size() < offset + size) {
+        out->resize(offset + size);
+    }
+    memcpy(out->data() + offset, buffer, size);
+    return 0;
+}
+
+// 用minimp4封装一个只有一条轨道的MP4，每keyframe_interval个样本一个同步样本
+// fragmented为true时使用minimp4的分片模式（moov之后每个样本一个moof/mdat）
+std::vector<uint8_t> buildTestMP4(int keyframe_interval = 1, bool fragmented = false) {
+    std::vector<uint8_t> file;
+    MP4E_mux_t* mux = MP4E_open(0, fragmented ? 1 : 0, &file, writeCallback);
+
+    MP4E_track_t track;
+    memset(&track, 0, sizeof(track));
+    track.track_media_kind = e_audio;
+    track.object_type_indication = MP4_OBJECT_TYPE_AUDIO_ISO_IEC_14496_3;
+    track.time_scale = kTimescale;
+    track.default_duration = kSampleDuration;
+    track.u.a.channelcount = 2;
+    int track_id = MP4E_add_track(mux, &track);
+
+    std::vector<uint8_t> payload;
+    for (int i = 0; i < kSampleCount; ++i) {
+        payload.assign(sampleSize(i), static_cast<uint8_t>(i));
+        MP4E_put_sample(mux, track_id, payload.data(), static_cast<int>(payload.size()), kSampleDuration,
+                        i % keyframe_interval == 0 ? MP4E_SAMPLE_RANDOM_ACCESS : MP4E_SAMPLE_DEFAULT);
+    }
+
+    MP4E_close(mux);
+    return file;
+}
+
+// 指定类型的顶层盒子的结束位置
+std::vector<int64_t> topLevelBoxEnds(const std::vector<uint8_t>& file, const char* type) {
+    std::vector<int64_t> ends;
+    size_t offset = 0;
+    while (offset + 8 <= file.size()) {
+        uint32_t size = (static_cast<uint32_t>(file[offset]) << 24) | (file[offset + 1] << 16) |
+                        (file[offset + 2] << 8) | file[offset + 3];
+        if (size < 8) {
+            break;
+        }
+        offset += size;
+        if (memcmp(&file[offset - size + 4], type, 4) == 0) {
+            ends.push_back(static_cast<int64_t>(offset));
+        }
+    }
+    return ends;
+}
+
+uint32_t readBoxSize(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void appendBE32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void writeBE32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+// 把分片文件每个traf中的tfdt换成version 1（64位），第k个分片的解码时间为base + k * kSampleDuration
+// buildTestMP4的分片模式每个moof只有一个样本；moof变长后相应修正trun的data_offset和tfhd的base_data_offset
+std::vector<uint8_t> rebaseFragments(const std::vector<uint8_t>& file, uint64_t base) {
+    std::vector<uint8_t> out;
+    int64_t shift = 0;  // 之前的moof累计增加的字节数
+    uint64_t fragment = 0;
+    size_t offset = 0;
+    while (offset + 8 <= file.size()) {
+        uint32_t size = readBoxSize(&file[offset]);
+        if (size < 8 || offset + size > file.size()) {
+            break;
+        }
+        if (memcmp(&file[offset + 4], "moof", 4) != 0) {
+            out.insert(out.end(), file.begin() + offset, file.begin() + offset + size);
+            offset += size;
+            continue;
+        }
+
+        std::vector<uint8_t> moof(file.begin() + offset, file.begin() + offset + 8);
+        std::vector<size_t> trun_offsets, tfhd_offsets;  // 在新moof中的位置
+        for (size_t child = offset + 8; child + 8 <= offset + size; child += readBoxSize(&file[child])) {
+            uint32_t child_size = readBoxSize(&file[child]);
+            if (memcmp(&file[child + 4], "traf", 4) != 0) {
+                moof.insert(moof.end(), file.begin() + child, file.begin() + child + child_size);
+                continue;
+            }
+
+            size_t traf_start = moof.size();
+            moof.insert(moof.end(), file.begin() + child, file.begin() + child + 8);
+            for (size_t box = child + 8; box + 8 <= child + child_size; box += readBoxSize(&file[box])) {
+                uint32_t box_size = readBoxSize(&file[box]);
+                if (memcmp(&file[box + 4], "tfdt", 4) == 0) {
+                    continue;
+                }
+                if (memcmp(&file[box + 4], "trun", 4) == 0) {
+                    trun_offsets.push_back(moof.size());
+                }
+                if (memcmp(&file[box + 4], "tfhd", 4) == 0) {
+                    tfhd_offsets.push_back(moof.size());
+                }
+                moof.insert(moof.end(), file.begin() + box, file.begin() + box + box_size);
+                if (memcmp(&file[box + 4], "tfhd", 4) == 0) {
+                    uint64_t decode_time = base + fragment * kSampleDuration;
+                    appendBE32(moof, 20);
+                    moof.insert(moof.end(), {'t', 'f', 'd', 't', 1, 0, 0, 0});
+                    appendBE32(moof, static_cast<uint32_t>(decode_time >> 32));
+                    appendBE32(moof, static_cast<uint32_t>(decode_time));
+                }
+            }
+            writeBE32(&moof[traf_start], static_cast<uint32_t>(moof.size() - traf_start));
+        }
+        writeBE32(&moof[0], static_cast<uint32_t>(moof.size()));
+
+        // moof起点后移shift字节，样本数据后移shift + delta字节
+        int64_t delta = static_cast<int64_t>(moof.size()) - size;
+        bool relative = false;
+        for (size_t trun : trun_offsets) {
+            if (moof[trun + 11] & 0x01) {
+                uint32_t data_offset = readBoxSize(&moof[trun + 16]);
+                writeBE32(&moof[trun + 16], static_cast<uint32_t>(data_offset + delta));
+                relative = true;
+            }
+        }
+        for (size_t tfhd : tfhd_offsets) {
+            if (moof[tfhd + 11] & 0x01) {
+                uint64_t base_offset = (static_cast<uint64_t>(readBoxSize(&moof[tfhd + 16])) << 32) |
+                                       readBoxSize(&moof[tfhd + 20]);
+                base_offset += shift + (relative ? 0 : delta);
+                writeBE32(&moof[tfhd + 16], static_cast<uint32_t>(base_offset >> 32));
+                writeBE32(&moof[tfhd + 20], static_cast<uint32_t>(base_offset));
+            }
+        }
+
+        out.insert(out.end(), moof.begin(), moof.end());
+        shift += delta;
+        fragment++;
+        offset += size;
+    }
+    return out;
+}
+
+// 读完整条轨道，返回读到的样本数
+int readAllSamples(MP4Demuxer& demuxer) {
+    MP4SampleView view;
+    int count = 0;
+    while (demuxer.readNextSample(0, view)) {
+        count++;
+    }
+    return count;
+}
+
+} // namespace
+
+class MP4SampleViewTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        file_ = buildTestMP4();
+        ASSERT_FALSE(file_.empty());
+    }
+
+    std::vector<uint8_t> file_;
+};
+
+TEST_F(MP4SampleViewTest, ZeroCopyViewPointsIntoSource) {
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, true))));
+    EXPECT_TRUE(demuxer.isZeroCopy());
+
+    MP4SampleView view;
+    for (int i = 0; i < kSampleCount; ++i) {
+        ASSERT_TRUE(demuxer.readNextSample(0, view));
+        EXPECT_GE(view.data, file_.data());
+        EXPECT_LE(view.data + view.size, file_.data() + file_.size());
+        EXPECT_EQ(view.size, sampleSize(i));
+        EXPECT_EQ(view.timestamp, static_cast<uint64_t>(i * kSampleDuration));
+        EXPECT_EQ(view.data[0], static_cast<uint8_t>(i));
+        EXPECT_EQ(view.data[view.size - 1], static_cast<uint8_t>(i));
+    }
+    EXPECT_FALSE(demuxer.readNextSample(0, view));
+}
+
+TEST_F(MP4SampleViewTest, ZeroCopyPlaybackDoesNotAllocate) {
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, true))));
+
+    size_t before = g_allocations.load();
+    int count = readAllSamples(demuxer);
+    size_t allocations = g_allocations.load() - before;
+
+    EXPECT_EQ(count, kSampleCount);
+    EXPECT_EQ(allocations, 0u);
+}
+
+TEST_F(MP4SampleViewTest, BufferedPlaybackDoesNotAllocateAfterWarmup) {
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, false))));
+    EXPECT_FALSE(demuxer.isZeroCopy());
+
+    // 第一遍让轨道缓冲区增长到最大样本大小
+    EXPECT_EQ(readAllSamples(demuxer), kSampleCount);
+    ASSERT_TRUE(demuxer.seekToTime(0.0));
+
+    size_t before = g_allocations.load();
+    int count = readAllSamples(demuxer);
+    size_t allocations = g_allocations.load() - before;
+
+    EXPECT_EQ(count, kSampleCount);
+    EXPECT_EQ(allocations, 0u);
+}
+
+TEST_F(MP4SampleViewTest, BufferedViewMatchesCopyingRead) {
+    MP4Demuxer view_demuxer;
+    MP4Demuxer copy_demuxer;
+    ASSERT_TRUE(view_demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, false))));
+    ASSERT_TRUE(copy_demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, false))));
+
+    MP4SampleView view;
+    MP4Sample sample;
+    for (int i = 0; i < kSampleCount; ++i) {
+        ASSERT_TRUE(view_demuxer.readNextSample(0, view));
+        ASSERT_TRUE(copy_demuxer.readNextSample(0, sample));
+        ASSERT_EQ(view.size, sample.data.size());
+        EXPECT_EQ(0, memcmp(view.data, sample.data.data(), view.size));
+        EXPECT_EQ(view.timestamp, sample.timestamp);
+        EXPECT_EQ(view.duration, sample.duration);
+    }
+}
+
+TEST_F(MP4SampleViewTest, SeekUsesSampleIndex) {
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, true))));
+
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->count(), static_cast<size_t>(kSampleCount));
+    EXPECT_EQ(index->sizes[3], sampleSize(3));
+    EXPECT_EQ(index->findSample(0), 0u);
+    EXPECT_EQ(index->findSample(kSampleDuration * 10), 10u);
+    EXPECT_EQ(index->findSample(kSampleDuration * 10 + 1), 11u);
+    EXPECT_EQ(index->findSample(kSampleDuration * kSampleCount), static_cast<size_t>(kSampleCount));
+
+    // 0.5s 落在第25个样本上（20ms/样本）
+    ASSERT_TRUE(demuxer.seekToTime(0.5));
+    MP4SampleView view;
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.timestamp, 500u);
+    EXPECT_EQ(view.data[0], 25);
+
+    EXPECT_EQ(demuxer.getSampleIndex(1), nullptr);
+}
+
+TEST_F(MP4SampleViewTest, NextSampleNumberTracksReadsAndSeeks) {
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file_, true))));
+    EXPECT_EQ(demuxer.getNextSampleNumber(0), 0u);
+
+    MP4SampleView view;
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(demuxer.getNextSampleNumber(0), 2u);
+
+    // 调度器据此预读后续样本的时间戳
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    EXPECT_EQ(index->timestamps[demuxer.getNextSampleNumber(0)], static_cast<uint64_t>(2 * kSampleDuration));
+
+    ASSERT_TRUE(demuxer.seekToTime(0.5));
+    EXPECT_EQ(demuxer.getNextSampleNumber(0), 25u);
+    EXPECT_EQ(demuxer.getNextSampleNumber(1), 0u);
+}
+
+TEST(SampleIndexTest, FindSyncSample) {
+    SampleIndex index;
+    for (uint32_t i = 0; i < 30; ++i) {
+        index.timestamps.push_back(i * 100);
+    }
+
+    // 没有stss时每个样本都是同步样本
+    EXPECT_TRUE(index.isSyncSample(7));
+    EXPECT_EQ(index.findSyncSample(7), 7u);
+
+    index.sync_samples = {0, 12, 24};
+    EXPECT_TRUE(index.isSyncSample(12));
+    EXPECT_FALSE(index.isSyncSample(13));
+    EXPECT_EQ(index.findSyncSample(0), 0u);
+    EXPECT_EQ(index.findSyncSample(11), 0u);
+    EXPECT_EQ(index.findSyncSample(12), 12u);
+    EXPECT_EQ(index.findSyncSample(23), 12u);
+    EXPECT_EQ(index.findSyncSample(29), 24u);
+}
+
+TEST(MP4SyncSampleTest, SeekSnapsToPrecedingSyncSample) {
+    std::vector<uint8_t> file = buildTestMP4(10);
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file, true))));
+
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->sync_samples.size(), static_cast<size_t>(kSampleCount / 10));
+    EXPECT_EQ(index->sync_samples[1], 10u);
+
+    // 0.5s 是第25个样本，退回到第20个（同步样本）
+    ASSERT_TRUE(demuxer.seekToTime(0.5));
+    MP4SampleView view;
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.data[0], 20);
+    EXPECT_TRUE(view.is_keyframe);
+
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.data[0], 21);
+    EXPECT_FALSE(view.is_keyframe);
+
+    // 正好落在同步样本上时不需要退回
+    ASSERT_TRUE(demuxer.seekToTime(0.6));
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.data[0], 30);
+}
+
+TEST(MP4FragmentedTest, ReadsCompleteFragmentedFile) {
+    std::vector<uint8_t> file = buildTestMP4(10, true);
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file, true))));
+    EXPECT_TRUE(demuxer.isFragmented());
+    EXPECT_FALSE(demuxer.isWaitingForData());
+    EXPECT_EQ(readAllSamples(demuxer), kSampleCount);
+    EXPECT_NEAR(demuxer.getDuration(), kSampleCount * kSampleDuration / 1000.0, 1e-6);
+
+    // 分片中的sample_flags给出同步样本
+    const SampleIndex* index = demuxer.getSampleIndex(0);
+    ASSERT_NE(index, nullptr);
+    EXPECT_TRUE(index->isSyncSample(10));
+    EXPECT_FALSE(index->isSyncSample(11));
+
+    ASSERT_TRUE(demuxer.seekToTime(0.5));
+    MP4SampleView view;
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.data[0], 20);
+    EXPECT_EQ(view.size, sampleSize(20));
+}
+
+TEST(MP4FragmentedTest, KeepsDecodeTimesAbove32Bits) {
+    // 直播打包的CMAF从很大的baseMediaDecodeTime开始
+    const uint64_t kBase = (1ULL << 32) + 1000;
+    std::vector<uint8_t> file = rebaseFragments(buildTestMP4(10, true), kBase);
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(new TestSource(file, true))));
+    ASSERT_TRUE(demuxer.isFragmented());
+
+    MP4SampleView view;
+    for (int i = 0; i < kSampleCount; ++i) {
+        ASSERT_TRUE(demuxer.readNextSample(0, view));
+        EXPECT_EQ(view.data[0], static_cast<uint8_t>(i));
+        EXPECT_EQ(view.timestamp, kBase + static_cast<uint64_t>(i * kSampleDuration));
+    }
+    EXPECT_NEAR(demuxer.getDuration(),
+                static_cast<double>(kBase + kSampleCount * kSampleDuration) / kTimescale, 1e-6);
+
+    // 时间戳不回绕，二分查找仍然落到正确的同步样本
+    ASSERT_TRUE(demuxer.seekToTime(static_cast<double>(kBase) / kTimescale + 0.5));
+    ASSERT_TRUE(demuxer.readNextSample(0, view));
+    EXPECT_EQ(view.data[0], 20);
+    EXPECT_EQ(view.timestamp, kBase + 20 * kSampleDuration);
+}
+
+TEST(MP4FragmentedTest, ReadsFragmentsAsTheyArrive) {
+    std::vector<uint8_t> file = buildTestMP4(10, true);
+    std::vector<int64_t> moov_ends = topLevelBoxEnds(file, "moov");
+    std::vector<int64_t> mdat_ends = topLevelBoxEnds(file, "mdat");
+    ASSERT_EQ(moov_ends.size(), 1u);
+    ASSERT_EQ(mdat_ends.size(), static_cast<size_t>(kSampleCount));
+
+    // moov 到达后就可以打开
+    GrowingMemorySource* source = new GrowingMemorySource(file, moov_ends[0]);
+    MP4Demuxer demuxer;
+    ASSERT_TRUE(demuxer.open(std::unique_ptr<ByteSource>(source)));
+    EXPECT_TRUE(demuxer.isWaitingForData());
+
+    MP4SampleView view;
+    EXPECT_FALSE(demuxer.readNextSample(0, view));
+
+    // 第3个mdat还差1个字节：只能读到前两个样本
+    source->setAvailable(mdat_ends[2] - 1, false);
+    int count = 0;
+    while (demuxer.readNextSample(0, view)) {
+        EXPECT_EQ(view.data[0], count);
+        count++;
+    }
+    EXPECT_EQ(count, 2);
+    EXPECT_TRUE(demuxer.isWaitingForData());
+
+    // 下载完成后读完剩余样本
+    source->setAvailable(static_cast<int64_t>(file.size()), true);
+    while (demuxer.readNextSample(0, view)) {
+        EXPECT_EQ(view.data[0], count);
+        count++;
+    }
+    EXPECT_EQ(count, kSampleCount);
+    EXPECT_FALSE(demuxer.isWaitingForData());
+}
+
+TEST(MP4FragmentedTest, OpenFailsUntilMoovArrives) {
+    std::vector<uint8_t> file = buildTestMP4(1, true);
+    std::vector<int64_t> moov_ends = topLevelBoxEnds(file, "moov");
+    ASSERT_EQ(moov_ends.size(), 1u);
+
+    MP4Demuxer demuxer;
+    EXPECT_FALSE(demuxer.open(std::unique_ptr<ByteSource>(new GrowingMemorySource(file, moov_ends[0] - 1))));
+    EXPECT_TRUE(demuxer.hasError());
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "utils/NALConverter.h"
+#include <vector>
+
+using namespace plugin_h264;
+
+namespace {
+
+// 按指定长度前缀字节数拼接NAL单元
+std::vector<uint8_t> buildAVCC(const std::vector<std::vector<uint8_t>>& nals, int length_size) {
+    std::vector<uint8_t> out;
+    for (const auto& nal : nals) {
+        for (int i = length_size - 1; i >= 0; --i) {
+            out.push_back(static_cast<uint8_t>(nal.size() >> (8 * i)));
+        }
+        out.insert(out.end(), nal.begin(), nal.end());
+    }
+    return out;
+}
+
+std::vector<uint8_t> buildAnnexB(const std::vector<std::vector<uint8_t>>& nals) {
+    std::vector<uint8_t> out;
+    for (const auto& nal : nals) {
+        out.insert(out.end(), {0x00, 0x00, 0x00, 0x01});
+        out.insert(out.end(), nal.begin(), nal.end());
+    }
+    return out;
+}
+
+// SEI + IDR切片，IDR超过255字节用于检查长度的高字节
+std::vector<std::vector<uint8_t>> testNals() {
+    std::vector<uint8_t> idr(300, 0xAB);
+    idr[0] = 0x65;
+    return { {0x06, 0x05, 0x01, 0x80}, idr, {0x41, 0x9A} };
+}
+
+} // namespace
+
+TEST(NALConverterTest, ParseLengthSizeFromAvcC) {
+    uint8_t avcc[] = {0x01, 0x64, 0x00, 0x1F, 0xFF, 0xE1};
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, sizeof(avcc)), 4);
+
+    avcc[4] = 0xFD;
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, sizeof(avcc)), 2);
+
+    avcc[4] = 0xFC;
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, sizeof(avcc)), 1);
+
+    // 3字节为保留值
+    avcc[4] = 0xFE;
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, sizeof(avcc)), 0);
+
+    // 版本号错误或数据太短
+    avcc[4] = 0xFF;
+    avcc[0] = 0x00;
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, sizeof(avcc)), 0);
+    EXPECT_EQ(NALConverter::parseLengthSize(avcc, 4), 0);
+    EXPECT_EQ(NALConverter::parseLengthSize(nullptr, 0), 0);
+}
+
+TEST(NALConverterTest, RewriteInPlaceReplacesLengthPrefixes) {
+    auto nals = testNals();
+    std::vector<uint8_t> sample = buildAVCC(nals, 4);
+    std::vector<uint8_t> expected = buildAnnexB(nals);
+
+    ASSERT_EQ(sample.size(), expected.size());
+    const uint8_t* data = sample.data();
+    EXPECT_TRUE(NALConverter::rewriteInPlace(sample.data(), sample.size()));
+    EXPECT_EQ(sample.data(), data);
+    EXPECT_EQ(sample, expected);
+}
+
+TEST(NALConverterTest, RewriteInPlaceRejectsMalformedSamples) {
+    auto nals = testNals();
+
+    // 最后一个NAL长度超出样本
+    std::vector<uint8_t> truncated = buildAVCC(nals, 4);
+    truncated.pop_back();
+    EXPECT_FALSE(NALConverter::rewriteInPlace(truncated.data(), truncated.size()));
+
+    // 尾部残留不足一个长度字段
+    std::vector<uint8_t> trailing = buildAVCC(nals, 4);
+    trailing.push_back(0x00);
+    trailing.push_back(0x00);
+    EXPECT_FALSE(NALConverter::rewriteInPlace(trailing.data(), trailing.size()));
+
+    EXPECT_FALSE(NALConverter::rewriteInPlace(nullptr, 0));
+}
+
+TEST(NALConverterTest, ConvertsShortLengthPrefixes) {
+    // 1字节前缀只能容纳短NAL
+    std::vector<std::vector<uint8_t>> short_nals = { {0x67, 0x42, 0x00, 0x1E}, {0x68, 0xCE}, {0x65, 0x88, 0x84} };
+
+    struct Case { int length_size; std::vector<std::vector<uint8_t>> nals; };
+    std::vector<Case> cases = { {1, short_nals}, {2, testNals()}, {4, testNals()} };
+
+    for (const auto& c : cases) {
+        std::vector<uint8_t> sample = buildAVCC(c.nals, c.length_size);
+        std::vector<uint8_t> expected = buildAnnexB(c.nals);
+
+        size_t size = NALConverter::annexBSize(sample.data(), sample.size(), c.length_size);
+        ASSERT_EQ(size, expected.size()) << "length size " << c.length_size;
+
+        std::vector<uint8_t> out(size);
+        EXPECT_EQ(NALConverter::convert(sample.data(), sample.size(), c.length_size, out.data(), out.size()), size);
+        EXPECT_EQ(out, expected) << "length size " << c.length_size;
+    }
+}
+
+TEST(NALConverterTest, ConvertRejectsMalformedOrShortOutput) {
+    auto nals = testNals();
+    std::vector<uint8_t> sample = buildAVCC(nals, 2);
+    std::vector<uint8_t> out(sample.size() * 2);
+
+    // 输出空间不足
+    size_t size = NALConverter::annexBSize(sample.data(), sample.size(), 2);
+    EXPECT_EQ(NALConverter::convert(sample.data(), sample.size(), 2, out.data(), size - 1), 0u);
+
+    // 长度越界
+    sample.pop_back();
+    EXPECT_EQ(NALConverter::annexBSize(sample.data(), sample.size(), 2), 0u);
+    EXPECT_EQ(NALConverter::convert(sample.data(), sample.size(), 2, out.data(), out.size()), 0u);
+
+    // 不支持的前缀长度
+    EXPECT_EQ(NALConverter::annexBSize(sample.data(), sample.size(), 3), 0u);
+}
+
+TEST(NALConverterTest, DetectsNonReferenceSamples) {
+    // nal_ref_idc=0 的P片（0x01）前面带SEI
+    std::vector<uint8_t> non_ref = buildAVCC({ {0x06, 0x05, 0x01, 0x80}, {0x01, 0x9A, 0x00} }, 4);
+    EXPECT_FALSE(NALConverter::isReferenceSample(non_ref.data(), non_ref.size(), 4));
+
+    std::vector<uint8_t> ref = buildAVCC(testNals(), 2);
+    EXPECT_TRUE(NALConverter::isReferenceSample(ref.data(), ref.size(), 2));
+
+    // 没有片或格式错误时按参考帧处理
+    std::vector<uint8_t> sei_only = buildAVCC({ {0x06, 0x05, 0x01, 0x80} }, 4);
+    EXPECT_TRUE(NALConverter::isReferenceSample(sei_only.data(), sei_only.size(), 4));
+    non_ref.pop_back();
+    EXPECT_TRUE(NALConverter::isReferenceSample(non_ref.data(), non_ref.size(), 4));
+}
+
+TEST(NALConverterTest, InspectsAnnexBSlices) {
+    std::vector<uint8_t> idr = buildAnnexB(testNals());
+    SliceInfo info = NALConverter::inspectAnnexB(idr.data(), idr.size());
+    EXPECT_TRUE(info.has_slice);
+    EXPECT_TRUE(info.is_reference);
+    EXPECT_TRUE(info.is_idr);
+
+    // 3字节起始码 + 非参考P片
+    std::vector<uint8_t> non_ref = {0x00, 0x00, 0x01, 0x06, 0x05, 0x00, 0x00, 0x01, 0x01, 0x9A, 0x10};
+    info = NALConverter::inspectAnnexB(non_ref.data(), non_ref.size());
+    EXPECT_TRUE(info.has_slice);
+    EXPECT_FALSE(info.is_reference);
+    EXPECT_FALSE(info.is_idr);
+
+    std::vector<uint8_t> params = buildAnnexB({ {0x67, 0x42, 0x00, 0x1E}, {0x68, 0xCE, 0x3C, 0x80} });
+    info = NALConverter::inspectAnnexB(params.data(), params.size());
+    EXPECT_FALSE(info.has_slice);
+}
+
+TEST(NALConverterTest, FindsStartCodes) {
+    std::vector<uint8_t> data = {0x01, 0x00, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x65, 0x00, 0x00, 0x01};
+    EXPECT_EQ(NALConverter::findStartCode(data.data(), data.size()), 7u);
+    EXPECT_EQ(NALConverter::findStartCode(data.data() + 10, data.size() - 10), 1u);
+
+    // 0x01前只有一个0、或者起始码被截断时都不匹配
+    EXPECT_EQ(NALConverter::findStartCode(data.data(), 5), 5u);
+    EXPECT_EQ(NALConverter::findStartCode(data.data() + 8, 1), 1u);
+    EXPECT_EQ(NALConverter::findStartCode(nullptr, 0), 0u);
+
+    // 连续的起始码
+    std::vector<uint8_t> back_to_back = {0x00, 0x00, 0x01, 0x00, 0x00, 0x01};
+    EXPECT_EQ(NALConverter::findStartCode(back_to_back.data(), back_to_back.size()), 0u);
+    EXPECT_EQ(NALConverter::findStartCode(back_to_back.data() + 1, back_to_back.size() - 1), 2u);
+}
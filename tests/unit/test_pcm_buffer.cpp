@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "utils/PCMBuffer.h"
+#include "utils/Common.h"
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace plugin_h264;
+
+TEST(PCMBufferTest, ReleasedBlocksAreReused) {
+    PCMBufferPool pool;
+    const int16_t* first_data = nullptr;
+    {
+        PCMBuffer buffer = pool.acquire(4096);
+        ASSERT_NE(buffer.data(), nullptr);
+        EXPECT_EQ(buffer.size(), 4096u);
+        buffer.setSize(2048);
+        EXPECT_EQ(buffer.size(), 2048u);
+        first_data = buffer.data();
+    }
+    EXPECT_EQ(pool.getFreeCount(), 1u);
+
+    // 同样大小的帧复用同一块内存，不重新分配
+    PCMBuffer again = pool.acquire(4096);
+    EXPECT_EQ(again.data(), first_data);
+    EXPECT_EQ(again.size(), 4096u);
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+
+    // 更大的请求在复用的数据块上扩容
+    again.reset();
+    PCMBuffer larger = pool.acquire(8192);
+    EXPECT_GE(larger.capacity(), 8192u);
+
+    // setSize不超过容量
+    larger.setSize(100000);
+    EXPECT_EQ(larger.size(), larger.capacity());
+}
+
+TEST(PCMBufferTest, CopiesShareTheBlockUntilLastRelease) {
+    PCMBufferPool pool;
+    PCMBuffer a = pool.acquire(16);
+    a.data()[0] = 42;
+
+    PCMBuffer b = a;
+    EXPECT_EQ(b.data(), a.data());
+    a.reset();
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(pool.getFreeCount(), 0u);
+    EXPECT_EQ(b.data()[0], 42);
+
+    PCMBuffer c = std::move(b);
+    EXPECT_EQ(b.data(), nullptr);
+    c.reset();
+    EXPECT_EQ(pool.getFreeCount(), 1u);
+}
+
+TEST(PCMBufferTest, FreeListIsCappedAndBuffersOutliveThePool) {
+    PCMBuffer survivor;
+    {
+        PCMBufferPool pool(2);
+        std::vector<PCMBuffer> buffers;
+        for (int i = 0; i < 4; ++i) {
+            buffers.push_back(pool.acquire(32));
+        }
+        buffers.clear();
+        EXPECT_EQ(pool.getFreeCount(), 2u);
+        EXPECT_GT(pool.getMemoryUsage(), 0u);
+
+        survivor = pool.acquire(32);
+        survivor.data()[31] = 7;
+    }
+    // 池已销毁，缓冲区仍然可用，释放时直接回收
+    EXPECT_EQ(survivor.data()[31], 7);
+    survivor.reset();
+}
+
+TEST(PCMBufferTest, ConcurrentReleaseReturnsEveryBlock) {
+    PCMBufferPool pool(64);
+    std::vector<PCMBuffer> buffers;
+    for (int i = 0; i < 64; ++i) {
+        buffers.push_back(pool.acquire(1024));
+    }
+
+    // 另一个线程（如OpenAL填充线程）持有副本，两边交替释放
+    std::vector<PCMBuffer> copies(buffers);
+    std::thread other([&copies] { copies.clear(); });
+    buffers.clear();
+    other.join();
+
+    EXPECT_EQ(pool.getFreeCount(), 64u);
+}
+
+TEST(AudioFrameTest, IsMoveOnly) {
+    EXPECT_FALSE(std::is_copy_constructible<AudioFrame>::value);
+    EXPECT_TRUE(std::is_nothrow_move_constructible<AudioFrame>::value);
+
+    PCMBufferPool pool;
+    AudioFrame frame;
+    frame.samples = pool.acquire(2048);
+    frame.sample_rate = 48000;
+    frame.channels = 2;
+    const int16_t* data = frame.samples.data();
+
+    AudioFrame moved = std::move(frame);
+    EXPECT_EQ(moved.samples.data(), data);
+    EXPECT_TRUE(moved.isValid());
+    EXPECT_FALSE(frame.isValid());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "utils/PCMRingBuffer.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace plugin_h264;
+
+TEST(PCMRingBufferTest, CapacityRoundsUpToPowerOfTwo) {
+    PCMRingBuffer ring(1000);
+    EXPECT_EQ(ring.capacity(), 1024u);
+    EXPECT_EQ(ring.available(), 0u);
+    EXPECT_EQ(ring.space(), 1024u);
+}
+
+TEST(PCMRingBufferTest, WriteStopsWhenFullAndReadWrapsAround) {
+    PCMRingBuffer ring(8);
+    std::vector<int16_t> input = {1, 2, 3, 4, 5, 6};
+    std::vector<int16_t> output(8, 0);
+
+    EXPECT_EQ(ring.write(input.data(), 6), 6u);
+    EXPECT_EQ(ring.read(output.data(), 4), 4u);
+    EXPECT_EQ(output[3], 4);
+
+    // 跨越缓冲区末尾写入，超出容量的部分被拒绝
+    std::vector<int16_t> more = {7, 8, 9, 10, 11, 12, 13};
+    EXPECT_EQ(ring.write(more.data(), more.size()), 6u);
+    EXPECT_EQ(ring.space(), 0u);
+
+    EXPECT_EQ(ring.read(output.data(), 8), 8u);
+    const int16_t expected[] = {5, 6, 7, 8, 9, 10, 11, 12};
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(output[i], expected[i]);
+    }
+    EXPECT_EQ(ring.read(output.data(), 1), 0u);
+}
+
+TEST(PCMRingBufferTest, ConcurrentProducerConsumerPreservesOrder) {
+    PCMRingBuffer ring(256);
+    const int total = 200000;
+
+    std::thread producer([&] {
+        int16_t chunk[97];
+        int next = 0;
+        while (next < total) {
+            int count = std::min(97, total - next);
+            for (int i = 0; i < count; ++i) {
+                chunk[i] = static_cast<int16_t>(next + i);
+            }
+            size_t written = 0;
+            while (written < static_cast<size_t>(count)) {
+                size_t n = ring.write(chunk + written, count - written);
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                written += n;
+            }
+            next += count;
+        }
+    });
+
+    int received = 0;
+    bool in_order = true;
+    int16_t chunk[61];
+    while (received < total) {
+        size_t count = ring.read(chunk, 61);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            in_order = in_order && chunk[i] == static_cast<int16_t>(received + i);
+        }
+        received += static_cast<int>(count);
+    }
+    producer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(ring.available(), 0u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "utils/PerfStats.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace plugin_h264;
+
+#if PLUGIN_H264_ENABLE_PERF_STATS
+
+TEST(PerfStatsTest, BucketsArePowersOfTwoMicroseconds) {
+    EXPECT_EQ(PerfStats::getBucketIndex(0), 0);
+    EXPECT_EQ(PerfStats::getBucketIndex(999), 0);
+    EXPECT_EQ(PerfStats::getBucketIndex(1000), 1);
+    EXPECT_EQ(PerfStats::getBucketIndex(3999), 2);
+    EXPECT_EQ(PerfStats::getBucketIndex(4000), 3);
+    // 超出范围的耗时都落在最后一个桶
+    EXPECT_EQ(PerfStats::getBucketIndex(10ULL * 1000 * 1000 * 1000), PerfStageStats::kBucketCount - 1);
+}
+
+TEST(PerfStatsTest, RecordAccumulatesPerStage) {
+    PerfStats stats;
+    stats.record(PerfStage::H264_DECODE, 2000000);
+    stats.record(PerfStage::H264_DECODE, 6000000);
+    stats.record(PerfStage::DEMUX, 500);
+
+    PerfStageStats decode = stats.getStageStats(PerfStage::H264_DECODE);
+    EXPECT_EQ(decode.count, 2u);
+    EXPECT_EQ(decode.total_ns, 8000000u);
+    EXPECT_EQ(decode.max_ns, 6000000u);
+    EXPECT_DOUBLE_EQ(decode.getMeanMs(), 4.0);
+    EXPECT_EQ(decode.buckets[PerfStats::getBucketIndex(2000000)], 1u);
+
+    // 百分位取所在桶的上界，不超过最大值
+    EXPECT_DOUBLE_EQ(decode.getPercentileMs(0.5), 2.048);
+    EXPECT_DOUBLE_EQ(decode.getPercentileMs(0.99), 6.0);
+
+    EXPECT_EQ(stats.getStageStats(PerfStage::DEMUX).buckets[0], 1u);
+    EXPECT_EQ(stats.getStageStats(PerfStage::AAC_DECODE).count, 0u);
+    EXPECT_DOUBLE_EQ(stats.getStageStats(PerfStage::AAC_DECODE).getPercentileMs(0.5), 0.0);
+
+    stats.reset();
+    EXPECT_EQ(stats.getStageStats(PerfStage::H264_DECODE).count, 0u);
+    EXPECT_EQ(stats.getStageStats(PerfStage::H264_DECODE).max_ns, 0u);
+}
+
+TEST(PerfStatsTest, ScopeRecordsElapsedTime) {
+    PerfStats stats;
+    {
+        PLUGIN_H264_PERF_SCOPE(&stats, PerfStage::YUV_TO_RGBA);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    {
+        PLUGIN_H264_PERF_SCOPE(nullptr, PerfStage::YUV_TO_RGBA);
+    }
+
+    PerfStageStats convert = stats.getStageStats(PerfStage::YUV_TO_RGBA);
+    EXPECT_EQ(convert.count, 1u);
+    EXPECT_GE(convert.total_ns, 2000000u);
+}
+
+TEST(PerfStatsTest, ConcurrentRecords) {
+    PerfStats stats;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&stats, t] {
+            for (int i = 0; i < 1000; ++i) {
+                stats.record(PerfStage::AUDIO_REFILL, static_cast<uint64_t>(t * 1000 + i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    PerfStageStats refill = stats.getStageStats(PerfStage::AUDIO_REFILL);
+    EXPECT_EQ(refill.count, 4000u);
+    EXPECT_EQ(refill.max_ns, 3999u);
+    uint64_t bucketed = 0;
+    for (int i = 0; i < PerfStageStats::kBucketCount; ++i) {
+        bucketed += refill.buckets[i];
+    }
+    EXPECT_EQ(bucketed, 4000u);
+}
+
+#endif // PLUGIN_H264_ENABLE_PERF_STATS
+
+TEST(PerfStatsTest, StageNames) {
+    EXPECT_STREQ(PerfStats::getStageName(PerfStage::DEMUX), "demux");
+    EXPECT_STREQ(PerfStats::getStageName(PerfStage::AVCC_CONVERT), "avccConvert");
+    EXPECT_STREQ(PerfStats::getStageName(PerfStage::AUDIO_REFILL), "audioRefill");
+}